@@ -20,6 +20,8 @@ Press 'Q' to quit, 'Space' to toggle visualization
 import json
 import time
 import os
+import socket
+import struct
 import sys
 from pathlib import Path
 import math
@@ -169,9 +171,13 @@ class CalibrationSystem:
 
 
 class EnhancedEyeTracker:
-    def __init__(self, output_file="eye_gaze.json"):
+    def __init__(self, output_file="eye_gaze.json", gaze_port=5555):
         self.output_file = output_file
         
+        # ShaderGlass Gaze Input listens on localhost (Processing > Advanced > Gaze Input)
+        self.gaze_socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+        self.gaze_address = ("127.0.0.1", gaze_port)
+        
         # Load cascade classifiers
         self.face_cascade = cv2.CascadeClassifier(
             cv2.data.haarcascades + 'haarcascade_frontalface_default.xml'
@@ -290,6 +296,7 @@ class EnhancedEyeTracker:
         try:
             while True:
                 ret, frame = self.webcam.read()
+                frame_time = time.perf_counter_ns() // 1000
                 if not ret:
                     print("Failed to capture frame")
                     break
@@ -341,6 +348,8 @@ class EnhancedEyeTracker:
                         if self.calibration.is_calibrated:
                             raw_gaze_x, raw_gaze_y = self.calibration.map_gaze(raw_gaze_x, raw_gaze_y)
                         
+                        self._send_gaze_sample(frame_time, max(0.0, min(1.0, float(raw_gaze_x))), max(0.0, min(1.0, float(raw_gaze_y))))
+                        
                         # Apply Kalman filter
                         self.gaze_x, self.gaze_y = self.kalman_filter.update(raw_gaze_x, raw_gaze_y)
                         
@@ -403,6 +412,15 @@ class EnhancedEyeTracker:
         except IOError as e:
             pass  # Silently fail to avoid spam
     
+    def _send_gaze_sample(self, timestamp, gaze_x, gaze_y):
+        """Send an unfiltered sample straight to ShaderGlass, which filters and predicts itself"""
+        # microseconds of the performance counter, x, y
+        try:
+            packet = struct.pack('<qff', timestamp, float(gaze_x), float(gaze_y))
+            self.gaze_socket.sendto(packet, self.gaze_address)
+        except OSError:
+            pass
+    
     def _draw_visualization(self, frame, faces):
         """Draw visualization overlay"""
         h, w = frame.shape[:2]
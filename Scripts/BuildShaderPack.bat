@@ -0,0 +1,11 @@
+@echo off
+echo This script will compile *ALL* RetroArch shaders into a single ShaderGlass.sgpack
+echo which ShaderGlass loads at startup in place of the embedded shader library.
+echo,
+echo Make sure you have ShaderGen.exe built into x64\Release directory
+echo and RetroArch shaders cloned into Scripts\slang-shaders subdirectory.
+echo,
+pause
+
+rmdir /s /q temp
+..\x64\Release\ShaderGen.exe -j %NUMBER_OF_PROCESSORS% -pack ..\x64\Release\ShaderGlass.sgpack *
@@ -4,10 +4,10 @@ echo,
 echo Make sure you have ShaderGen.exe built into x64\Release directory
 echo and RetroArch shaders cloned into Scripts\slang-shaders subdirectory.
 echo,
-echo This will take a bit of time (10 min?)
+echo This will take a bit of time (10 min single-threaded, much less with more cores)
 pause
 
 del /q ..\ShaderGlass\Shaders\RetroArch.h
 rmdir /s /q ..\ShaderGlass\Shaders\RetroArch
 rmdir /s /q temp
-..\x64\Release\ShaderGen.exe *
+..\x64\Release\ShaderGen.exe -j %NUMBER_OF_PROCESSORS% *
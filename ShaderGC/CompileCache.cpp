@@ -0,0 +1,222 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "CompileCache.h"
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+// bump when glslang/SPIRV-Cross/fxc versions or options change to invalidate old entries
+static const char* sCompileOptions = "glslang vulkan1.0 spv1.0 | spirv-cross hlsl sm50 | fxc O3 vs_5_0 ps_5_0";
+
+static const uint32_t sMagic   = 0x43434753; // SGCC
+static const uint32_t sVersion = 2;
+
+struct CompileCacheHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t spirvWords;
+    uint32_t hlslLength;
+    uint32_t metadataLength;
+    uint32_t bytecodeLength;
+    uint32_t logLength;
+    uint32_t warn;
+    uint32_t checksum; // CRC-32 of everything after the header
+
+    uint64_t PayloadSize() const
+    {
+        return (uint64_t)spirvWords * sizeof(uint32_t) + hlslLength + metadataLength + bytecodeLength + logLength;
+    }
+};
+
+static uint32_t Checksum(const CompileCacheEntry& entry)
+{
+    auto checksum = ShaderCache::CalculateChecksum(entry.spirv.data(), entry.spirv.size() * sizeof(uint32_t));
+    checksum      = ShaderCache::CalculateChecksum(entry.hlsl.data(), entry.hlsl.size(), checksum);
+    checksum      = ShaderCache::CalculateChecksum(entry.metadata.data(), entry.metadata.size(), checksum);
+    checksum      = ShaderCache::CalculateChecksum(entry.bytecode.data(), entry.bytecode.size(), checksum);
+    return ShaderCache::CalculateChecksum(entry.log.data(), entry.log.size(), checksum);
+}
+
+CompileCache::CompileCache(const std::filesystem::path& directory, uintmax_t maxSize) : m_directory {directory}, m_maxSize {maxSize}
+{
+    std::error_code ec;
+    std::filesystem::create_directories(m_directory, ec);
+    if(!std::filesystem::is_directory(m_directory, ec))
+        return;
+
+    uintmax_t size = 0;
+    for(const auto& p : std::filesystem::directory_iterator(m_directory, ec))
+    {
+        if(p.path().extension() == ".sgc")
+            size += p.file_size(ec);
+        else if(p.path().extension() == ".tmp")
+            std::filesystem::remove(p.path(), ec); // leftover from an interrupted write
+    }
+    m_size    = size;
+    m_enabled = true;
+}
+
+std::filesystem::path CompileCache::EntryPath(const std::string& source, bool fragment) const
+{
+    std::string key(sCompileOptions);
+    key += fragment ? "|frag|" : "|vert|";
+    key += source;
+
+    std::ostringstream name;
+    name << std::hex << std::setfill('0');
+    for(auto h : ShaderCache::CalculateHash(key))
+        name << std::setw(8) << h;
+    name << ".sgc";
+    return m_directory / name.str();
+}
+
+bool CompileCache::Find(const std::string& source, bool fragment, CompileCacheEntry& entry)
+{
+    if(!m_enabled)
+        return false;
+
+    const auto&   path = EntryPath(source, fragment);
+    std::ifstream infile(path, std::ios::binary);
+    if(!infile.good())
+    {
+        m_misses++;
+        return false;
+    }
+
+    // lengths are only trusted once they add up to the file size
+    std::error_code    ec;
+    CompileCacheHeader header;
+    infile.read((char*)&header, sizeof(header));
+    const auto fileSize = std::filesystem::file_size(path, ec);
+    if(!infile.good() || ec || header.magic != sMagic || header.version != sVersion || fileSize != sizeof(header) + header.PayloadSize())
+    {
+        m_misses++;
+        return false;
+    }
+
+    entry.spirv.resize(header.spirvWords);
+    entry.hlsl.resize(header.hlslLength);
+    entry.metadata.resize(header.metadataLength);
+    entry.bytecode.resize(header.bytecodeLength);
+    entry.log.resize(header.logLength);
+    entry.warn = header.warn != 0;
+    infile.read((char*)entry.spirv.data(), entry.spirv.size() * sizeof(uint32_t));
+    infile.read(entry.hlsl.data(), entry.hlsl.size());
+    infile.read(entry.metadata.data(), entry.metadata.size());
+    infile.read((char*)entry.bytecode.data(), entry.bytecode.size());
+    infile.read(entry.log.data(), entry.log.size());
+    if(infile.fail() || entry.hlsl.empty() || Checksum(entry) != header.checksum)
+    {
+        // truncated or damaged entry, will be overwritten on store
+        entry = CompileCacheEntry();
+        m_misses++;
+        return false;
+    }
+    infile.close();
+
+    // modification time doubles as last access for LRU
+    std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+
+    m_hits++;
+    return true;
+}
+
+void CompileCache::Store(const std::string& source, bool fragment, const CompileCacheEntry& entry)
+{
+    if(!m_enabled)
+        return;
+
+    static std::atomic<uint32_t> tempCounter {0};
+
+    const auto& path     = EntryPath(source, fragment);
+    auto        tempPath = path;
+    tempPath.replace_extension("." + std::to_string(tempCounter++) + ".tmp");
+
+    CompileCacheHeader header;
+    header.magic          = sMagic;
+    header.version        = sVersion;
+    header.spirvWords     = (uint32_t)entry.spirv.size();
+    header.hlslLength     = (uint32_t)entry.hlsl.size();
+    header.metadataLength = (uint32_t)entry.metadata.size();
+    header.bytecodeLength = (uint32_t)entry.bytecode.size();
+    header.logLength      = (uint32_t)entry.log.size();
+    header.warn           = entry.warn ? 1 : 0;
+    header.checksum       = Checksum(entry);
+
+    std::ofstream outfile(tempPath, std::ios::binary | std::ios::trunc);
+    outfile.write((const char*)&header, sizeof(header));
+    outfile.write((const char*)entry.spirv.data(), entry.spirv.size() * sizeof(uint32_t));
+    outfile.write(entry.hlsl.data(), entry.hlsl.size());
+    outfile.write(entry.metadata.data(), entry.metadata.size());
+    outfile.write((const char*)entry.bytecode.data(), entry.bytecode.size());
+    outfile.write(entry.log.data(), entry.log.size());
+    outfile.close();
+
+    // write-then-rename so concurrent readers never see a partial entry
+    std::error_code ec;
+    if(outfile.fail())
+    {
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+    auto oldSize = std::filesystem::exists(path, ec) ? std::filesystem::file_size(path, ec) : 0;
+    std::filesystem::rename(tempPath, path, ec);
+    if(ec)
+    {
+        std::filesystem::remove(tempPath, ec);
+        return;
+    }
+    m_size += sizeof(header) + header.PayloadSize();
+    m_size -= std::min<uintmax_t>(oldSize, m_size);
+
+    if(m_size > m_maxSize)
+        Evict();
+}
+
+void CompileCache::Evict()
+{
+    std::lock_guard lock(m_evictMutex);
+    if(m_size <= m_maxSize)
+        return;
+
+    struct CacheFile
+    {
+        std::filesystem::path           path;
+        std::filesystem::file_time_type time;
+        uintmax_t                       size;
+    };
+
+    std::error_code        ec;
+    std::vector<CacheFile> files;
+    uintmax_t              total = 0;
+    for(const auto& p : std::filesystem::directory_iterator(m_directory, ec))
+    {
+        if(p.path().extension() != ".sgc")
+            continue;
+        CacheFile f {p.path(), p.last_write_time(ec), p.file_size(ec)};
+        total += f.size;
+        files.push_back(f);
+    }
+    std::sort(files.begin(), files.end(), [](const CacheFile& a, const CacheFile& b) { return a.time < b.time; });
+
+    // trim below the limit so eviction doesn't run on every store
+    const auto target = m_maxSize / 4 * 3;
+    for(const auto& f : files)
+    {
+        if(total <= target)
+            break;
+        if(std::filesystem::remove(f.path, ec))
+            total -= f.size;
+    }
+    m_size = total;
+}
@@ -0,0 +1,65 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// results of compiling a single preprocessed GLSL stage
+struct CompileCacheEntry
+{
+    std::vector<uint32_t> spirv;
+    std::string           hlsl;
+    std::string           metadata; // reflection JSON, fragment stage only
+    std::vector<uint8_t>  bytecode; // DXBC, empty until compiled
+    std::string           log;      // compiler diagnostics, replayed on a hit
+    bool                  warn {false};
+};
+
+// persistent on-disk cache of GLSL -> SPIR-V -> HLSL -> DXBC results, one file per
+// entry named by SHA-256 of compiler options, stage and source; least recently
+// used entries are evicted once the directory grows beyond maxSize
+class CompileCache
+{
+public:
+    CompileCache(const std::filesystem::path& directory, uintmax_t maxSize);
+
+    bool Find(const std::string& source, bool fragment, CompileCacheEntry& entry);
+    void Store(const std::string& source, bool fragment, const CompileCacheEntry& entry);
+
+    size_t Hits() const
+    {
+        return m_hits;
+    }
+
+    size_t Misses() const
+    {
+        return m_misses;
+    }
+
+    uintmax_t Size() const
+    {
+        return m_size;
+    }
+
+private:
+    std::filesystem::path EntryPath(const std::string& source, bool fragment) const;
+    void                  Evict();
+
+    std::filesystem::path  m_directory;
+    uintmax_t              m_maxSize;
+    std::atomic<uintmax_t> m_size {0};
+    std::atomic<size_t>    m_hits {0};
+    std::atomic<size_t>    m_misses {0};
+    bool                   m_enabled {false};
+    std::mutex             m_evictMutex;
+};
@@ -16,9 +16,11 @@ class PresetDef
 public:
     PresetDef() : ShaderDefs {}, TextureDefs {}, Overrides {}, Name {}, Category {}, ImportPath {} { }
 
+    virtual ~PresetDef() = default;
+
     virtual void Build() { }
 
-    __declspec(noinline)
+    NOINLINE
     void OverrideParam(const char* name, float value)
     {
         Overrides.emplace_back(name, value);
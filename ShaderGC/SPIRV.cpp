@@ -8,6 +8,7 @@ GNU General Public License v3.0
 #include "pch.h"
 
 #include "SPIRV.h"
+#include "ShaderDef.h"
 
 #include "include/spirv_hlsl.hpp"
 #include "include/spirv_reflect.hpp"
@@ -58,3 +59,37 @@ std::pair<std::string, std::string> SPIRV::GenerateHLSL(const std::vector<uint32
         throw std::runtime_error(msg.str());
     }
 }
+
+bool SPIRV::FrameDependent(const std::vector<uint32_t>& bin)
+{
+    try
+    {
+        Compiler   compiler(bin);
+        const auto resources = compiler.get_shader_resources(compiler.get_active_interface_variables());
+
+        // only members the code actually reads, slang blocks tend to declare FrameCount regardless
+        for(const auto* buffers : {&resources.uniform_buffers, &resources.push_constant_buffers})
+        {
+            for(const auto& buffer : *buffers)
+            {
+                for(const auto& range : compiler.get_active_buffer_ranges(buffer.id))
+                {
+                    if(ShaderDef::IsFrameUniform(compiler.get_member_name(buffer.base_type_id, range.index)))
+                        return true;
+                }
+            }
+        }
+
+        for(const auto& image : resources.sampled_images)
+        {
+            if(ShaderDef::IsFrameSampler(image.name))
+                return true;
+        }
+        return false;
+    }
+    catch(std::exception&)
+    {
+        // can't tell, render every frame
+        return true;
+    }
+}
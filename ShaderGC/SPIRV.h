@@ -11,4 +11,5 @@ class SPIRV
 {
 public:
     static std::pair<std::string, std::string> GenerateHLSL(const std::vector<uint32_t>& bin, bool fragment, std::ostream& log, bool& warn);
+    static bool                                FrameDependent(const std::vector<uint32_t>& bin);
 };
\ No newline at end of file
@@ -10,6 +10,8 @@ GNU General Public License v3.0
 #include "ShaderCache.h"
 #include "sha256.h"
 
+#include <algorithm>
+
 std::vector<uint32_t> ShaderCache::CalculateHash(const std::string& source)
 {
     auto* data = (const uint8_t*)source.data();
@@ -25,15 +27,59 @@ std::vector<uint32_t> ShaderCache::CalculateHash(const std::string& source)
     return buffer;
 }
 
-const CachedShader* ShaderCache::FindCachedShader(const std::string& source) const
+uint32_t ShaderCache::CalculateChecksum(const void* data, size_t length, uint32_t checksum)
+{
+    static const auto table = []() {
+        std::array<uint32_t, 256> t;
+        for(uint32_t i = 0; i < 256; i++)
+        {
+            uint32_t c = i;
+            for(int k = 0; k < 8; k++)
+                c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+
+    auto     bytes = (const uint8_t*)data;
+    uint32_t crc   = checksum ^ 0xffffffff;
+    for(size_t i = 0; i < length; i++)
+        crc = table[(crc ^ bytes[i]) & 0xff] ^ (crc >> 8);
+    return crc ^ 0xffffffff;
+}
+
+void ShaderCache::Add(std::vector<CachedShader>&& shaders)
 {
-    auto hash = CalculateHash(source);
+    if(m_cachedShaders.empty())
+        m_cachedShaders = std::move(shaders);
+    else
+        m_cachedShaders.insert(m_cachedShaders.end(), shaders.begin(), shaders.end());
 
-    for(const auto& cs : m_cachedShaders)
+    m_index.reserve(m_cachedShaders.size());
+    for(size_t i = 0; i < m_cachedShaders.size(); i++)
     {
-        if(cs.hash != nullptr && cs.hash[0] == hash[0] && cs.hash[1] == hash[1] && cs.hash[2] == hash[2] && cs.hash[3] == hash[3] && cs.hash[4] == hash[4] &&
-           cs.hash[5] == hash[5] && cs.hash[6] == hash[6] && cs.hash[7] == hash[7])
-            return &cs;
+        const auto& cs = m_cachedShaders[i];
+        if(cs.hash == nullptr)
+            continue;
+
+        ShaderHash hash;
+        std::copy(cs.hash, cs.hash + HASH_LEN, hash.begin());
+        m_index.try_emplace(hash, i); // first one wins like the linear scan did
     }
-    return nullptr;
+}
+
+const CachedShader* ShaderCache::FindCachedShader(const std::string& source) const
+{
+    if(m_index.empty())
+        return nullptr;
+
+    return FindCachedShader(CalculateHash(source).data());
+}
+
+const CachedShader* ShaderCache::FindCachedShader(const uint32_t* hash) const
+{
+    ShaderHash key;
+    std::copy(hash, hash + HASH_LEN, key.begin());
+    auto it = m_index.find(key);
+    return it != m_index.end() ? &m_cachedShaders[it->second] : nullptr;
 }
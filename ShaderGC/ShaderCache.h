@@ -7,6 +7,12 @@ GNU General Public License v3.0
 
 #pragma once
 
+#include <array>
+#include <memory>
+#include <unordered_map>
+
+#include "CompileCache.h"
+
 #define HASH_LEN 8
 
 struct CachedShader
@@ -27,7 +33,32 @@ public:
 
     static std::vector<uint32_t> CalculateHash(const std::string& source);
 
+    // CRC-32, pass the previous result to continue over several buffers
+    static uint32_t CalculateChecksum(const void* data, size_t length, uint32_t checksum = 0);
+
+    // takes ownership of the list and indexes it by hash
+    void Add(std::vector<CachedShader>&& shaders);
+
     const CachedShader* FindCachedShader(const std::string& source) const;
 
-    std::vector<CachedShader> m_cachedShaders;
+    // by CalculateHash result
+    const CachedShader* FindCachedShader(const uint32_t* hash) const;
+
+    // optional persistent cache for shaders not in m_cachedShaders
+    std::shared_ptr<CompileCache> m_compileCache;
+
+private:
+    using ShaderHash = std::array<uint32_t, HASH_LEN>;
+
+    struct ShaderHashHasher
+    {
+        size_t operator()(const ShaderHash& hash) const
+        {
+            // already SHA-256, any 64 bits are well distributed
+            return ((size_t)hash[0] << 32) ^ hash[1];
+        }
+    };
+
+    std::vector<CachedShader>                                m_cachedShaders;
+    std::unordered_map<ShaderHash, size_t, ShaderHashHasher> m_index; // into m_cachedShaders
 };
\ No newline at end of file
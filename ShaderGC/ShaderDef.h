@@ -7,6 +7,20 @@ GNU General Public License v3.0
 
 #pragma once
 
+#include <cstdint>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifndef NOINLINE
+#ifdef _MSC_VER
+#define NOINLINE __declspec(noinline)
+#else
+#define NOINLINE __attribute__((noinline))
+#endif
+#endif
+
 struct ShaderParam
 {
     ShaderParam(const char* name, int buffer, int offset, int size, float minValue, float maxValue, float defaultValue, float stepValue = 0.0f, const char* description = "") :
@@ -46,7 +60,7 @@ class ShaderDef
 public:
     ShaderDef() :
         Params {}, Samplers {}, Name {}, VertexSource {}, FragmentSource {}, VertexByteCode {}, FragmentByteCode {}, VertexHash {}, FragmentHash {}, VertexLength {},
-        FragmentLength {}, Format {}, Dynamic {false}
+        FragmentLength {}, Format {}, FrameDependent {-1}, Dynamic {false}
     { }
 
     std::vector<ShaderParam>           Params;
@@ -62,6 +76,7 @@ public:
     size_t                             VertexLength;
     size_t                             FragmentLength;
     char*                              Format;
+    int                                FrameDependent; // -1 not analysed, otherwise output can change without new input
     bool                               Dynamic;
 
     size_t ParamsSize(int buffer)
@@ -78,13 +93,44 @@ public:
         return maxLen;
     }
 
-    __declspec(noinline)
+    // reads FrameCount/FrameDirection or samples history/feedback; definitions that predate the
+    // analysis are judged by their declared uniforms and samplers
+    bool DependsOnFrame() const
+    {
+        if(FrameDependent >= 0)
+            return FrameDependent != 0;
+
+        for(const auto& p : Params)
+        {
+            if(IsFrameUniform(p.name))
+                return true;
+        }
+        for(const auto& s : Samplers)
+        {
+            if(IsFrameSampler(s.name))
+                return true;
+        }
+        return false;
+    }
+
+    static bool IsFrameUniform(const std::string& name)
+    {
+        return name == "FrameCount" || name == "FrameDirection";
+    }
+
+    // previous input frames or previous output of a pass; OriginalHistory0 is the current frame
+    static bool IsFrameSampler(const std::string& name)
+    {
+        return (name.starts_with("OriginalHistory") && name != "OriginalHistory0") || name.ends_with("Feedback");
+    }
+
+    NOINLINE
     void AddParam(const char* name, int buffer, int offset, int size, float minValue, float maxValue, float defaultValue, float stepValue = 0.0f, const char* description = "")
     {
         Params.emplace_back(name, buffer, offset, size, minValue, maxValue, defaultValue, stepValue, description);
     }
 
-    __declspec(noinline)
+    NOINLINE
     void AddSampler(const char* name, int binding)
     {
         Samplers.emplace_back(name, binding);
@@ -32,51 +32,105 @@ static uint8_t* CopyVector(const std::vector<uint8_t>& d)
     return copy;
 }
 
-ShaderDef ShaderGC::CompileSourceShader(SourceShaderDef& def, ostream& log, bool& warn, const ShaderCache& cache)
+static uint32_t* CopyHash(const std::string& hlsl)
 {
-    // convert GLSL to SPIRV
-    auto vertexSPIRV   = GLSL::GenerateSPIRV(def.vertexSource.c_str(), false, log, warn);
-    auto fragmentSPIRV = GLSL::GenerateSPIRV(def.fragmentSource.c_str(), true, log, warn);
+    auto hash = ShaderCache::CalculateHash(hlsl);
+    auto copy = new uint32_t[HASH_LEN];
+    memcpy(copy, hash.data(), HASH_LEN * sizeof(uint32_t));
+    return copy;
+}
 
-    // convert SPIRV to HLSL and reflect
-    auto vertexHLSL   = SPIRV::GenerateHLSL(vertexSPIRV, false, log, warn);
-    auto fragmentHLSL = SPIRV::GenerateHLSL(fragmentSPIRV, true, log, warn);
+// GLSL -> SPIRV -> HLSL, skipped entirely when the compile cache has the stage
+static bool GenerateStage(const std::string& source, bool fragment, CompileCacheEntry& entry, ostream& log, bool& warn, const ShaderCache& cache)
+{
+    if(cache.m_compileCache && cache.m_compileCache->Find(source, fragment, entry))
+    {
+        // diagnostics of the compile that produced the entry
+        log << entry.log;
+        warn |= entry.warn;
+        return true;
+    }
+
+    ostringstream stageLog;
+    entry.spirv    = GLSL::GenerateSPIRV(source.c_str(), fragment, stageLog, entry.warn);
+    auto hlsl      = SPIRV::GenerateHLSL(entry.spirv, fragment, stageLog, entry.warn);
+    entry.hlsl     = hlsl.first;
+    entry.metadata = hlsl.second;
+    entry.log      = stageLog.str();
+    log << entry.log;
+    warn |= entry.warn;
+    return false;
+}
+
+// HLSL -> DXBC unless already cached, returns true if fxc had to run
+static bool CompileStage(CompileCacheEntry& entry, const char* profile, ostream& log, bool& warn, const ShaderCache& cache)
+{
+    if(!entry.bytecode.empty())
+        return false;
 
-    // compile HLSL to DXBC
-    std::vector<uint8_t> vertexDXBC, fragmentDXBC;
     if(!cache.empty())
     {
-        auto vertexCached = cache.FindCachedShader(vertexHLSL.first);
-        if(vertexCached != nullptr)
+        auto cached = cache.FindCachedShader(entry.hlsl);
+        if(cached != nullptr)
         {
-            vertexDXBC.resize(vertexCached->len);
-            memcpy(vertexDXBC.data(), vertexCached->data, vertexCached->len);
+            entry.bytecode.resize(cached->len);
+            memcpy(entry.bytecode.data(), cached->data, cached->len);
+            return false;
         }
+    }
+    ostringstream stageLog;
+    entry.bytecode = HLSL::CompileHLSL(entry.hlsl.c_str(), (int)entry.hlsl.size(), profile, true, stageLog, entry.warn);
+    entry.log += stageLog.str();
+    log << stageLog.str();
+    warn |= entry.warn;
+    return true;
+}
 
-        auto fragmentCached = cache.FindCachedShader(fragmentHLSL.first);
-        if(fragmentCached != nullptr)
-        {
-            fragmentDXBC.resize(fragmentCached->len);
-            memcpy(fragmentDXBC.data(), fragmentCached->data, fragmentCached->len);
-        }
+static void LogCompileCache(ostream& log, const ShaderCache& cache)
+{
+    if(cache.m_compileCache)
+        log << "Compile cache: " << cache.m_compileCache->Hits() << " hits, " << cache.m_compileCache->Misses() << " misses, " << cache.m_compileCache->Size() / 1024
+            << " KB" << endl;
+}
+
+ShaderDef ShaderGC::CompileSourceShader(SourceShaderDef& def, ostream& log, bool& warn, const ShaderCache& cache)
+{
+    CompileCacheEntry vertex, fragment;
+
+    // convert GLSL to SPIRV to HLSL and reflect
+    auto vertexFound   = GenerateStage(def.vertexSource, false, vertex, log, warn, cache);
+    auto fragmentFound = GenerateStage(def.fragmentSource, true, fragment, log, warn, cache);
+
+    // compile HLSL to DXBC
+    auto vertexCompiled   = CompileStage(vertex, "vs_5_0", log, warn, cache);
+    auto fragmentCompiled = CompileStage(fragment, "ps_5_0", log, warn, cache);
+
+    if(cache.m_compileCache)
+    {
+        if((!vertexFound || vertexCompiled) && !vertex.bytecode.empty())
+            cache.m_compileCache->Store(def.vertexSource, false, vertex);
+        if((!fragmentFound || fragmentCompiled) && !fragment.bytecode.empty())
+            cache.m_compileCache->Store(def.fragmentSource, true, fragment);
     }
-    if(vertexDXBC.empty())
-        vertexDXBC = HLSL::CompileHLSL(vertexHLSL.first.c_str(), (int)vertexHLSL.first.size(), "vs_5_0", true, log, warn);
-    if(fragmentDXBC.empty())
-        fragmentDXBC = HLSL::CompileHLSL(fragmentHLSL.first.c_str(), (int)fragmentHLSL.first.size(), "ps_5_0", true, log, warn);
+
+    const auto& vertexDXBC   = vertex.bytecode;
+    const auto& fragmentDXBC = fragment.bytecode;
 
     // map declared to reflected parameters
     std::vector<SourceShaderSampler> textures;
-    def.params = LookupParams(def.params, textures, fragmentHLSL.second);
+    def.params = LookupParams(def.params, textures, fragment.metadata);
 
     ShaderDef sd;
     sd.Format           = CopyString(def.format);
     sd.VertexSource     = nullptr;
     sd.VertexByteCode   = CopyVector(vertexDXBC);
     sd.VertexLength     = vertexDXBC.size();
+    sd.VertexHash       = CopyHash(vertex.hlsl);
     sd.FragmentSource   = nullptr;
     sd.FragmentByteCode = CopyVector(fragmentDXBC);
     sd.FragmentLength   = fragmentDXBC.size();
+    sd.FragmentHash     = CopyHash(fragment.hlsl);
+    sd.FrameDependent   = SPIRV::FrameDependent(vertex.spirv) || SPIRV::FrameDependent(fragment.spirv);
     sd.Name             = def.input.filename().string();
 
     for(const auto& p : def.params)
@@ -112,39 +166,206 @@ PresetDef* ShaderGC::CompileShader(std::filesystem::path source, ostream& log, b
     pdef->ShaderDefs.push_back(shaderDef);
     pdef->ImportPath = source;
 
+    LogCompileCache(log, cache);
+
     return pdef;
 }
 
-vector<string> ShaderGC::LoadSource(const filesystem::path& input, bool followIncludes)
+// source file as read from disk, reused until its modification time changes
+struct SourceFile
 {
-    vector<string> lines;
+    filesystem::file_time_type modified;
+    uintmax_t                  size {0};
+    vector<string>             lines;
+    size_t                     bytes {0};
+    bool                       once {false}; // #pragma once, include guard or parameters only
+};
+
+static mutex                                     sSourceFilesMutex;
+static map<string, shared_ptr<const SourceFile>> sSourceFiles;
+static ShaderGC::SourceStats                     sSourceStats;
+
+static bool IsComment(const string& line)
+{
+    return line.empty() || line.starts_with("//");
+}
+
+// expanding the file a second time would add nothing: guarded, #pragma once
+// or only #pragma parameter lines (which are stripped and de-duplicated anyway)
+static bool IsIncludeOnce(const vector<string>& lines)
+{
+    vector<string> code;
+    bool           inComment = false;
+    for(const auto& line : lines)
+    {
+        auto trimLine = trim(line);
+        if(inComment)
+        {
+            inComment = trimLine.find("*/") == string::npos;
+            continue;
+        }
+        if(trimLine.starts_with("/*"))
+        {
+            inComment = trimLine.find("*/") == string::npos;
+            continue;
+        }
+        if(trimLine == "#pragma once")
+            return true;
+        if(!IsComment(trimLine))
+            code.push_back(trimLine);
+    }
+
+    if(all_of(code.begin(), code.end(), [](const string& l) { return l.starts_with("#pragma parameter"); }))
+        return true;
+
+    // #ifndef X / #define X ... #endif spanning the whole file
+    if(code.size() < 3 || !code[0].starts_with("#ifndef ") || !code[1].starts_with("#define ") || !code.back().starts_with("#endif"))
+        return false;
+    string ifndef, define, guard, defined;
+    istringstream(code[0]) >> ifndef >> guard;
+    istringstream(code[1]) >> define >> defined;
+    if(guard != defined)
+        return false;
+
+    int depth = 0;
+    for(size_t i = 0; i < code.size(); i++)
+    {
+        if(code[i].starts_with("#if"))
+            depth++;
+        else if(code[i].starts_with("#endif") && --depth == 0 && i != code.size() - 1)
+            return false;
+    }
+    return depth == 0;
+}
+
+static shared_ptr<const SourceFile> ReadSourceFile(const filesystem::path& input)
+{
+    error_code ec;
+    auto       path = filesystem::weakly_canonical(input, ec);
+    if(ec)
+        path = input;
+    auto modified = filesystem::last_write_time(path, ec);
+    auto size     = ec ? 0 : filesystem::file_size(path, ec);
+    if(ec)
+        throw file_error("Unable to find " + input.string());
 
-    ifstream infile(input);
+    const auto key = path.string();
+    {
+        lock_guard lock(sSourceFilesMutex);
+        auto       it = sSourceFiles.find(key);
+        if(it != sSourceFiles.end() && it->second->modified == modified && it->second->size == size)
+        {
+            sSourceStats.cacheHits++;
+            return it->second;
+        }
+    }
+
+    auto     file = make_shared<SourceFile>();
+    ifstream infile(path);
     if(!infile.good())
         throw file_error("Unable to find " + input.string());
     string line;
     while(getline(infile, line))
     {
-        if(followIncludes && line.starts_with("#include"))
+        file->bytes += line.size() + 1;
+        file->lines.push_back(line);
+    }
+    infile.close();
+    file->modified = modified;
+    file->size     = size;
+    file->once     = IsIncludeOnce(file->lines);
+    sSourceStats.fileReads++;
+
+    lock_guard lock(sSourceFilesMutex);
+    sSourceFiles[key] = file;
+    return file;
+}
+
+static string IncludeFile(const string& line)
+{
+    istringstream iss(line);
+    string        incDirective, incFile;
+    iss >> incDirective;
+    iss >> quoted(incFile);
+    return incFile;
+}
+
+// returns the bytes a naive expansion pasting every #include in full would have produced,
+// remembered per file in expanded so that includes skipped as already seen can count theirs
+static size_t ExpandSource(const filesystem::path& input, const SourceFile& file, unordered_set<string>& included, map<string, size_t>& expanded, vector<string>& lines)
+{
+    size_t bytes = 0;
+    for(const auto& line : file.lines)
+    {
+        if(line.starts_with("#include"))
         {
-            istringstream iss(line);
-            string        incDirective, incFile;
-            iss >> incDirective;
-            iss >> quoted(incFile);
             filesystem::path includePath(input);
             includePath.remove_filename();
-            includePath /= filesystem::path(incFile);
-            const auto& includeLines = LoadSource(includePath.lexically_normal(), true);
-            lines.insert(lines.end(), includeLines.begin(), includeLines.end());
+            includePath /= filesystem::path(IncludeFile(line));
+            includePath = includePath.lexically_normal();
+
+            error_code ec;
+            auto       key = filesystem::weakly_canonical(includePath, ec).string();
+            if(included.contains(key))
+            {
+                // not there yet if it includes itself
+                auto it = expanded.find(key);
+                if(it != expanded.end())
+                    bytes += it->second;
+            }
+            else
+            {
+                const auto include = ReadSourceFile(includePath);
+                if(include->once)
+                    included.insert(key);
+                const auto includeBytes = ExpandSource(includePath, *include, included, expanded, lines);
+                expanded[key]           = includeBytes;
+                bytes += includeBytes;
+            }
+            continue;
         }
-        else
+
+        bytes += line.size() + 1;
+        if(line.starts_with("#pragma once"))
+            continue;
+        if(line.starts_with("#pragma stage"))
+            included.clear(); // each stage is compiled separately so needs its own copy
+        lines.push_back(line);
+    }
+    return bytes;
+}
+
+vector<string> ShaderGC::LoadSource(const filesystem::path& input, bool followIncludes)
+{
+    vector<string> lines;
+
+    if(!followIncludes)
+    {
+        ifstream infile(input);
+        if(!infile.good())
+            throw file_error("Unable to find " + input.string());
+        string line;
+        while(getline(infile, line))
             lines.push_back(line);
+        infile.close();
+        return lines;
     }
-    infile.close();
+
+    unordered_set<string> included;
+    map<string, size_t>   expanded;
+    auto                  bytes = ExpandSource(input, *ReadSourceFile(input), included, expanded, lines);
+    sSourceStats.bytesBefore += bytes;
+    for(const auto& line : lines)
+        sSourceStats.bytesAfter += line.size() + 1;
 
     return lines;
 }
 
+const ShaderGC::SourceStats& ShaderGC::LoadStats()
+{
+    return sSourceStats;
+}
+
 void ShaderGC::ProcessSourceShader(SourceShaderDef& def, ostream& log, bool& warn)
 {
     ostringstream vertexSource;
@@ -153,6 +374,11 @@ void ShaderGC::ProcessSourceShader(SourceShaderDef& def, ostream& log, bool& war
     bool        isVertex = true, isFragment = true;
     const auto& source    = LoadSource(def.input.lexically_normal(), true);
     bool        inComment = false;
+
+    unordered_set<string> paramNames;
+    for(const auto& p : def.params)
+        paramNames.insert(p.name);
+
     for(const auto& line : source)
     {
         auto trimLine = trim(line);
@@ -160,16 +386,7 @@ void ShaderGC::ProcessSourceShader(SourceShaderDef& def, ostream& log, bool& war
         {
             // de-duping as workaround for repeated includes
             auto param = SourceShaderParam(line, 1, 0);
-            bool dupe  = false;
-            for(const auto& p : def.params)
-            {
-                if(p.name == param.name)
-                {
-                    dupe = true;
-                    break;
-                }
-            }
-            if(!dupe)
+            if(paramNames.insert(param.name).second)
                 def.params.push_back(param);
             continue;
         }
@@ -561,6 +778,8 @@ PresetDef* ShaderGC::CompilePreset(std::filesystem::path input, ostream& log, bo
 
     def->ImportPath = input;
 
+    LogCompileCache(log, cache);
+
     return def;
 }
 
@@ -7,6 +7,8 @@ GNU General Public License v3.0
 
 #pragma once
 
+#include <atomic>
+
 #include "PresetDef.h"
 #include "SourceDefs.h"
 #include "ShaderCache.h"
@@ -24,10 +26,20 @@ public:
 class ShaderGC
 {
 public:
+    // LoadSource counters, bytes before are what expanding every #include would produce
+    struct SourceStats
+    {
+        std::atomic<uint64_t> fileReads {0};
+        std::atomic<uint64_t> cacheHits {0};
+        std::atomic<uint64_t> bytesBefore {0};
+        std::atomic<uint64_t> bytesAfter {0};
+    };
+
     static PresetDef* CompilePreset(std::filesystem::path source, std::ostream& log, bool& warn, const ShaderCache& cache);
     static TextureDef CompileTexture(std::filesystem::path source, std::ostream& log, bool& warn);
 
     static std::vector<std::string> LoadSource(const std::filesystem::path& input, bool followIncludes);
+    static const SourceStats&       LoadStats();
     static void                     ProcessSourceShader(SourceShaderDef& def, std::ostream& log, bool& warn);
     static void                     ProcessSourcePreset(SourcePresetDef& def, std::ostream& log, bool& warn);
 
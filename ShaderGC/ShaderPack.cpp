@@ -0,0 +1,601 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include "ShaderPack.h"
+#include "ShaderGC.h"
+
+#include <cstring>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// serializes TOC records
+class PackBuffer
+{
+public:
+    void U32(uint32_t value)
+    {
+        m_data.append((const char*)&value, sizeof(value));
+    }
+
+    void I32(int32_t value)
+    {
+        m_data.append((const char*)&value, sizeof(value));
+    }
+
+    void F32(float value)
+    {
+        m_data.append((const char*)&value, sizeof(value));
+    }
+
+    void Str(const std::string& value)
+    {
+        U32((uint32_t)value.size());
+        m_data.append(value.data(), value.size());
+        m_data.push_back('\0');
+    }
+
+    const std::string& Data() const
+    {
+        return m_data;
+    }
+
+private:
+    std::string m_data;
+};
+
+// bounds-checked reads from the mapped TOC
+class PackCursor
+{
+public:
+    PackCursor(const uint8_t* data, size_t size, size_t offset) : m_data {data}, m_size {size}, m_offset {offset} { }
+
+    uint32_t U32()
+    {
+        uint32_t value;
+        Read(&value, sizeof(value));
+        return value;
+    }
+
+    int32_t I32()
+    {
+        int32_t value;
+        Read(&value, sizeof(value));
+        return value;
+    }
+
+    float F32()
+    {
+        float value;
+        Read(&value, sizeof(value));
+        return value;
+    }
+
+    const char* Str()
+    {
+        auto length = U32();
+        Need((size_t)length + 1);
+        auto str = (const char*)m_data + m_offset;
+        if(str[length] != '\0')
+            throw std::runtime_error("Corrupted shader pack");
+        m_offset += (size_t)length + 1;
+        return str;
+    }
+
+private:
+    void Need(size_t length) const
+    {
+        if(m_offset + length > m_size)
+            throw std::runtime_error("Corrupted shader pack");
+    }
+
+    void Read(void* value, size_t length)
+    {
+        Need(length);
+        memcpy(value, m_data + m_offset, length);
+        m_offset += length;
+    }
+
+    const uint8_t* m_data;
+    size_t         m_size;
+    size_t         m_offset;
+};
+
+// fields every shader record starts with, ahead of its parameters and samplers
+struct PackShaderHeader
+{
+    const char* name;
+    const char* format;
+    int32_t     frameDependent;
+    uint32_t    vertexCode;
+    uint32_t    fragmentCode;
+    uint32_t    vertexHash;
+    uint32_t    fragmentHash;
+};
+
+static PackShaderHeader ReadShaderHeader(PackCursor& record)
+{
+    PackShaderHeader header;
+    header.name           = record.Str();
+    header.format         = record.Str();
+    header.frameDependent = record.I32();
+    header.vertexCode     = record.U32();
+    header.fragmentCode   = record.U32();
+    header.vertexHash     = record.U32();
+    header.fragmentHash   = record.U32();
+    return header;
+}
+
+static std::vector<uint32_t> ContentHash(const void* data, size_t length)
+{
+    return ShaderCache::CalculateHash(std::string((const char*)data, length));
+}
+
+uint32_t ShaderPackWriter::AddBlob(const void* data, size_t length)
+{
+    if(data == nullptr)
+        return PACK_NO_BLOB;
+
+    auto hash     = ContentHash(data, length);
+    auto existing = m_blobIndex.find(hash);
+    if(existing != m_blobIndex.end())
+        return existing->second;
+
+    auto index = (uint32_t)m_blobs.size();
+    m_blobs.emplace_back((const uint8_t*)data, (const uint8_t*)data + length);
+    m_blobIndex.emplace(hash, index);
+    return index;
+}
+
+uint32_t ShaderPackWriter::AddShader(const ShaderDef& def)
+{
+    PackBuffer record;
+    record.Str(def.Name);
+    record.Str(def.Format ? def.Format : "");
+    record.I32(def.FrameDependent);
+    record.U32(AddBlob(def.VertexByteCode, def.VertexLength));
+    record.U32(AddBlob(def.FragmentByteCode, def.FragmentLength));
+    record.U32(AddBlob(def.VertexHash, HASH_LEN * sizeof(uint32_t)));
+    record.U32(AddBlob(def.FragmentHash, HASH_LEN * sizeof(uint32_t)));
+    record.U32((uint32_t)def.Params.size());
+    for(const auto& p : def.Params)
+    {
+        record.Str(p.name);
+        record.I32(p.buffer);
+        record.I32(p.offset);
+        record.I32(p.size);
+        record.F32(p.minValue);
+        record.F32(p.maxValue);
+        record.F32(p.defaultValue);
+        record.F32(p.stepValue);
+        record.Str(p.description);
+    }
+    record.U32((uint32_t)def.Samplers.size());
+    for(const auto& s : def.Samplers)
+    {
+        record.Str(s.name);
+        record.I32(s.binding);
+    }
+
+    auto hash     = ContentHash(record.Data().data(), record.Data().size());
+    auto existing = m_shaderIndex.find(hash);
+    if(existing != m_shaderIndex.end())
+        return existing->second;
+
+    auto index = (uint32_t)m_shaders.size();
+    m_shaders.push_back(record.Data());
+    m_shaderIndex.emplace(hash, index);
+    return index;
+}
+
+uint32_t ShaderPackWriter::AddTexture(const TextureDef& def)
+{
+    PackBuffer record;
+    record.Str(def.Name);
+    record.U32(AddBlob(def.Data, def.DataLength));
+
+    auto hash     = ContentHash(record.Data().data(), record.Data().size());
+    auto existing = m_textureIndex.find(hash);
+    if(existing != m_textureIndex.end())
+        return existing->second;
+
+    auto index = (uint32_t)m_textures.size();
+    m_textures.push_back(record.Data());
+    m_textureIndex.emplace(hash, index);
+    return index;
+}
+
+void ShaderPackWriter::AddPreset(const PresetDef& preset)
+{
+    PackBuffer record;
+    record.Str(preset.Name);
+    record.Str(preset.Category);
+    record.U32((uint32_t)preset.ShaderDefs.size());
+    for(const auto& s : preset.ShaderDefs)
+    {
+        record.U32(AddShader(s));
+        record.U32((uint32_t)s.PresetParams.size());
+        for(const auto& pp : s.PresetParams)
+        {
+            record.Str(pp.first);
+            record.Str(pp.second);
+        }
+    }
+    record.U32((uint32_t)preset.TextureDefs.size());
+    for(const auto& t : preset.TextureDefs)
+    {
+        record.U32(AddTexture(t));
+        record.U32((uint32_t)t.PresetParams.size());
+        for(const auto& pp : t.PresetParams)
+        {
+            record.Str(pp.first);
+            record.Str(pp.second);
+        }
+    }
+    record.U32((uint32_t)preset.Overrides.size());
+    for(const auto& o : preset.Overrides)
+    {
+        record.Str(o.name);
+        record.F32(o.value);
+    }
+    m_presets.push_back(record.Data());
+}
+
+void ShaderPackWriter::Write(const std::filesystem::path& path) const
+{
+    std::ofstream outfile(path, std::ios::binary | std::ios::trunc);
+    if(!outfile.good())
+        throw file_error("Unable to write " + path.string());
+
+    PackHeader header {};
+    outfile.write((const char*)&header, sizeof(header));
+
+    // blobs
+    std::vector<PackBlob> blobs;
+    uint64_t              offset = sizeof(header);
+    for(const auto& b : m_blobs)
+    {
+        static const char padding[PACK_ALIGN] = {};
+        auto              pad                 = (PACK_ALIGN - offset % PACK_ALIGN) % PACK_ALIGN;
+        outfile.write(padding, pad);
+        offset += pad;
+
+        blobs.push_back({offset, (uint32_t)b.size(), ShaderCache::CalculateChecksum(b.data(), b.size())});
+        outfile.write((const char*)b.data(), b.size());
+        offset += b.size();
+    }
+
+    // TOC
+    PackBuffer toc;
+    size_t     recordOffset = sizeof(uint32_t) * 4 + sizeof(PackBlob) * blobs.size() + sizeof(uint32_t) * (m_shaders.size() + m_textures.size() + m_presets.size());
+    toc.U32((uint32_t)blobs.size());
+    for(const auto& b : blobs)
+    {
+        toc.U32((uint32_t)(b.offset & 0xffffffff));
+        toc.U32((uint32_t)(b.offset >> 32));
+        toc.U32(b.length);
+        toc.U32(b.checksum);
+    }
+    for(const auto* records : {&m_shaders, &m_textures, &m_presets})
+    {
+        toc.U32((uint32_t)records->size());
+        for(const auto& r : *records)
+        {
+            toc.U32((uint32_t)recordOffset);
+            recordOffset += r.size();
+        }
+    }
+    std::string tocData = toc.Data();
+    for(const auto* records : {&m_shaders, &m_textures, &m_presets})
+    {
+        for(const auto& r : *records)
+            tocData += r;
+    }
+
+    header.magic       = PACK_MAGIC;
+    header.version     = PACK_VERSION;
+    header.tocOffset   = offset;
+    header.tocSize     = tocData.size();
+    header.tocChecksum = ShaderCache::CalculateChecksum(tocData.data(), tocData.size());
+    outfile.write(tocData.data(), tocData.size());
+    outfile.seekp(0);
+    outfile.write((const char*)&header, sizeof(header));
+    outfile.close();
+    if(outfile.fail())
+        throw file_error("Unable to write " + path.string());
+}
+
+// preset header only, passes are materialized from the pack on first use
+class PackPresetDef : public PresetDef
+{
+public:
+    PackPresetDef(const ShaderPack& pack, size_t index) : PresetDef {}, m_pack {pack}, m_index {index} { }
+
+    void Build() override
+    {
+        m_pack.BuildPreset(m_index, *this);
+    }
+
+private:
+    const ShaderPack& m_pack;
+    size_t            m_index;
+};
+
+ShaderPack::~ShaderPack()
+{
+    Close();
+}
+
+void ShaderPack::Open(const std::filesystem::path& path)
+{
+    Close();
+
+#ifdef _WIN32
+    auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(file == INVALID_HANDLE_VALUE)
+        throw file_error("Unable to open " + path.string());
+    m_file = file;
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size) || size.QuadPart < (LONGLONG)sizeof(PackHeader))
+    {
+        Close();
+        throw std::runtime_error("Invalid shader pack " + path.string());
+    }
+    m_mapping = CreateFileMappingW(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if(m_mapping == NULL)
+    {
+        Close();
+        throw file_error("Unable to map " + path.string());
+    }
+    m_data = (const uint8_t*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+    m_size = (size_t)size.QuadPart;
+#else
+    int file = open(path.c_str(), O_RDONLY);
+    if(file < 0)
+        throw file_error("Unable to open " + path.string());
+
+    struct stat st;
+    if(fstat(file, &st) != 0 || st.st_size < (off_t)sizeof(PackHeader))
+    {
+        close(file);
+        throw std::runtime_error("Invalid shader pack " + path.string());
+    }
+    auto data = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    m_data = data == MAP_FAILED ? nullptr : (const uint8_t*)data;
+    m_size = (size_t)st.st_size;
+#endif
+    if(m_data == nullptr)
+    {
+        Close();
+        throw file_error("Unable to map " + path.string());
+    }
+
+    try
+    {
+        PackHeader header;
+        memcpy(&header, m_data, sizeof(header));
+        if(header.magic != PACK_MAGIC || header.version != PACK_VERSION || header.tocOffset > m_size || header.tocSize > m_size - header.tocOffset)
+            throw std::runtime_error("Invalid shader pack " + path.string());
+        m_tocOffset = (size_t)header.tocOffset;
+        m_tocSize   = (size_t)header.tocSize;
+        if(ShaderCache::CalculateChecksum(Toc(), m_tocSize) != header.tocChecksum)
+            throw std::runtime_error("Corrupted shader pack " + path.string());
+
+        PackCursor toc(Toc(), m_tocSize, 0);
+        m_blobs.resize(toc.U32());
+        for(auto& b : m_blobs)
+        {
+            auto low   = toc.U32();
+            auto high  = toc.U32();
+            b.offset   = ((uint64_t)high << 32) | low;
+            b.length   = toc.U32();
+            b.checksum = toc.U32();
+            if(b.offset > m_size || b.length > m_size - b.offset)
+                throw std::runtime_error("Corrupted shader pack " + path.string());
+        }
+        for(auto* offsets : {&m_shaderOffsets, &m_textureOffsets, &m_presetOffsets})
+        {
+            offsets->resize(toc.U32());
+            for(auto& o : *offsets)
+                o = toc.U32();
+        }
+    }
+    catch(...)
+    {
+        Close();
+        throw;
+    }
+}
+
+void ShaderPack::Close()
+{
+#ifdef _WIN32
+    if(m_data)
+        UnmapViewOfFile(m_data);
+    if(m_mapping)
+        CloseHandle(m_mapping);
+    if(m_file)
+        CloseHandle(m_file);
+#else
+    if(m_data)
+        munmap((void*)m_data, m_size);
+#endif
+    m_data    = nullptr;
+    m_mapping = nullptr;
+    m_file    = nullptr;
+    m_size    = 0;
+    m_blobs.clear();
+    m_shaderOffsets.clear();
+    m_textureOffsets.clear();
+    m_presetOffsets.clear();
+}
+
+const uint8_t* ShaderPack::Blob(uint32_t index, size_t& length, bool verify) const
+{
+    length = 0;
+    if(index == PACK_NO_BLOB)
+        return nullptr;
+    if(index >= m_blobs.size())
+        throw std::runtime_error("Corrupted shader pack");
+
+    const auto& blob = m_blobs[index];
+    if(verify && ShaderCache::CalculateChecksum(m_data + blob.offset, blob.length) != blob.checksum)
+        throw std::runtime_error("Corrupted shader pack");
+    length = blob.length;
+    return m_data + blob.offset;
+}
+
+const uint32_t* ShaderPack::Hash(uint32_t index) const
+{
+    size_t length;
+    auto   hash = Blob(index, length, false);
+    return length == HASH_LEN * sizeof(uint32_t) ? (const uint32_t*)hash : nullptr;
+}
+
+ShaderDef ShaderPack::LoadShader(uint32_t index) const
+{
+    if(index >= m_shaderOffsets.size())
+        throw std::runtime_error("Corrupted shader pack");
+
+    PackCursor record(Toc(), m_tocSize, m_shaderOffsets[index]);
+    ShaderDef  def;
+    const auto header    = ReadShaderHeader(record);
+    def.Name             = header.name;
+    def.Format           = const_cast<char*>(header.format);
+    def.FrameDependent   = header.frameDependent;
+    def.VertexByteCode   = Blob(header.vertexCode, def.VertexLength, true);
+    def.FragmentByteCode = Blob(header.fragmentCode, def.FragmentLength, true);
+    def.VertexHash       = Hash(header.vertexHash);
+    def.FragmentHash     = Hash(header.fragmentHash);
+
+    auto params = record.U32();
+    for(uint32_t i = 0; i < params; i++)
+    {
+        auto name         = record.Str();
+        auto buffer       = record.I32();
+        auto offset       = record.I32();
+        auto size         = record.I32();
+        auto minValue     = record.F32();
+        auto maxValue     = record.F32();
+        auto defaultValue = record.F32();
+        auto stepValue    = record.F32();
+        auto description  = record.Str();
+        def.AddParam(name, buffer, offset, size, minValue, maxValue, defaultValue, stepValue, description);
+    }
+    auto samplers = record.U32();
+    for(uint32_t i = 0; i < samplers; i++)
+    {
+        auto name = record.Str();
+        def.AddSampler(name, record.I32());
+    }
+    return def;
+}
+
+TextureDef ShaderPack::LoadTexture(uint32_t index) const
+{
+    if(index >= m_textureOffsets.size())
+        throw std::runtime_error("Corrupted shader pack");
+
+    PackCursor record(Toc(), m_tocSize, m_textureOffsets[index]);
+    TextureDef def;
+    size_t     length;
+    def.Name       = record.Str();
+    def.Data       = Blob(record.U32(), length, true);
+    def.DataLength = (int)length;
+    return def;
+}
+
+std::vector<PresetDef*> ShaderPack::Presets()
+{
+    std::vector<PresetDef*> presets;
+    for(size_t i = 0; i < m_presetOffsets.size(); i++)
+    {
+        PackCursor record(Toc(), m_tocSize, m_presetOffsets[i]);
+        auto       preset = new PackPresetDef(*this, i);
+        preset->Name      = record.Str();
+        preset->Category  = record.Str();
+        presets.push_back(preset);
+    }
+    return presets;
+}
+
+void ShaderPack::BuildPreset(size_t index, PresetDef& def) const
+{
+    if(index >= m_presetOffsets.size())
+        throw std::runtime_error("Corrupted shader pack");
+
+    PackCursor record(Toc(), m_tocSize, m_presetOffsets[index]);
+    record.Str(); // name
+    record.Str(); // category
+
+    auto shaders = record.U32();
+    for(uint32_t i = 0; i < shaders; i++)
+    {
+        auto sd     = LoadShader(record.U32());
+        auto params = record.U32();
+        for(uint32_t p = 0; p < params; p++)
+        {
+            auto key = record.Str();
+            sd.Param(key, record.Str());
+        }
+        def.ShaderDefs.push_back(sd);
+    }
+
+    auto textures = record.U32();
+    for(uint32_t i = 0; i < textures; i++)
+    {
+        auto td     = LoadTexture(record.U32());
+        auto params = record.U32();
+        for(uint32_t p = 0; p < params; p++)
+        {
+            auto key = record.Str();
+            td.Param(key, record.Str());
+        }
+        def.TextureDefs.push_back(td);
+    }
+
+    auto overrides = record.U32();
+    for(uint32_t i = 0; i < overrides; i++)
+    {
+        auto name = record.Str();
+        def.OverrideParam(name, record.F32());
+    }
+}
+
+std::vector<CachedShader> ShaderPack::CachedShaders() const
+{
+    std::vector<CachedShader> cached;
+    for(auto offset : m_shaderOffsets)
+    {
+        PackCursor record(Toc(), m_tocSize, offset);
+        const auto header = ReadShaderHeader(record);
+
+        size_t vertexLength, fragmentLength;
+        auto   vertexCode   = Blob(header.vertexCode, vertexLength, false);
+        auto   fragmentCode = Blob(header.fragmentCode, fragmentLength, false);
+        auto   vertexHash   = Hash(header.vertexHash);
+        auto   fragmentHash = Hash(header.fragmentHash);
+        if(vertexHash && vertexCode)
+            cached.emplace_back(vertexHash, vertexCode, vertexLength);
+        if(fragmentHash && fragmentCode)
+            cached.emplace_back(fragmentHash, fragmentCode, fragmentLength);
+    }
+    return cached;
+}
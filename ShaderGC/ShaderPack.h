@@ -0,0 +1,126 @@
+/*
+ShaderGC: slangp shader compiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "PresetDef.h"
+#include "ShaderCache.h"
+
+// Shader pack layout (little-endian):
+//   PackHeader
+//   blobs (bytecode, hashes, texture data), each aligned to PACK_ALIGN
+//   TOC: blob table, shader/texture/preset offset tables, then records;
+//        records reference blobs by index and strings are NUL-terminated
+#define PACK_MAGIC 0x4b504753 // SGPK
+#define PACK_VERSION 2
+#define PACK_ALIGN 16
+#define PACK_NO_BLOB 0xffffffff
+
+struct PackHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint64_t tocOffset;
+    uint64_t tocSize;
+    uint32_t tocChecksum; // CRC-32
+    uint32_t reserved;
+};
+
+struct PackBlob
+{
+    uint64_t offset;
+    uint32_t length;
+    uint32_t checksum; // CRC-32
+};
+
+// collects compiled presets, de-duplicating shaders and textures by content
+class ShaderPackWriter
+{
+public:
+    void AddPreset(const PresetDef& preset);
+    void Write(const std::filesystem::path& path) const;
+
+    size_t PresetCount() const
+    {
+        return m_presets.size();
+    }
+
+    size_t ShaderCount() const
+    {
+        return m_shaders.size();
+    }
+
+    size_t TextureCount() const
+    {
+        return m_textures.size();
+    }
+
+private:
+    uint32_t AddBlob(const void* data, size_t length);
+    uint32_t AddShader(const ShaderDef& def);
+    uint32_t AddTexture(const TextureDef& def);
+
+    std::vector<std::vector<uint8_t>>         m_blobs;
+    std::vector<std::string>                  m_shaders;
+    std::vector<std::string>                  m_textures;
+    std::vector<std::string>                  m_presets;
+    std::map<std::vector<uint32_t>, uint32_t> m_blobIndex;
+    std::map<std::vector<uint32_t>, uint32_t> m_shaderIndex;
+    std::map<std::vector<uint32_t>, uint32_t> m_textureIndex;
+};
+
+// memory-mapped read-only view of a pack; definitions point straight into
+// the mapping so the pack must stay open while they're in use
+class ShaderPack
+{
+public:
+    ShaderPack() = default;
+    ~ShaderPack();
+
+    ShaderPack(const ShaderPack&)            = delete;
+    ShaderPack& operator=(const ShaderPack&) = delete;
+
+    void Open(const std::filesystem::path& path);
+    void Close();
+
+    bool IsOpen() const
+    {
+        return m_data != nullptr;
+    }
+
+    size_t PresetCount() const
+    {
+        return m_presetOffsets.size();
+    }
+
+    // returns unbuilt presets whose Build() materializes shaders and textures from the pack
+    std::vector<PresetDef*>   Presets();
+    std::vector<CachedShader> CachedShaders() const;
+    void                      BuildPreset(size_t index, PresetDef& def) const;
+
+private:
+    ShaderDef  LoadShader(uint32_t index) const;
+    TextureDef LoadTexture(uint32_t index) const;
+
+    const uint8_t*  Blob(uint32_t index, size_t& length, bool verify) const;
+    const uint32_t* Hash(uint32_t index) const;
+    const uint8_t* Toc() const
+    {
+        return m_data + m_tocOffset;
+    }
+
+    const uint8_t*        m_data {nullptr};
+    size_t                m_size {0};
+    size_t                m_tocOffset {0};
+    size_t                m_tocSize {0};
+    std::vector<PackBlob> m_blobs;
+    std::vector<uint32_t> m_shaderOffsets;
+    std::vector<uint32_t> m_textureOffsets;
+    std::vector<uint32_t> m_presetOffsets;
+    void*                 m_file {nullptr};
+    void*                 m_mapping {nullptr};
+};
@@ -9,6 +9,8 @@ GNU General Public License v3.0
 
 #include "framework.h"
 
+#include <algorithm>
+
 static inline void ltrim(std::string& s)
 {
     s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch) { return !std::isspace(ch) && ch != '\"'; }));
@@ -103,7 +105,7 @@ struct SourceShaderInfo
 
 struct SourceShaderDef
 {
-    SourceShaderDef(const std::filesystem::path& input, SourceShaderInfo info) : input {input}, info {info}, format {} { }
+    SourceShaderDef(const std::filesystem::path& input, SourceShaderInfo info) : input {input}, info {info}, format {}, frameDependent {-1} { }
 
     std::filesystem::path              input;
     std::string                        vertexSource;
@@ -117,6 +119,7 @@ struct SourceShaderDef
     std::vector<SourceShaderParam>     params;
     SourceShaderInfo                   info;
     std::string                        format;
+    int                                frameDependent;
     std::map<std::string, std::string> presetParams;
     std::vector<std::string>           comments;
 };
@@ -12,6 +12,8 @@ GNU General Public License v3.0
 #include "SPIRV.h"
 #include "HLSL.h"
 #include "ShaderCache.h"
+#include "CompileCache.h"
+#include "ShaderPack.h"
 
 filesystem::path startupPath;
 filesystem::path templatePath;
@@ -21,7 +23,11 @@ filesystem::path reportPath;
 filesystem::path listPath;
 vector<string>   shaderList;
 
-std::string exec(const char* cmd, ofstream& log)
+shared_ptr<CompileCache> compileCache;
+filesystem::path         packPath;
+ShaderPackWriter         packWriter;
+
+std::string exec(const char* cmd, ostream& log)
 {
     std::array<char, 128> buffer;
     std::string           result;
@@ -55,7 +61,7 @@ void saveSource(const filesystem::path& fileName, const string& source)
     outfile.close();
 }
 
-filesystem::path glsl(const filesystem::path& shaderPath, const string& stage, const string& source, ofstream& log, bool& warn)
+filesystem::path glsl(const filesystem::path& shaderPath, const string& stage, const string& source, ostream& log, bool& warn)
 {
     filesystem::path input = tempPath / shaderPath;
     input.replace_extension("." + stage + ".glsl");
@@ -91,7 +97,19 @@ filesystem::path glsl(const filesystem::path& shaderPath, const string& stage, c
     return output;
 }
 
-pair<string, string> spirv(const filesystem::path& input, const std::string& stage, ofstream& log, bool& warn)
+vector<uint32_t> loadSPIRV(const filesystem::path& input)
+{
+    ifstream inf(input, ios::binary | ios::ate);
+    auto     size = inf.tellg();
+    inf.seekg(0, ios::beg);
+    vector<uint32_t> buffer;
+    buffer.resize(size / sizeof(uint32_t));
+    inf.read((char*)buffer.data(), size);
+    inf.close();
+    return buffer;
+}
+
+pair<string, string> spirv(const filesystem::path& input, const std::string& stage, ostream& log, bool& warn)
 {
     if(_tools)
     {
@@ -109,14 +127,7 @@ pair<string, string> spirv(const filesystem::path& input, const std::string& sta
     }
     else
     {
-        ifstream inf(input, ios::binary | ios::ate);
-        auto     size = inf.tellg();
-        inf.seekg(0, ios::beg);
-        vector<uint32_t> buffer;
-        buffer.resize(size / sizeof(uint32_t));
-        inf.read((char*)buffer.data(), size);
-        inf.close();
-        return SPIRV::GenerateHLSL(buffer, stage == "frag", log, warn);
+        return SPIRV::GenerateHLSL(loadSPIRV(input), stage == "frag", log, warn);
     }
 }
 
@@ -162,7 +173,7 @@ static string intArrayToString(uint32_t* data, size_t size)
     return sbuf.str();
 }
 
-pair<string, string> fxc(const filesystem::path& shaderPath, const string& profile, const string& source, ofstream& log, bool& warn)
+pair<string, string> fxc(const filesystem::path& shaderPath, const string& profile, const string& source, vector<uint8_t>& bytecode, ostream& log, bool& warn)
 {
     filesystem::path input = tempPath / shaderPath;
     input.replace_extension("." + profile + ".hlsl");
@@ -217,9 +228,10 @@ pair<string, string> fxc(const filesystem::path& shaderPath, const string& profi
     }
     else
     {
-        auto bin = HLSL::CompileHLSL(fullSource.c_str(), fullSource.size(), profile.c_str(), true, log, warn);
+        if(bytecode.empty())
+            bytecode = HLSL::CompileHLSL(fullSource.c_str(), fullSource.size(), profile.c_str(), true, log, warn);
 
-        auto str     = byteArrayToString(bin.data(), bin.size());
+        auto str     = byteArrayToString(bytecode.data(), bytecode.size());
         auto hash    = ShaderCache::CalculateHash(source);
         auto hashStr = intArrayToString(hash.data(), hash.size());
 
@@ -327,7 +339,7 @@ void updatePresetList(const SourceShaderInfo& shaderInfo)
         saveSource(listPath, shaderList);
 }
 
-void populateShaderTemplate(SourceShaderDef def, ofstream& log)
+void populateShaderTemplate(SourceShaderDef def, ostream& log)
 {
     const auto& info = def.info;
 
@@ -339,6 +351,7 @@ void populateShaderTemplate(SourceShaderDef def, ofstream& log)
     replace(bufferString, "%CLASS_NAME%", info.className);
     replace(bufferString, "%SHADER_NAME%", info.shaderName);
     replace(bufferString, "%SHADER_FORMAT%", def.format);
+    replace(bufferString, "%FRAME_DEPENDENT%", std::to_string(def.frameDependent));
     replace(bufferString, "%SHADER_CATEGORY%", info.category);
     replace(bufferString, "%VERTEX_SOURCE%", splitCode(def.vertexSource));
     replace(bufferString, "%FRAGMENT_SOURCE%", splitCode(def.fragmentSource));
@@ -429,7 +442,7 @@ void populateShaderTemplate(SourceShaderDef def, ofstream& log)
     log << "Generated ShaderDef " << info.outputPath << endl;
 }
 
-void populateTextureTemplate(SourceTextureDef def, ofstream& log)
+void populateTextureTemplate(SourceTextureDef def, ostream& log)
 {
     const auto& info = def.info;
 
@@ -478,7 +491,7 @@ void populateTextureTemplate(SourceTextureDef def, ofstream& log)
 }
 
 void populatePresetTemplate(
-    const filesystem::path& input, const vector<SourceShaderDef>& shaders, const vector<SourceTextureDef>& textures, const vector<SourceShaderParam>& overrides, ofstream& log)
+    const filesystem::path& input, const vector<SourceShaderDef>& shaders, const vector<SourceTextureDef>& textures, const vector<SourceShaderParam>& overrides, ostream& log)
 {
     const auto& info = getShaderInfo(input, "PresetDef");
 
@@ -587,30 +600,79 @@ void populatePresetTemplate(
     log << "Generated PresetDef " << info.outputPath << endl;
 }
 
-void processShader(SourceShaderDef& def, ofstream& log, bool& warn)
+// GLSL -> SPIRV -> HLSL, served from the compile cache when the preprocessed source is unchanged
+bool compileStage(const filesystem::path& shaderPath, const string& stage, const string& source, CompileCacheEntry& entry, ostream& log, bool& warn)
+{
+    const bool useCache = compileCache && !_tools;
+    if(useCache && compileCache->Find(source, stage == "frag", entry))
+    {
+        // diagnostics of the compile that produced the entry, so a cached build warns the same
+        log << "Compile cache hit " << shaderPath.string() << " " << stage << endl;
+        log << entry.log;
+        warn |= entry.warn;
+        return true;
+    }
+
+    ostringstream stageLog;
+    const auto&   spv    = glsl(shaderPath, stage, source, stageLog, entry.warn);
+    const auto&   output = spirv(spv, stage, stageLog, entry.warn);
+    entry.hlsl           = output.first;
+    entry.metadata       = output.second;
+    entry.spirv          = loadSPIRV(spv);
+    entry.log            = stageLog.str();
+    log << entry.log;
+    warn |= entry.warn;
+    return false;
+}
+
+// HLSL -> DXBC, diagnostics are kept with the entry
+pair<string, string> fxcStage(const filesystem::path& shaderPath, const string& profile, CompileCacheEntry& entry, ostream& log, bool& warn)
+{
+    ostringstream stageLog;
+    auto          code = fxc(shaderPath, profile, entry.hlsl, entry.bytecode, stageLog, entry.warn);
+    entry.log += stageLog.str();
+    log << stageLog.str();
+    warn |= entry.warn;
+    return code;
+}
+
+void processShader(SourceShaderDef& def, ostream& log, bool& warn)
 {
     try
     {
         ShaderGC::ProcessSourceShader(def, log, warn);
 
-        const auto& vertexOutput   = spirv(glsl(def.input, "vert", def.vertexSource, log, warn), "vert", log, warn);
-        const auto& fragmentOutput = spirv(glsl(def.input, "frag", def.fragmentSource, log, warn), "frag", log, warn);
-        def.vertexSource           = vertexOutput.first;
-        def.vertexMetadata         = vertexOutput.second;
-        def.fragmentSource         = fragmentOutput.first;
-        def.fragmentMetadata       = fragmentOutput.second;
+        CompileCacheEntry vertexEntry, fragmentEntry;
+        const auto        vertexSource   = def.vertexSource;
+        const auto        fragmentSource = def.fragmentSource;
+        const auto        vertexFound    = compileStage(def.input, "vert", vertexSource, vertexEntry, log, warn);
+        const auto        fragmentFound  = compileStage(def.input, "frag", fragmentSource, fragmentEntry, log, warn);
+
+        def.vertexSource     = vertexEntry.hlsl;
+        def.vertexMetadata   = vertexEntry.metadata;
+        def.fragmentSource   = fragmentEntry.hlsl;
+        def.fragmentMetadata = fragmentEntry.metadata;
+        def.frameDependent   = SPIRV::FrameDependent(vertexEntry.spirv) || SPIRV::FrameDependent(fragmentEntry.spirv);
 
         filesystem::path metaOutput(tempPath / def.input);
         metaOutput.replace_extension(".meta");
-        saveSource(metaOutput, fragmentOutput.second);
+        saveSource(metaOutput, fragmentEntry.metadata);
 
-        auto vertexCode      = fxc(def.input, "vs_5_0", vertexOutput.first, log, warn);
-        auto fragmentCode    = fxc(def.input, "ps_5_0", fragmentOutput.first, log, warn);
+        auto vertexCode      = fxcStage(def.input, "vs_5_0", vertexEntry, log, warn);
+        auto fragmentCode    = fxcStage(def.input, "ps_5_0", fragmentEntry, log, warn);
         def.vertexByteCode   = vertexCode.first;
         def.vertexHash       = vertexCode.second;
         def.fragmentByteCode = fragmentCode.first;
         def.fragmentHash     = fragmentCode.second;
 
+        if(compileCache && !_tools)
+        {
+            if(!vertexFound)
+                compileCache->Store(vertexSource, false, vertexEntry);
+            if(!fragmentFound)
+                compileCache->Store(fragmentSource, true, fragmentEntry);
+        }
+
         replace(def.vertexByteCode, " ", "");
         replace(def.vertexHash, " ", "");
         replace(def.fragmentByteCode, " ", "");
@@ -658,103 +720,103 @@ string bin2string(filesystem::path input)
     return oss.str();
 }
 
-void processTexture(SourceTextureDef def, ofstream& log)
+void processTexture(SourceTextureDef def, ostream& log)
 {
     def.data = bin2string(def.input);
     populateTextureTemplate(def, log);
 }
 
-void processPreset(SourcePresetDef& def, ofstream& log, bool& warn)
+OutputJobs outputJobs;
+
+struct FileTask
+{
+    FileTask(const filesystem::path& input) : input {input}, preset {input, getShaderInfo(input, "PresetDef")} { }
+
+    filesystem::path   input;
+    SourcePresetDef    preset;
+    vector<OutputJob*> shaderJobs;
+    size_t             texturesDone {0};
+    ostringstream      log;
+    bool               warn {false};
+    bool               err {false};
+    string             error;
+};
+
+void compilePreset(FileTask& task)
 {
-    ShaderGC::ProcessSourcePreset(def, log, warn);
+    auto& def = task.preset;
+    ShaderGC::ProcessSourcePreset(def, task.log, task.warn);
 
     for(auto& s : def.shaders)
     {
-        s.info = getShaderInfo(s.input, "ShaderDef");
-        if(_force || !filesystem::exists(s.info.outputPath))
-        {
-            processShader(s, log, warn);
-        }
-        updateShaderList(s.info);
-        updateCacheList(s.info);
+        s.info    = getShaderInfo(s.input, "ShaderDef");
+        auto& job = outputJobs.generateOnce(s.info.outputPath, false, _force, [&](OutputJob& job) {
+            // compile a clean copy so #pragma name can be told apart from preset params
+            SourceShaderDef sd(s.input, s.info);
+            processShader(sd, task.log, task.warn);
+            auto alias = sd.presetParams.find("alias");
+            if(alias != sd.presetParams.end())
+            {
+                job.hasAlias = true;
+                job.alias    = alias->second;
+            }
+        });
+        task.shaderJobs.push_back(&job);
     }
 
     for(auto& t : def.textures)
     {
         t.info = getShaderInfo(t.input, "TextureDef");
-        if(_force || !filesystem::exists(t.info.outputPath))
-        {
-            processTexture(t, log);
-        }
-        updateTextureList(t.info);
+        outputJobs.generateOnce(t.info.outputPath, false, _force, [&](OutputJob&) { processTexture(t, task.log); });
+        task.texturesDone++;
     }
-
-    def.info = getShaderInfo(def.input, "PresetDef");
-    if(_force || !filesystem::exists(def.info.outputPath))
-    {
-        populatePresetTemplate(def.input, def.shaders, def.textures, def.overrides, log);
-    }
-    updatePresetList(def.info);
 }
 
-void processFile(const filesystem::path& input, ofstream& reportStream)
+// thread-safe part: runs glslang, SPIRV-Cross and fxc and writes shader/texture headers
+void compileFile(FileTask& task)
 {
-    if(input.filename().string()[0] == '-') // exclusions (files)
-        return;
-
-    if(input.string()[0] == '-') // exclusions (folders)
-        return;
-
-    if(!filesystem::exists(input))
-    {
-        cout << "Cannot find file " << input << endl;
-        return;
-    }
-
-    auto inputString = input.string();
-    std::replace(inputString.begin(), inputString.end(), '\\', '!');
-    std::filesystem::path logPath(tempPath / "logs" / (inputString + ".log"));
-    std::filesystem::create_directory(tempPath / "logs");
-    ofstream log(logPath);
-    bool     warn = false;
-    bool     err  = false;
-
     try
     {
-        std::cout << input << " ...";
-        if(input.extension() == ".slang")
+        if(task.input.extension() == ".slang")
         {
-            SourceShaderDef sd(input, getShaderInfo(input, "ShaderDef"));
-            processShader(sd, log, warn);
+            SourceShaderDef sd(task.input, getShaderInfo(task.input, "ShaderDef"));
+            auto&           job = outputJobs.generateOnce(sd.info.outputPath, true, _force, [&](OutputJob&) { processShader(sd, task.log, task.warn); });
+            task.shaderJobs.push_back(&job);
         }
-        else if(input.extension() == ".slangp")
+        else if(task.input.extension() == ".slangp")
         {
-            SourcePresetDef sd(input, getShaderInfo(input, "PresetDef"));
-            processPreset(sd, log, warn);
+            compilePreset(task);
         }
-
-        log << "OK" << endl;
     }
     catch(std::exception& e)
     {
-        cout << e.what() << endl;
-        err = true;
-
-        log << "ERROR:" << e.what() << endl;
+        task.err   = true;
+        task.error = e.what();
     }
+}
+
+void reportFile(const filesystem::path& input, const string& output, bool warn, bool err, const string& error, ofstream& reportStream)
+{
+    auto inputString = input.string();
+    std::replace(inputString.begin(), inputString.end(), '\\', '!');
+    const char* suffix = err ? ".ERROR.log" : (warn ? ".WARN.log" : ".log");
+    std::filesystem::create_directory(tempPath / "logs");
+    ofstream log(tempPath / "logs" / (inputString + suffix));
+    log << output;
+    if(err)
+        log << "ERROR:" << error << endl;
+    else
+        log << "OK" << endl;
     log.close();
 
     if(err)
     {
-        auto orgPath(logPath);
-        std::filesystem::rename(orgPath, logPath.replace_extension(".ERROR.log"));
+        cout << error << endl;
         std::cout << "ERROR" << endl;
         reportStream << "ERROR: " << input << endl;
     }
     else if(warn)
     {
-        auto orgPath(logPath);
-        std::filesystem::rename(orgPath, logPath.replace_extension(".WARN.log"));
         std::cout << "WARN" << endl;
         reportStream << "WARN: " << input << endl;
     }
@@ -765,6 +827,139 @@ void processFile(const filesystem::path& input, ofstream& reportStream)
     }
 }
 
+// serial part: runs in input order so lists and preset headers match a single-threaded run
+void registerFile(FileTask& task, ofstream& reportStream)
+{
+    std::cout << task.input << " ...";
+
+    auto& def = task.preset;
+    if(task.input.extension() == ".slangp")
+    {
+        for(size_t i = 0; i < task.shaderJobs.size(); i++)
+        {
+            auto& s   = def.shaders[i];
+            auto& job = *task.shaderJobs[i];
+            // a serial run only re-processes the shader source (picking up #pragma name)
+            // for the first preset using it, unless forced
+            if(job.hasAlias && (_force || (!job.existed && !job.registered)))
+                s.presetParams["alias"] = job.alias;
+            job.registered = true;
+            updateShaderList(s.info);
+            updateCacheList(s.info);
+        }
+
+        for(size_t i = 0; i < task.texturesDone; i++)
+            updateTextureList(def.textures[i].info);
+
+        if(!task.err)
+        {
+            try
+            {
+                if(_force || !filesystem::exists(def.info.outputPath))
+                {
+                    populatePresetTemplate(def.input, def.shaders, def.textures, def.overrides, task.log);
+                }
+                updatePresetList(def.info);
+            }
+            catch(std::exception& e)
+            {
+                task.err   = true;
+                task.error = e.what();
+            }
+        }
+    }
+    else if(!task.err && task.shaderJobs.size())
+    {
+        task.shaderJobs[0]->registered = true;
+    }
+
+    reportFile(task.input, task.log.str(), task.warn, task.err, task.error, reportStream);
+}
+
+vector<filesystem::path> filterInputs(const vector<filesystem::path>& inputs)
+{
+    vector<filesystem::path> filtered;
+    for(const auto& input : inputs)
+    {
+        if(input.filename().string()[0] == '-') // exclusions (files)
+            continue;
+
+        if(input.string()[0] == '-') // exclusions (folders)
+            continue;
+
+        if(!filesystem::exists(input))
+        {
+            cout << "Cannot find file " << input << endl;
+            continue;
+        }
+
+        filtered.push_back(input);
+    }
+    return filtered;
+}
+
+void processFiles(const vector<filesystem::path>& inputs, ofstream& reportStream)
+{
+    vector<unique_ptr<FileTask>> tasks;
+    for(const auto& input : filterInputs(inputs))
+        tasks.push_back(make_unique<FileTask>(input));
+
+    runJobs(_jobs, tasks.size(), [&](size_t i) { compileFile(*tasks[i]); }, [&](size_t i) { registerFile(*tasks[i], reportStream); });
+}
+
+// -pack: compiles like a runtime import and adds to a single shader pack instead of headers
+void packFiles(const vector<filesystem::path>& inputs, ofstream& reportStream)
+{
+    struct PackTask
+    {
+        filesystem::path      input;
+        unique_ptr<PresetDef> preset;
+        ostringstream         log;
+        bool                  warn {false};
+        string                error;
+    };
+
+    ShaderCache cache;
+    cache.m_compileCache = compileCache;
+
+    vector<unique_ptr<PackTask>> tasks;
+    for(const auto& input : filterInputs(inputs))
+    {
+        tasks.push_back(make_unique<PackTask>());
+        tasks.back()->input = input;
+    }
+
+    runJobs(
+        _jobs,
+        tasks.size(),
+        [&](size_t i) {
+            auto& task = *tasks[i];
+            try
+            {
+                const auto& info = getShaderInfo(task.input, "PresetDef", true, false);
+                task.preset.reset(ShaderGC::CompilePreset(task.input, task.log, task.warn, cache));
+                task.preset->Name     = info.shaderName;
+                task.preset->Category = info.category;
+                task.preset->MakeDynamic();
+            }
+            catch(std::exception& e)
+            {
+                task.preset.reset();
+                task.error = e.what();
+            }
+        },
+        [&](size_t i) {
+            auto& task = *tasks[i];
+            std::cout << task.input << " ...";
+            if(task.preset)
+            {
+                packWriter.AddPreset(*task.preset);
+                task.preset.reset();
+            }
+            reportFile(task.input, task.log.str(), task.warn, !task.error.empty(), task.error, reportStream);
+        });
+}
+
 void processListTemplate()
 {
     listPath /= filesystem::path(string(_libName) + ".h");
@@ -811,6 +1006,25 @@ int main(int argc, char* argv[])
                 _force = true;
                 continue;
             }
+            if(input == "-j")
+            {
+                // -j alone uses all cores
+                _jobs = (int)thread::hardware_concurrency();
+                if(i + 1 < argc && isdigit((unsigned char)argv[i + 1][0]))
+                    _jobs = atoi(argv[++i]);
+                _jobs = max(_jobs, 1);
+                continue;
+            }
+            if(input == "-pack" && i + 1 < argc)
+            {
+                packPath = (startupPath / filesystem::path(argv[++i])).lexically_normal();
+                continue;
+            }
+            if(input == "-nocache")
+            {
+                _cache = false;
+                continue;
+            }
             if(input == "-tools")
             {
                 if(!filesystem::exists(_fxcPath))
@@ -823,6 +1037,10 @@ int main(int argc, char* argv[])
                 _tools = true;
                 continue;
             }
+            if(_cache && !compileCache)
+                compileCache = make_shared<CompileCache>(startupPath / filesystem::path(_cachePath), 2ull * 1024 * 1024 * 1024);
+
+            vector<filesystem::path> inputs;
             if(input == "*")
             {
                 for(auto& p : filesystem::recursive_directory_iterator("."))
@@ -839,7 +1057,7 @@ int main(int argc, char* argv[])
 
                         if(_force || !isExcluded)
                         {
-                            processFile(p.path().lexically_normal(), reportStream);
+                            inputs.push_back(p.path().lexically_normal());
                         }
                     }
                 }
@@ -850,12 +1068,23 @@ int main(int argc, char* argv[])
                 {
                     for(auto& p : filesystem::directory_iterator(input))
                     {
-                        processFile(p.path(), reportStream);
+                        inputs.push_back(p.path());
                     }
                 }
                 else
-                    processFile(input, reportStream);
+                    inputs.push_back(input);
             }
+            if(packPath.empty())
+                processFiles(inputs, reportStream);
+            else
+                packFiles(inputs, reportStream);
+        }
+
+        if(!packPath.empty())
+        {
+            packWriter.Write(packPath);
+            std::cout << "Generated pack " << packPath.string() << endl;
+            reportStream << "Pack: " << packWriter.PresetCount() << " presets, " << packWriter.ShaderCount() << " shaders, " << packWriter.TextureCount() << " textures" << endl;
         }
     }
     catch(exception& e)
@@ -863,6 +1092,12 @@ int main(int argc, char* argv[])
         reportStream << "EXCEPTION: " << e.what() << endl;
     }
 
+    const auto& sourceStats = ShaderGC::LoadStats();
+    reportStream << "Source: " << sourceStats.bytesBefore / 1024 << " KB with all includes, " << sourceStats.bytesAfter / 1024 << " KB include-once, "
+                 << sourceStats.fileReads << " file reads, " << sourceStats.cacheHits << " cached" << endl;
+    if(compileCache)
+        reportStream << "Compile cache: " << compileCache->Hits() << " hits, " << compileCache->Misses() << " misses, " << compileCache->Size() / (1024 * 1024) << " MB"
+                     << endl;
     reportStream << "Finishing at " << (std::format("{:%Y-%m-%d %H:%M:%S}", std::chrono::system_clock::now())) << endl;
     reportStream.close();
 }
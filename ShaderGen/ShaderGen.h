@@ -25,8 +25,14 @@ GNU General Public License v3.0
 #include <map>
 #include <unordered_set>
 #include <filesystem>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <atomic>
+#include <functional>
 
 #include "SourceDefs.h"
+#include "WorkQueue.h"
 
 using namespace std;
 
@@ -37,6 +43,7 @@ const char* _templatePath = "..\\ShaderGen\\";
 const char* _toolsPath    = "..\\Tools\\";
 const char* _outputPath   = "..\\ShaderGlass\\Shaders\\";
 const char* _tempPath     = "temp";
+const char* _cachePath    = "cache";
 
 // only needed when using -tools option
 const char* _fxcPath  = "C:\\Program Files (x86)\\Windows Kits\\10\\bin\\10.0.26100.0\\x64\\fxc.exe";
@@ -49,6 +56,8 @@ const char*      _skUrl = "https://forums.libretro.com/t/new-sonkun-crt-guest-ad
 const char*      _rcUrl = "https://github.com/RetroCrisis/Retro-Crisis-GDV-NTSC";
 bool             _force = false;
 bool             _tools = false;
+int              _jobs  = 1;
+bool             _cache = true;
 filesystem::path outputPath;
 
 void replace(string& str, const string& macro, const string& value)
@@ -61,7 +70,7 @@ void replace(string& str, const string& macro, const string& value)
     }
 }
 
-SourceShaderInfo getShaderInfo(const filesystem::path& slangInput, const string& suffix, bool fullPath = true)
+SourceShaderInfo getShaderInfo(const filesystem::path& slangInput, const string& suffix, bool fullPath = true, bool createDirectories = true)
 {
     SourceShaderInfo info;
 
@@ -117,7 +126,8 @@ SourceShaderInfo getShaderInfo(const filesystem::path& slangInput, const string&
     info.sourcePath   = slangInput;
     info.relativePath = filesystem::path(string(_libName) + "\\" + info.category + "\\" + info.className + suffix + ".h").lexically_normal();
     info.outputPath   = filesystem::path(outputPath / info.relativePath.string()).lexically_normal();
-    filesystem::create_directories(info.outputPath.parent_path());
+    if(createDirectories)
+        filesystem::create_directories(info.outputPath.parent_path());
 
     replace(info.category, "\\", "/");
     //replace(info.category, "/", "-");
@@ -0,0 +1,121 @@
+/*
+ShaderGen: shader precompiler for ShaderGlass
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Shader and texture headers are generated at most once per run; presets sharing
+// a .slang or texture wait on whichever worker claimed it first
+struct OutputJob
+{
+    std::shared_future<void> done;
+    bool                     existed {false}; // header was present before this run
+    bool                     compiled {false};
+    bool                     registered {false};
+    bool                     hasAlias {false};
+    std::string              alias; // #pragma name
+};
+
+class OutputJobs
+{
+public:
+    // runs generate unless the output was generated this run, or existed before it and neither
+    // force nor always is set, then waits for whoever did generate it; always regenerates once
+    OutputJob& generateOnce(const std::filesystem::path& outputPath, bool always, bool force, const std::function<void(OutputJob&)>& generate)
+    {
+        std::unique_lock lock(m_mutex);
+
+        auto [it, inserted] = m_jobs.try_emplace(outputPath);
+        auto& job           = it->second;
+        if(inserted)
+            job.existed = std::filesystem::exists(outputPath);
+
+        if(!job.compiled && (always || (inserted && (force || !job.existed))))
+        {
+            std::promise<void> generated;
+            job.done     = generated.get_future().share();
+            job.compiled = true;
+            lock.unlock();
+
+            try
+            {
+                generate(job);
+                generated.set_value();
+            }
+            catch(...)
+            {
+                generated.set_exception(std::current_exception());
+            }
+            lock.lock();
+        }
+        else if(inserted)
+        {
+            // generated by a previous run
+            std::promise<void> skipped;
+            skipped.set_value();
+            job.done = skipped.get_future().share();
+        }
+
+        auto done = job.done;
+        lock.unlock();
+        done.get(); // rethrows generation error
+        return job;
+    }
+
+private:
+    std::map<std::filesystem::path, OutputJob> m_jobs;
+    std::mutex                                 m_mutex;
+};
+
+// runs compile(i) on jobs workers and consume(i) on this thread in index order;
+// compile must not throw
+inline void runJobs(int jobs, size_t count, const std::function<void(size_t)>& compile, const std::function<void(size_t)>& consume)
+{
+    if(jobs <= 1 || count <= 1)
+    {
+        for(size_t i = 0; i < count; i++)
+        {
+            compile(i);
+            consume(i);
+        }
+        return;
+    }
+
+    std::vector<std::promise<void>> compiled(count);
+    std::atomic<size_t>             nextTask {0};
+    std::vector<std::thread>        workers;
+    for(size_t w = 0; w < std::min((size_t)jobs, count); w++)
+    {
+        workers.emplace_back([&]() {
+            size_t t;
+            while((t = nextTask++) < count)
+            {
+                compile(t);
+                compiled[t].set_value();
+            }
+        });
+    }
+
+    for(size_t i = 0; i < count; i++)
+    {
+        compiled[i].get_future().wait();
+        consume(i);
+    }
+
+    for(auto& w : workers)
+        w.join();
+}
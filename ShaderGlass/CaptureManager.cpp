@@ -15,6 +15,7 @@ GNU General Public License v3.0
 #include "Util/d3dHelpers.h"
 
 #include <wincodec.h>
+#include "Shlobj.h"
 #include "WIC\ScreenGrab11.h"
 #include "WIC\WICTextureLoader11.h"
 
@@ -26,8 +27,13 @@ CaptureManager::CaptureManager(HINSTANCE instance) : m_options(), m_deviceName(L
 
 bool CaptureManager::Initialize()
 {
+    wchar_t modulePath[MAX_PATH];
+    if(GetModuleFileNameW(NULL, modulePath, MAX_PATH))
+        OpenShaderPack(std::filesystem::path(modulePath).replace_filename("ShaderGlass.sgpack"));
+
+    const auto& presets = RetroArchPresets();
     m_presetList.push_back(make_unique<PassthroughPresetDef>());
-    m_presetList.insert(m_presetList.end(), RetroArchPresetList.begin(), RetroArchPresetList.end());
+    m_presetList.insert(m_presetList.end(), presets.begin(), presets.end());
     m_frameEvent = CreateEvent(NULL, FALSE, FALSE, L"FrameEvent");
     return false;
 }
@@ -48,9 +54,19 @@ vector<tuple<int, ShaderParam*>> CaptureManager::Params()
 const ShaderCache& CaptureManager::Cache()
 {
     if(m_shaderCache.empty())
+        m_shaderCache.Add(RetroArchCachedShaders());
+
+    if(!m_shaderCache.m_compileCache)
     {
-        const auto& raShaders = RetroArchCachedShaders();
-        m_shaderCache.m_cachedShaders.insert(m_shaderCache.m_cachedShaders.begin(), raShaders.begin(), raShaders.end());
+        // persist imported shader compilation results between runs
+        std::filesystem::path cachePath("ShaderGlassCache");
+        wchar_t*              path;
+        if(SUCCEEDED(SHGetKnownFolderPath(FOLDERID_LocalAppData, 0, NULL, &path)))
+        {
+            cachePath = std::filesystem::path(path) / "ShaderGlass" / "Cache";
+            CoTaskMemFree(path);
+        }
+        m_shaderCache.m_compileCache = std::make_shared<CompileCache>(cachePath, 256ull * 1024 * 1024);
     }
 
     return m_shaderCache;
@@ -138,7 +154,15 @@ bool CaptureManager::StartSession()
         }
     }
 
-    m_shaderGlass = make_unique<ShaderGlass>(m_cursorEmulator);
+    if(m_options.gazeInput)
+        m_gazeSource.Start(m_options.gazePort);
+
+    m_shaderGlass = make_unique<ShaderGlass>(m_cursorEmulator, m_gazeSource);
+    m_shaderGlass->SetGazeBinding(m_options.gazeBinding);
+    m_shaderGlass->SetGazeFilter(m_options.gazeFilter);
+    m_shaderGlass->SetFoveation(m_options.foveation);
+    m_shaderGlass->SetTileRefresh(m_options.peripheryTiles);
+    m_shaderGlass->SetSaccadeBudget(m_options.saccades);
     m_shaderGlass->Initialize(m_options.outputWindow,
                               m_options.captureWindow,
                               m_options.monitor,
@@ -295,6 +319,24 @@ float CaptureManager::OutFPS()
     return 0.f;
 }
 
+float CaptureManager::GazeLatency()
+{
+    if(m_shaderGlass && m_gazeSource.Active())
+    {
+        return m_shaderGlass->GazeLatency();
+    }
+    return 0.f;
+}
+
+std::pair<uint64_t, uint64_t> CaptureManager::TargetBytes()
+{
+    if(m_shaderGlass)
+    {
+        return m_shaderGlass->TargetBytes();
+    }
+    return {0, 0};
+}
+
 float CaptureManager::InFPS()
 {
     if(m_session)
@@ -373,6 +415,8 @@ void CaptureManager::Exit()
         m_shaderGlass->Stop();
         delete m_shaderGlass.release();
 
+        m_gazeSource.Stop();
+
         if(m_debug)
         {
             m_debug->ReportLiveDeviceObjects(D3D11_RLDO_DETAIL | D3D11_RLDO_IGNORE_INTERNAL);
@@ -11,37 +11,45 @@ GNU General Public License v3.0
 #include "ShaderCache.h"
 #include "DeviceCapture.h"
 #include "CursorEmulator.h"
+#include "GazeSource.h"
 
 struct CaptureOptions
 {
-    HMONITOR     monitor {0};
-    HWND         captureWindow {0};
-    HWND         outputWindow {0};
-    float        pixelWidth {3.0f};
-    float        pixelHeight {3.0f};
-    float        aspectRatio {1.0f};
-    unsigned     presetNo {0};
-    unsigned     frameSkip {0};
-    float        outputScale {1};
-    bool         flipHorizontal {false};
-    bool         flipVertical {false};
-    bool         clone {false};
-    bool         transparent {false};
-    bool         paused {false};
-    bool         captureCursor {false};
-    std::wstring imageFile {};
-    int          imageWidth {0};
-    int          imageHeight {0};
-    int          deviceFormatNo {0};
-    RECT         inputArea {0, 0, 0, 0};
-    float        dpiScale {1.0f};
-    bool         freeScale {false};
-    bool         flipMode {false};
-    bool         allowTearing {false};
-    bool         maxCaptureRate {false};
-    bool         useHDR {false};
-    RECT         croppedArea {0, 0, 0, 0};
-    bool         vertical {false};
+    HMONITOR           monitor {0};
+    HWND               captureWindow {0};
+    HWND               outputWindow {0};
+    float              pixelWidth {3.0f};
+    float              pixelHeight {3.0f};
+    float              aspectRatio {1.0f};
+    unsigned           presetNo {0};
+    unsigned           frameSkip {0};
+    float              outputScale {1};
+    bool               flipHorizontal {false};
+    bool               flipVertical {false};
+    bool               clone {false};
+    bool               transparent {false};
+    bool               paused {false};
+    bool               captureCursor {false};
+    std::wstring       imageFile {};
+    int                imageWidth {0};
+    int                imageHeight {0};
+    int                deviceFormatNo {0};
+    RECT               inputArea {0, 0, 0, 0};
+    float              dpiScale {1.0f};
+    bool               freeScale {false};
+    bool               flipMode {false};
+    bool               allowTearing {false};
+    bool               maxCaptureRate {false};
+    bool               useHDR {false};
+    RECT               croppedArea {0, 0, 0, 0};
+    bool               vertical {false};
+    bool               gazeInput {false};
+    int                gazePort {GAZE_DEFAULT_PORT};
+    GazeBinding        gazeBinding {};
+    GazeFilterSettings gazeFilter {};
+    FoveaSettings      foveation {};
+    TileSettings       peripheryTiles {};
+    SaccadeSettings    saccades {};
 };
 
 class CaptureManager
@@ -91,9 +99,12 @@ public:
     void  Exit();
     float InFPS();
     float OutFPS();
+    float GazeLatency();
     int   FindByName(const char* presetName);
     bool  FindDeviceFormat(int deviceFormatNo, std::vector<CaptureDevice>::const_iterator& device, std::vector<CaptureFormat>::const_iterator& format);
 
+    std::pair<uint64_t, uint64_t> TargetBytes(); // intermediate targets one per pass, aliased
+
 private:
     volatile bool                                     m_active {false};
     winrt::com_ptr<ID3D11Device>                      m_d3dDevice {nullptr};
@@ -109,6 +120,7 @@ private:
     ShaderCache                                       m_shaderCache;
     DeviceCapture                                     m_deviceCapture;
     CursorEmulator                                    m_cursorEmulator;
+    GazeSource                                        m_gazeSource;
     HANDLE                                            m_frameEvent {nullptr};
     HINSTANCE                                         m_instance {0};
     unsigned int                                      m_lastPreset;
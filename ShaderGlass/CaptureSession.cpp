@@ -119,6 +119,7 @@ void CaptureSession::OnFrameArrived(winrt::Direct3D11CaptureFramePool const& sen
         m_contentSize.Width  = contentSize.Width;
         m_contentSize.Height = contentSize.Height;
         m_framePool.Recreate(m_device, m_pixelFormat, 2, m_contentSize);
+        m_shaderGlass.InvalidateInputViews();
     }
 
     SetEvent(m_frameEvent);
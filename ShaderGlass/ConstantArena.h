@@ -0,0 +1,164 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+// bytes of a uniform buffer written since it was last uploaded
+struct DirtyRange
+{
+    size_t begin {0};
+    size_t end {0};
+
+    void Mark(size_t offset, size_t size)
+    {
+        if(Empty())
+        {
+            begin = offset;
+            end   = offset + size;
+        }
+        else
+        {
+            begin = std::min<size_t>(begin, offset);
+            end   = std::max<size_t>(end, offset + size);
+        }
+    }
+
+    bool Empty() const
+    {
+        return end <= begin;
+    }
+
+    size_t Size() const
+    {
+        return Empty() ? 0 : end - begin;
+    }
+
+    void Clear()
+    {
+        begin = 0;
+        end   = 0;
+    }
+};
+
+// where a buffer's params were last uploaded in the arena, first and count in constants
+struct ArenaSlice
+{
+    uint32_t first {0};
+    uint32_t count {0};
+    uint32_t generation {0};
+};
+
+// bytes of a uniform buffer to copy and where they go, nothing if copy isn't set
+struct UniformUpload
+{
+    bool   copy {false};
+    bool   discard {false}; // the ring started over
+    size_t source {0};      // first byte of the params to copy
+    size_t target {0};      // their offset in the ring or the pass's own buffer
+    size_t size {0};
+};
+
+// a pass's own buffer updated in place: the dirty bytes widened to whole constants
+// where the driver takes partial updates, otherwise all of it
+inline UniformUpload PassBufferUpload(const DirtyRange& dirty, size_t size, bool partial)
+{
+    UniformUpload upload;
+    if(dirty.Empty())
+        return upload;
+
+    const auto bufferEnd = (size + 15) & ~size_t(15); // buffers are created in whole constants
+    upload.copy          = true;
+    upload.source        = partial ? dirty.begin & ~size_t(15) : 0;
+    upload.target        = upload.source;
+    upload.size          = (partial ? std::min((dirty.end + 15) & ~size_t(15), bufferEnd) : bufferEnd) - upload.source;
+    return upload;
+}
+
+// sub-allocates uniform uploads of all passes from one ring; once it runs out the ring
+// starts over in fresh memory (a discarding map) and the generation changes, which
+// invalidates everything allocated before
+class ConstantArena
+{
+public:
+    static constexpr size_t ALIGNMENT = 256; // offsets are bound in multiples of 16 constants
+
+    ConstantArena(size_t capacity = 0) : m_capacity {capacity}, m_offset {capacity} { }
+
+    static size_t Align(size_t size)
+    {
+        return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    }
+
+    // offset of size bytes in the ring, discard is set when it had to start over
+    size_t Allocate(size_t size, bool& discard)
+    {
+        size    = Align(size);
+        discard = m_offset + size > m_capacity;
+        if(discard)
+        {
+            m_offset = 0;
+            m_generation++;
+        }
+        const auto offset = m_offset;
+        m_offset += size;
+        m_frameBytes += size;
+        return offset;
+    }
+
+    // unchanged params stay where they were uploaded unless the ring has started over since;
+    // anything else goes whole into a new slice, the old one may be overwritten by then
+    UniformUpload Upload(const DirtyRange& dirty, size_t size, ArenaSlice& slice)
+    {
+        UniformUpload upload;
+        if(dirty.Empty() && slice.count != 0 && slice.generation == m_generation)
+            return upload;
+
+        upload.copy      = true;
+        upload.size      = size;
+        upload.target    = Allocate(size, upload.discard);
+        slice.first      = static_cast<uint32_t>(upload.target / 16);
+        slice.count      = static_cast<uint32_t>(Align(size) / 16);
+        slice.generation = m_generation;
+        return upload;
+    }
+
+    // uploads that bypass the ring still count towards the frame
+    void Count(size_t bytes)
+    {
+        m_frameBytes += bytes;
+    }
+
+    void BeginFrame()
+    {
+        m_frameBytes = 0;
+    }
+
+    size_t FrameBytes() const
+    {
+        return m_frameBytes;
+    }
+
+    size_t Capacity() const
+    {
+        return m_capacity;
+    }
+
+    uint32_t Generation() const
+    {
+        return m_generation;
+    }
+
+private:
+    size_t   m_capacity;
+    size_t   m_offset; // full until the first allocation discards
+    size_t   m_frameBytes {0};
+    uint32_t m_generation {0};
+};
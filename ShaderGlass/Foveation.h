@@ -0,0 +1,180 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+struct FoveaSettings
+{
+    float size {0};              // fovea width and height as a fraction of the output's, 0 renders all of it at full resolution
+    float peripheryScale {0.5f}; // of the output resolution, for the rest
+    float feather {0.25f};       // of the fovea's half-size, blended into the periphery
+    int   margin {8};            // texels a pass renders beyond its fovea for what the next pass samples around it
+};
+
+// in pixels, right and bottom exclusive
+struct FoveaRect
+{
+    int left {0};
+    int top {0};
+    int right {0};
+    int bottom {0};
+
+    int Width() const
+    {
+        return right - left;
+    }
+
+    int Height() const
+    {
+        return bottom - top;
+    }
+
+    uint64_t Area() const
+    {
+        return Width() > 0 && Height() > 0 ? static_cast<uint64_t>(Width()) * Height() : 0;
+    }
+
+    bool operator==(const FoveaRect&) const = default;
+};
+
+// what a frame renders at full resolution
+struct FoveaPlan
+{
+    FoveaRect              fovea;      // on the output
+    std::array<float, 4>   bounds {};  // fovea normalized, left, top, right, bottom; past the edge where it touches one
+    std::array<float, 2>   feather {}; // normalized width of the blend band across and down
+    std::vector<FoveaRect> scissors;   // of every pass, on its output
+};
+
+// gaze-centred region a preset chain renders at full resolution while a second run of it
+// at reduced scale covers the periphery, and the weights the two are composited with
+class Foveation
+{
+public:
+    // output size the periphery is planned for
+    static std::pair<uint32_t, uint32_t> PeripherySize(uint32_t width, uint32_t height, const FoveaSettings& settings)
+    {
+        const auto scale = std::clamp(settings.peripheryScale, 0.0f, 1.0f);
+        return {std::max<uint32_t>(1, static_cast<uint32_t>(width * scale)), std::max<uint32_t>(1, static_cast<uint32_t>(height * scale))};
+    }
+
+    // size x size of the output centred on the gaze, shifted to stay within it
+    static FoveaRect Fovea(uint32_t width, uint32_t height, float gazeX, float gazeY, float size)
+    {
+        size              = std::clamp(size, 0.0f, 1.0f);
+        const auto w      = static_cast<int>(std::ceil(width * size));
+        const auto h      = static_cast<int>(std::ceil(height * size));
+        const auto left   = std::clamp(static_cast<int>(std::lround(gazeX * width - w / 2.0f)), 0, static_cast<int>(width) - w);
+        const auto top    = std::clamp(static_cast<int>(std::lround(gazeY * height - h / 2.0f)), 0, static_cast<int>(height) - h);
+        return {left, top, left + w, top + h};
+    }
+
+    // passSizes as planned by RenderGraph (source width, height, output width, height), the last
+    // pass rendering to an output of width x height
+    static FoveaPlan Plan(const std::vector<std::array<uint32_t, 4>>& passSizes, uint32_t width, uint32_t height, float gazeX, float gazeY, const FoveaSettings& settings)
+    {
+        FoveaPlan plan;
+        plan.fovea = Fovea(width, height, gazeX, gazeY, settings.size);
+        if(width == 0 || height == 0)
+            return plan;
+
+        const auto& f = plan.fovea;
+        plan.bounds   = {f.left > 0 ? f.left / (float)width : -1.0f,
+                         f.top > 0 ? f.top / (float)height : -1.0f,
+                         f.right < (int)width ? f.right / (float)width : 2.0f,
+                         f.bottom < (int)height ? f.bottom / (float)height : 2.0f};
+        plan.feather  = {std::clamp(settings.feather, 0.0f, 1.0f) * f.Width() / 2.0f / width, std::clamp(settings.feather, 0.0f, 1.0f) * f.Height() / 2.0f / height};
+
+        plan.scissors = Scissors(passSizes, {f.left / (float)width, f.top / (float)height, f.right / (float)width, f.bottom / (float)height}, settings.margin);
+        return plan;
+    }
+
+    // what every pass renders of its output for the last one to cover region (normalized left,
+    // top, right, bottom), growing back through the chain by margin texels of each pass's source
+    static std::vector<FoveaRect> Scissors(const std::vector<std::array<uint32_t, 4>>& passSizes, std::array<float, 4> region, int margin)
+    {
+        std::vector<FoveaRect> scissors(passSizes.size());
+        for(auto p = (int)passSizes.size() - 1; p >= 0; p--)
+        {
+            const auto& size = passSizes[p];
+            auto&       rect = scissors[p];
+            rect.left        = std::max<int>(0, static_cast<int>(std::floor(region[0] * size[2])));
+            rect.top         = std::max<int>(0, static_cast<int>(std::floor(region[1] * size[3])));
+            rect.right       = std::min<int>(static_cast<int>(size[2]), static_cast<int>(std::ceil(region[2] * size[2])));
+            rect.bottom      = std::min<int>(static_cast<int>(size[3]), static_cast<int>(std::ceil(region[3] * size[3])));
+
+            // reach of this pass into its source
+            const auto mx = size[0] ? margin / (float)size[0] : 0.0f;
+            const auto my = size[1] ? margin / (float)size[1] : 0.0f;
+            region        = {std::max<float>(0.0f, region[0] - mx), std::max<float>(0.0f, region[1] - my), std::min<float>(1.0f, region[2] + mx), std::min<float>(1.0f, region[3] + my)};
+        }
+        return scissors;
+    }
+
+    // share of the full resolution render at normalized x, y; 1 inside the fovea but its
+    // feathered border, easing to 0 at its edge (the composite pass does the same)
+    static float Weight(const FoveaPlan& plan, float x, float y)
+    {
+        const auto dx = std::min<float>(x - plan.bounds[0], plan.bounds[2] - x);
+        const auto dy = std::min<float>(y - plan.bounds[1], plan.bounds[3] - y);
+        return Ease(dx, plan.feather[0]) * Ease(dy, plan.feather[1]);
+    }
+
+    // pixels shaded by passes rendering whole outputs
+    static uint64_t Pixels(const std::vector<std::array<uint32_t, 4>>& passSizes)
+    {
+        uint64_t pixels = 0;
+        for(const auto& size : passSizes)
+            pixels += static_cast<uint64_t>(size[2]) * size[3];
+        return pixels;
+    }
+
+    // pixels shaded by passes rendering within scissors
+    static uint64_t Pixels(const std::vector<FoveaRect>& scissors)
+    {
+        uint64_t pixels = 0;
+        for(const auto& rect : scissors)
+            pixels += rect.Area();
+        return pixels;
+    }
+
+    // pixels a foveated frame shades, the scissored chain, the periphery chain and the composite,
+    // against the chain at full resolution; with the fovea centred, where its scissors are largest
+    static double Share(const std::vector<std::array<uint32_t, 4>>& passSizes, const std::vector<std::array<uint32_t, 4>>& peripherySizes, uint32_t width, uint32_t height, const FoveaSettings& settings)
+    {
+        const auto full = Pixels(passSizes);
+        if(full == 0)
+            return 1.0;
+        const auto plan = Plan(passSizes, width, height, 0.5f, 0.5f, settings);
+        return (Pixels(plan.scissors) + Pixels(peripherySizes) + static_cast<uint64_t>(width) * height) / static_cast<double>(full);
+    }
+
+    // foveation starts once it shades clearly fewer pixels and stops once it hardly does,
+    // so a share near the threshold doesn't switch it back and forth while resizing
+    static bool Pays(double share, bool foveated)
+    {
+        return share < (foveated ? 0.9 : 0.8);
+    }
+
+private:
+    static float Ease(float distance, float band)
+    {
+        if(distance <= 0)
+            return 0;
+        if(distance >= band)
+            return 1;
+        const auto t = distance / band;
+        return t * t * (3 - 2 * t);
+    }
+};
@@ -0,0 +1,219 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+#include "GazeRing.h"
+
+enum class GazeFilterType
+{
+    None,
+    OneEuro,
+    Kalman
+};
+
+struct GazeFilterSettings
+{
+    GazeFilterType type {GazeFilterType::OneEuro};
+    float          minCutoff {1.0f};           // One Euro, Hz at rest, lower removes more jitter during fixations
+    float          beta {50.0f};               // One Euro, Hz added per screen/s of speed, higher lags less in saccades
+    float          derivativeCutoff {2.0f};    // One Euro, Hz for the speed estimate
+    float          acceleration {5.0f};        // Kalman, std dev of unmodelled acceleration in screens/s^2
+    float          noise {0.008f};             // Kalman, std dev of sample error in screens
+    bool           predict {true};             // extrapolate to when the frame is on screen
+    float          maxPrediction {0.05f};      // s, never further than this past the last sample
+    float          minPredictionSpeed {0.15f}; // screens/s, slower is fixation drift and noise
+    float          maxPredictionSpeed {1.0f};  // screens/s, faster is a saccade whose landing can't be extrapolated
+    float          saccadeSettle {0.15f};      // s after a saccade before predicting again, while the speed estimate decays
+    float          maxGap {0.25f};             // s, start over after a longer silence (tracking lost)
+};
+
+// low-pass filter whose cutoff rises with speed, steady during fixations and quick to
+// follow a saccade (Casiez et al., 1 Euro Filter)
+class OneEuroAxis
+{
+public:
+    void Reset(float x)
+    {
+        m_x  = x;
+        m_dx = 0;
+    }
+
+    void Update(float x, float dt, const GazeFilterSettings& settings)
+    {
+        m_dx += Alpha(settings.derivativeCutoff, dt) * ((x - m_x) / dt - m_dx);
+        m_x += Alpha(settings.minCutoff + settings.beta * std::abs(m_dx), dt) * (x - m_x);
+    }
+
+    float Position() const
+    {
+        return m_x;
+    }
+
+    float Velocity() const
+    {
+        return m_dx;
+    }
+
+private:
+    static float Alpha(float cutoff, float dt)
+    {
+        const auto tau = 1.0f / (2.0f * 3.14159265f * cutoff);
+        return 1.0f / (1.0f + tau / dt);
+    }
+
+    float m_x {0.5f};
+    float m_dx {0};
+};
+
+// constant velocity Kalman filter, position and velocity driven by random acceleration
+class KalmanAxis
+{
+public:
+    void Reset(float x, const GazeFilterSettings& settings)
+    {
+        m_x   = x;
+        m_v   = 0;
+        m_p00 = settings.noise * settings.noise;
+        m_p01 = 0;
+        m_p11 = 1.0f; // velocity unknown, up to a screen per second
+    }
+
+    void Update(float x, float dt, const GazeFilterSettings& settings)
+    {
+        // predict
+        const auto q = settings.acceleration * settings.acceleration;
+        m_x += m_v * dt;
+        m_p00 += dt * (2 * m_p01 + dt * m_p11) + q * dt * dt * dt * dt / 4;
+        m_p01 += dt * m_p11 + q * dt * dt * dt / 2;
+        m_p11 += q * dt * dt;
+
+        // correct with the sample
+        const auto s  = m_p00 + settings.noise * settings.noise;
+        const auto k0 = m_p00 / s;
+        const auto k1 = m_p01 / s;
+        const auto y  = x - m_x;
+        m_x += k0 * y;
+        m_v += k1 * y;
+        m_p11 -= k1 * m_p01;
+        m_p01 -= k1 * m_p00;
+        m_p00 -= k0 * m_p00;
+    }
+
+    float Position() const
+    {
+        return m_x;
+    }
+
+    float Velocity() const
+    {
+        return m_v;
+    }
+
+private:
+    float m_x {0.5f};
+    float m_v {0};
+    float m_p00 {0};
+    float m_p01 {0};
+    float m_p11 {0};
+};
+
+// smooths gaze samples as they come, with intervals taken from their timestamps, and
+// extrapolates the result to the time the frame being rendered reaches the screen
+class GazeFilter
+{
+public:
+    GazeFilter(const GazeFilterSettings& settings = {}) : m_settings {settings} { }
+
+    void Update(const GazeSample& sample)
+    {
+        const auto dt = (sample.timestamp - m_last.timestamp) / 1000000.0f;
+        if(!m_started || dt > m_settings.maxGap || dt < -m_settings.maxGap)
+        {
+            m_started = true;
+            for(int a = 0; a < 2; a++)
+            {
+                m_euro[a].Reset(Axis(sample, a));
+                m_kalman[a].Reset(Axis(sample, a), m_settings);
+            }
+        }
+        else if(dt > 0)
+        {
+            for(int a = 0; a < 2; a++)
+            {
+                if(m_settings.type == GazeFilterType::Kalman)
+                    m_kalman[a].Update(Axis(sample, a), dt, m_settings);
+                else
+                    m_euro[a].Update(Axis(sample, a), dt, m_settings);
+            }
+        }
+        else
+        {
+            return; // same or older timestamp
+        }
+        m_last = sample;
+        if(std::hypot(Velocity(0), Velocity(1)) > m_settings.maxPredictionSpeed)
+            m_saccade = sample.timestamp;
+    }
+
+    // filtered gaze at time, on the clock of the samples
+    GazeSample Predict(int64_t time) const
+    {
+        if(!m_started || m_settings.type == GazeFilterType::None)
+            return m_last;
+
+        // only smooth pursuit carries on
+        const auto speed   = std::hypot(Velocity(0), Velocity(1));
+        const auto settled = (m_last.timestamp - m_saccade) / 1000000.0f > m_settings.saccadeSettle;
+        auto       ahead   = m_settings.predict ? (time - m_last.timestamp) / 1000000.0f : 0.0f;
+        ahead              = std::clamp(ahead, 0.0f, m_settings.maxPrediction);
+        if(speed < m_settings.minPredictionSpeed || !settled)
+            ahead = 0;
+
+        GazeSample predicted;
+        predicted.timestamp = m_last.timestamp + static_cast<int64_t>(ahead * 1000000);
+        predicted.x         = std::clamp(Position(0) + Velocity(0) * ahead, 0.0f, 1.0f);
+        predicted.y         = std::clamp(Position(1) + Velocity(1) * ahead, 0.0f, 1.0f);
+        return predicted;
+    }
+
+    const GazeFilterSettings& Settings() const
+    {
+        return m_settings;
+    }
+
+    bool Started() const
+    {
+        return m_started;
+    }
+
+private:
+    static float Axis(const GazeSample& sample, int axis)
+    {
+        return axis ? sample.y : sample.x;
+    }
+
+    float Position(int axis) const
+    {
+        return m_settings.type == GazeFilterType::Kalman ? m_kalman[axis].Position() : m_euro[axis].Position();
+    }
+
+    float Velocity(int axis) const
+    {
+        return m_settings.type == GazeFilterType::Kalman ? m_kalman[axis].Velocity() : m_euro[axis].Velocity();
+    }
+
+    GazeFilterSettings m_settings;
+    OneEuroAxis        m_euro[2];
+    KalmanAxis         m_kalman[2];
+    GazeSample         m_last;
+    int64_t            m_saccade {0}; // last sample moving too fast to extrapolate
+    bool               m_started {false};
+};
@@ -0,0 +1,144 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// one gaze estimate, x and y normalized to the screen (0, 0 top-left), timestamp in
+// microseconds of the steady clock, which is QueryPerformanceCounter on Windows
+struct GazeSample
+{
+    int64_t timestamp {0};
+    float   x {0.5f};
+    float   y {0.5f};
+
+    static int64_t Now()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+// latest gaze samples of a single producer, laid out to live in memory shared between
+// processes; every slot carries its own sequence number so the reader never waits on the
+// writer, it retries or skips a slot that was overwritten while being read; writers don't
+// coordinate, two of them writing the same ring lose samples
+struct GazeRing
+{
+    static constexpr uint32_t MAGIC    = 0x455A4147; // "GAZE"
+    static constexpr uint32_t CAPACITY = 64;
+
+    struct Slot
+    {
+        std::atomic<uint64_t> sequence; // 2n + 1 while sample n is written, 2n + 2 once complete
+        std::atomic<int64_t>  timestamp;
+        std::atomic<float>    x;
+        std::atomic<float>    y;
+    };
+
+    uint32_t              magic;
+    uint32_t              capacity;
+    std::atomic<uint64_t> written; // samples ever written
+    Slot                  slots[CAPACITY];
+
+    // memory may come zeroed from the system but not necessarily formatted
+    void Initialize()
+    {
+        for(auto& slot : slots)
+            slot.sequence.store(0, std::memory_order_relaxed);
+        written.store(0, std::memory_order_relaxed);
+        capacity = CAPACITY;
+        std::atomic_thread_fence(std::memory_order_release);
+        magic = MAGIC;
+    }
+
+    void Write(const GazeSample& sample)
+    {
+        const auto n    = written.load(std::memory_order_relaxed);
+        auto&      slot = slots[n % CAPACITY];
+        slot.sequence.store(2 * n + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        slot.timestamp.store(sample.timestamp, std::memory_order_relaxed);
+        slot.x.store(sample.x, std::memory_order_relaxed);
+        slot.y.store(sample.y, std::memory_order_relaxed);
+        slot.sequence.store(2 * n + 2, std::memory_order_release);
+        written.store(n + 1, std::memory_order_release);
+    }
+
+    // sample n if it's still held and wasn't overwritten while reading
+    bool Read(uint64_t n, GazeSample& sample) const
+    {
+        const auto& slot   = slots[n % CAPACITY];
+        const auto  before = slot.sequence.load(std::memory_order_acquire);
+        if(before != 2 * n + 2)
+            return false;
+        sample.timestamp = slot.timestamp.load(std::memory_order_relaxed);
+        sample.x         = slot.x.load(std::memory_order_relaxed);
+        sample.y         = slot.y.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return slot.sequence.load(std::memory_order_relaxed) == before;
+    }
+};
+
+static_assert(sizeof(GazeRing::Slot) == 24, "layout shared with external producers");
+static_assert(sizeof(GazeRing) == 16 + 24 * GazeRing::CAPACITY, "layout shared with external producers");
+
+// consumer side of a GazeRing, hands out every sample once and in order; once more than
+// the ring behind it skips to the oldest sample still held; samples with NaN or infinite
+// coordinates, which some trackers send for lost eyes, are dropped
+class GazeReader
+{
+public:
+    // appends samples written since the last call, returns how many
+    size_t Read(const GazeRing& ring, std::vector<GazeSample>& samples)
+    {
+        const auto written = ring.written.load(std::memory_order_acquire);
+        if(written < m_next)
+            m_next = 0; // producer started over
+        const auto oldest  = written > GazeRing::CAPACITY ? written - GazeRing::CAPACITY : 0;
+        const auto count   = samples.size();
+        GazeSample sample;
+        for(auto n = std::max<uint64_t>(m_next, oldest); n < written; n++)
+        {
+            if(ring.Read(n, sample) && std::isfinite(sample.x) && std::isfinite(sample.y))
+                samples.push_back(sample);
+        }
+        m_next = written;
+        return samples.size() - count;
+    }
+
+    void Reset()
+    {
+        m_next = 0;
+    }
+
+private:
+    uint64_t m_next {0};
+};
+
+// shader parameters that follow the gaze, looked up by name in every pass
+struct GazeBinding
+{
+    std::string xParam {"CenterX"};
+    std::string yParam {"CenterY"};
+
+    // gaze on a screen of screenWidth x screenHeight as position within a window on it,
+    // all in screen pixels; gaze outside the window sticks to its edge
+    static std::pair<float, float> ToWindow(const GazeSample& sample, float screenWidth, float screenHeight, float left, float top, float width, float height)
+    {
+        const auto x = width > 0 ? (sample.x * screenWidth - left) / width : 0.5f;
+        const auto y = height > 0 ? (sample.y * screenHeight - top) / height : 0.5f;
+        return {std::clamp(x, 0.0f, 1.0f), std::clamp(y, 0.0f, 1.0f)};
+    }
+};
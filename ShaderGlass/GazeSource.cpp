@@ -0,0 +1,137 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "pch.h"
+
+#include <winsock2.h>
+#include <ws2tcpip.h>
+
+#include "GazeSource.h"
+
+#pragma comment(lib, "ws2_32.lib")
+
+GazeSource::~GazeSource()
+{
+    Stop();
+}
+
+bool GazeSource::Start(int port)
+{
+    Stop();
+
+    m_mapping = CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, sizeof(GazeRing), GAZE_SHARED_MEMORY);
+    if(!m_mapping)
+        return false;
+    const auto existing = GetLastError() == ERROR_ALREADY_EXISTS;
+    m_ring              = static_cast<GazeRing*>(MapViewOfFile(m_mapping, FILE_MAP_ALL_ACCESS, 0, 0, sizeof(GazeRing)));
+    if(!m_ring)
+    {
+        Stop();
+        return false;
+    }
+    if(!existing || m_ring->magic != GazeRing::MAGIC || m_ring->capacity != GazeRing::CAPACITY)
+    {
+        // producer may have opened it first but never formats it
+        m_ring->Initialize();
+    }
+    m_reader.Reset();
+    m_udpRing.Initialize();
+    m_udpReader.Reset();
+
+    WSADATA wsaData;
+    if(port > 0 && WSAStartup(MAKEWORD(2, 2), &wsaData) == 0)
+    {
+        auto udp = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+        if(udp != INVALID_SOCKET)
+        {
+            sockaddr_in address {};
+            address.sin_family = AF_INET;
+            address.sin_port   = htons(static_cast<u_short>(port));
+            inet_pton(AF_INET, "127.0.0.1", &address.sin_addr);
+
+            // wake up to check m_running every so often
+            DWORD timeout = 100;
+            setsockopt(udp, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+            if(bind(udp, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0)
+            {
+                m_socket  = udp;
+                m_running = true;
+                m_thread  = std::thread(&GazeSource::ReceiveThread, this);
+            }
+            else
+            {
+                closesocket(udp);
+            }
+        }
+        if(!m_running)
+            WSACleanup();
+    }
+    return true;
+}
+
+void GazeSource::Stop()
+{
+    if(m_running)
+    {
+        m_running = false;
+        m_thread.join();
+        closesocket(m_socket);
+        m_socket = INVALID_SOCKET;
+        WSACleanup();
+    }
+    if(m_ring)
+    {
+        UnmapViewOfFile(m_ring);
+        m_ring = nullptr;
+    }
+    if(m_mapping)
+    {
+        CloseHandle(m_mapping);
+        m_mapping = nullptr;
+    }
+}
+
+bool GazeSource::Active() const
+{
+    return m_ring;
+}
+
+size_t GazeSource::Read(std::vector<GazeSample>& samples)
+{
+    if(!m_ring)
+        return 0;
+    const auto count  = samples.size();
+    const auto shared = m_reader.Read(*m_ring, samples);
+    const auto udp    = m_udpReader.Read(m_udpRing, samples);
+    if(shared && udp)
+    {
+        // both producers active, keep the samples in time order
+        std::inplace_merge(samples.begin() + count, samples.begin() + count + shared, samples.end(), [](const GazeSample& a, const GazeSample& b) {
+            return a.timestamp < b.timestamp;
+        });
+    }
+    return shared + udp;
+}
+
+void GazeSource::ReceiveThread()
+{
+    while(m_running)
+    {
+        char datagram[64];
+        auto received = recv(m_socket, datagram, sizeof(datagram), 0);
+        if(received != 16)
+            continue; // timeout or not a sample
+
+        GazeSample sample;
+        memcpy(&sample.timestamp, datagram, 8);
+        memcpy(&sample.x, datagram + 8, 4);
+        memcpy(&sample.y, datagram + 12, 4);
+        if(sample.timestamp == 0)
+            sample.timestamp = GazeSample::Now();
+        m_udpRing.Write(sample);
+    }
+}
@@ -0,0 +1,46 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <thread>
+
+#include "GazeRing.h"
+
+#define GAZE_SHARED_MEMORY L"Local\\ShaderGlassGaze"
+#define GAZE_DEFAULT_PORT 5555
+
+// gaze samples from an eye tracker running as another process, which either writes them
+// into the GazeRing shared as GAZE_SHARED_MEMORY or sends them to a localhost UDP port as
+// 16-byte datagrams laid out like GazeSample (little-endian int64 timestamp, float x, float y,
+// a zero timestamp is stamped on arrival); UDP samples go through a ring of their own, so
+// they can arrive alongside those of a producer writing the shared one
+class GazeSource
+{
+public:
+    GazeSource() = default;
+    ~GazeSource();
+
+    bool Start(int port);
+    void Stop();
+    bool Active() const;
+
+    // samples received since the last call, oldest first
+    size_t Read(std::vector<GazeSample>& samples);
+
+private:
+    void ReceiveThread();
+
+    HANDLE        m_mapping {nullptr};
+    GazeRing*     m_ring {nullptr};
+    GazeReader    m_reader;
+    GazeRing      m_udpRing {}; // written only by ReceiveThread
+    GazeReader    m_udpReader;
+    uintptr_t     m_socket {~(uintptr_t)0};
+    std::thread   m_thread;
+    volatile bool m_running {false};
+};
@@ -0,0 +1,41 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+// OriginalHistory as a fixed ring of frames: the preprocess pass renders into
+// the current slot and older frames are addressed by age, so nothing is copied
+class HistoryRing
+{
+public:
+    HistoryRing(int depth = 0) : m_size {depth + 1} { }
+
+    int Size() const
+    {
+        return m_size;
+    }
+
+    int Current() const
+    {
+        return m_current;
+    }
+
+    // slot holding the frame rendered age frames ago, 0 being the current one
+    int Frame(int age) const
+    {
+        return (m_current + m_size - age % m_size) % m_size;
+    }
+
+    void Advance()
+    {
+        m_current = (m_current + 1) % m_size;
+    }
+
+private:
+    int m_size;
+    int m_current {0};
+};
@@ -0,0 +1,56 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "ParamSlots.h"
+
+#include <cctype>
+
+ParamSlots::ParamSlots(const std::vector<ShaderParam>& params)
+{
+    std::vector<const std::string*> names; // in declaration order, so slots don't depend on hashing
+    for(int i = 0; i < params.size(); i++)
+    {
+        const auto& p    = params[i];
+        auto&       slot = m_slots[p.name];
+        if(slot.push < 0 && slot.ubo < 0)
+            names.push_back(&p.name);
+        if(p.buffer == PUSH_BUFFER)
+            slot.push = i;
+        else
+            slot.ubo = i;
+
+        if(p.size == 4 && p.name != "FrameCount")
+            m_userParams.push_back(i);
+    }
+
+    m_frameCount = Find("FrameCount");
+    m_mvp        = Find("MVP");
+    m_sourceSize = Find("SourceSize");
+    m_outputSize = Find("OutputSize");
+
+    for(const auto* name : names)
+    {
+        const auto& slot = m_slots[*name];
+        if(name->starts_with("PassOutputSize") && name->size() > 14 && isdigit(name->at(14)))
+        {
+            auto pass = static_cast<size_t>(atoi(name->c_str() + 14));
+            if(pass >= m_passOutputSizes.size())
+                m_passOutputSizes.resize(pass + 1);
+            m_passOutputSizes[pass] = slot;
+        }
+        else if(name->size() > 4 && name->ends_with("Size"))
+        {
+            m_textureSizes.emplace_back(name->substr(0, name->size() - 4), slot);
+        }
+    }
+}
+
+ParamSlot ParamSlots::Find(const std::string& name) const
+{
+    auto it = m_slots.find(name);
+    return it != m_slots.end() ? it->second : ParamSlot {};
+}
@@ -0,0 +1,81 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <unordered_map>
+
+#include "ShaderDef.h"
+
+constexpr auto PUSH_BUFFER = -1;
+constexpr auto UBO_BUFFER  = 0;
+
+// indices into ShaderDef::Params holding one uniform, which can live in both buffers
+struct ParamSlot
+{
+    int push {-1};
+    int ubo {-1};
+};
+
+// a shader's uniforms resolved by name once, so per-frame and per-resize updates
+// and UI param changes write through integer slots without name lookups
+class ParamSlots
+{
+public:
+    ParamSlots() = default;
+    ParamSlots(const std::vector<ShaderParam>& params);
+
+    ParamSlot Find(const std::string& name) const;
+
+    const ParamSlot& FrameCount() const
+    {
+        return m_frameCount;
+    }
+
+    const ParamSlot& MVP() const
+    {
+        return m_mvp;
+    }
+
+    const ParamSlot& SourceSize() const
+    {
+        return m_sourceSize;
+    }
+
+    const ParamSlot& OutputSize() const
+    {
+        return m_outputSize;
+    }
+
+    // <name>Size by texture name
+    const std::vector<std::pair<std::string, ParamSlot>>& TextureSizes() const
+    {
+        return m_textureSizes;
+    }
+
+    // PassOutputSize<n> by pass
+    const std::vector<ParamSlot>& PassOutputSizes() const
+    {
+        return m_passOutputSizes;
+    }
+
+    // float params other than FrameCount are user-adjustable
+    const std::vector<int>& UserParams() const
+    {
+        return m_userParams;
+    }
+
+private:
+    std::unordered_map<std::string, ParamSlot>     m_slots;
+    ParamSlot                                      m_frameCount {};
+    ParamSlot                                      m_mvp {};
+    ParamSlot                                      m_sourceSize {};
+    ParamSlot                                      m_outputSize {};
+    std::vector<std::pair<std::string, ParamSlot>> m_textureSizes;
+    std::vector<ParamSlot>                         m_passOutputSizes;
+    std::vector<int>                               m_userParams;
+};
@@ -9,6 +9,8 @@ GNU General Public License v3.0
 
 #include "Preset.h"
 
+#include <future>
+
 Preset::Preset(PresetDef& presetDef) : m_presetDef(presetDef), m_shaders {}
 {
     if(presetDef.ShaderDefs.empty())
@@ -26,13 +28,25 @@ void Preset::Create(winrt::com_ptr<ID3D11Device> d3dDevice)
     {
         m_textures.emplace(td.PresetParams["name"], td);
     }
+
+    // decode textures on worker threads while shaders are being created
+    std::vector<std::pair<const uint8_t*, size_t>> textureData;
+    for(const auto& t : m_textures)
+    {
+        textureData.emplace_back(t.second.m_textureDef.Data, (size_t)t.second.m_textureDef.DataLength);
+    }
+    auto decoded = std::async(std::launch::async, [&textureData]() { return Texture::Cache().Decode(textureData); });
+
     for(auto& s : m_shaders)
     {
         s.Create(d3dDevice);
     }
+
+    const auto& images = decoded.get();
+    size_t      i      = 0;
     for(auto& t : m_textures)
     {
-        t.second.Create(d3dDevice);
+        t.second.Create(d3dDevice, images[i++].get());
     }
 }
 
@@ -0,0 +1,421 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static bool IsTrue(const ShaderDef& shaderDef, const char* presetParam)
+{
+    auto it = shaderDef.PresetParams.find(presetParam);
+    return it != shaderDef.PresetParams.end() && (it->second == "true" || it->second == "1");
+}
+
+static bool Get(const ShaderDef& shaderDef, const char* presetParam, std::string& value)
+{
+    auto it = shaderDef.PresetParams.find(presetParam);
+    if(it != shaderDef.PresetParams.end())
+    {
+        value = it->second;
+        return true;
+    }
+    return false;
+}
+
+static TextureSize SizeOf(uint32_t width, uint32_t height)
+{
+    return {(float)width, (float)height, 1.0f / width, 1.0f / height};
+}
+
+PassScale::PassScale(const ShaderDef& shaderDef)
+{
+    std::string value;
+
+    if(Get(shaderDef, "scale_x", value))
+        x = stof(value);
+    if(Get(shaderDef, "scale_y", value))
+        y = stof(value);
+    if(Get(shaderDef, "scale", value))
+    {
+        x = stof(value);
+        y = x;
+    }
+
+    if(Get(shaderDef, "scale_type_x", value))
+    {
+        if(value == "viewport")
+            viewportX = true;
+        else if(value == "absolute")
+            absoluteX = true;
+    }
+    if(Get(shaderDef, "scale_type_y", value))
+    {
+        if(value == "viewport")
+            viewportY = true;
+        else if(value == "absolute")
+            absoluteY = true;
+    }
+    if(Get(shaderDef, "scale_type", value))
+    {
+        if(value == "viewport")
+        {
+            viewportX = true;
+            viewportY = true;
+        }
+        else if(value == "absolute")
+        {
+            absoluteX = true;
+            absoluteY = true;
+        }
+    }
+}
+
+Viewport FitViewport(long clientWidth, long clientHeight, long captureWidth, long captureHeight, float outputScaleW, float outputScaleH, bool freeScale)
+{
+    Viewport viewport {clientWidth, clientHeight, 0, 0};
+
+    if(!freeScale)
+    {
+        viewport.width  = (long)roundf(captureWidth / outputScaleW);
+        viewport.height = (long)roundf(captureHeight / outputScaleH);
+    }
+
+    // box if needed
+    if(captureWidth != 0 && captureHeight != 0)
+    {
+        auto inputAspectRatio  = captureWidth / (float)captureHeight;
+        auto outputAspectRatio = (viewport.width * outputScaleW) / (viewport.height * outputScaleH);
+        if(outputAspectRatio > inputAspectRatio)
+        {
+            // output is wider
+            auto newWidth  = (long)roundf(viewport.height * (outputScaleH / outputScaleW) * inputAspectRatio);
+            viewport.boxX  = (viewport.width - newWidth) / 2.0f;
+            viewport.width = newWidth;
+        }
+        else if(outputAspectRatio < inputAspectRatio)
+        {
+            // output is narrower
+            auto newHeight  = (long)roundf(viewport.width * (outputScaleW / outputScaleH) / inputAspectRatio);
+            viewport.boxY   = (viewport.height - newHeight) / 2.0f;
+            viewport.height = newHeight;
+        }
+
+        // center (fullscreen?)
+        if(!freeScale)
+        {
+            viewport.boxX += (clientWidth - (captureWidth / outputScaleW)) / 2.0f;
+            viewport.boxY += (clientHeight - (captureHeight / outputScaleH)) / 2.0f;
+        }
+
+        if(viewport.boxX < 0)
+            viewport.boxX = 0;
+        if(viewport.boxY < 0)
+            viewport.boxY = 0;
+    }
+
+    return viewport;
+}
+
+std::string RenderGraph::FormatName(const ShaderDef& shaderDef)
+{
+    if(shaderDef.Format != NULL && strlen(shaderDef.Format) > 0)
+        return shaderDef.Format;
+    if(IsTrue(shaderDef, "float_framebuffer"))
+        return "R16G16B16A16_SFLOAT";
+    if(IsTrue(shaderDef, "srgb_framebuffer"))
+        return "R8G8B8A8_SRGB";
+    return "R8G8B8A8_UNORM";
+}
+
+bool RenderGraph::IsPassthrough(const ShaderDef& shaderDef)
+{
+    // stock.slang, built-in or imported
+    return shaderDef.Name == "stock" || shaderDef.Name == "stock.slang";
+}
+
+uint32_t RenderGraph::BytesPerPixel(const std::string& format)
+{
+    // sum of component bits, e.g. R16G16B16A16_SFLOAT or A2B10G10R10_UNORM_PACK32
+    uint32_t bits      = 0;
+    uint32_t component = 0;
+    for(auto c : format)
+    {
+        if(c == '_')
+            break;
+        if(c >= '0' && c <= '9')
+        {
+            component = component * 10 + (c - '0');
+        }
+        else
+        {
+            bits += component;
+            component = 0;
+        }
+    }
+    bits += component;
+    return bits ? (bits + 7) / 8 : 4;
+}
+
+RenderGraph::RenderGraph(const std::vector<const ShaderDef*>& passes, const std::vector<std::string>& textures) : m_slots(passes, textures)
+{
+    for(const auto* pass : passes)
+    {
+        std::string alias;
+        Get(*pass, "alias", alias);
+        m_aliases.push_back(alias);
+        m_scales.emplace_back(*pass);
+        m_formats.push_back(FormatName(*pass));
+        m_passthrough.push_back(IsPassthrough(*pass));
+    }
+
+    // each pass is read by the next one as Source, later passes may sample it directly;
+    // the last pass renders to the display so nothing reads it
+    const auto passCount = (int)passes.size();
+    m_lastReaders.resize(passes.size());
+    m_inputs.resize(passes.size());
+    for(int p = 0; p < passCount; p++)
+    {
+        m_lastReaders[p] = p + 1 < passCount ? p + 1 : p;
+        if(p > 0)
+            m_inputs[p].push_back(p - 1);
+    }
+    for(int q = 0; q < passCount; q++)
+    {
+        for(const auto& b : m_slots.Bind(*passes[q]))
+        {
+            for(int p = 0; p < q && p + 1 < passCount; p++)
+            {
+                if(b.slot == m_slots.PassOutput(p))
+                {
+                    m_lastReaders[p] = std::max<int>(m_lastReaders[p], q);
+                    if(std::find(m_inputs[q].begin(), m_inputs[q].end(), p) == m_inputs[q].end())
+                        m_inputs[q].push_back(p);
+                }
+            }
+        }
+    }
+
+    // e.g. bezel or lighting passes generated from LUTs and parameters alone
+    m_static.resize(passes.size(), false);
+    for(int p = 0; p + 1 < passCount; p++)
+    {
+        auto isStatic = !passes[p]->DependsOnFrame() && !m_slots.Feedback(p);
+        for(const auto& b : m_slots.Bind(*passes[p]))
+        {
+            if(b.slot == SOURCE_SLOT)
+                isStatic &= p > 0 && m_static[p - 1];
+            else if(b.slot >= m_slots.PassOutput(0) && b.slot < m_slots.PassOutput(passCount - 1))
+                isStatic &= m_static[b.slot - m_slots.PassOutput(0)];
+            else if(b.slot != NO_SLOT && b.slot < m_slots.Texture(0))
+                isStatic = false; // original, history or feedback
+        }
+        m_static[p] = isStatic;
+    }
+
+    // pass 0 sampling between its source texels, or a final pass 0 scaling to the viewport,
+    // would see the captured resolution rather than the downscaled one
+    m_inputFusable = passCount > 1 && m_slots.HistoryDepth() == 0 && !IsTrue(*passes[0], "filter_linear") && m_scales[0].x == 1.0f && m_scales[0].y == 1.0f &&
+                     !m_scales[0].viewportX && !m_scales[0].viewportY && !m_scales[0].absoluteX && !m_scales[0].absoluteY;
+    for(const auto* pass : passes)
+    {
+        for(const auto& b : m_slots.Bind(*pass))
+            m_inputFusable &= b.slot != m_slots.Original();
+    }
+}
+
+RenderPlan RenderGraph::Plan(uint32_t originalWidth, uint32_t originalHeight, uint32_t viewportWidth, uint32_t viewportHeight, bool vertical) const
+{
+    RenderPlan plan;
+
+    // everything up to the final rotation works in rotated space
+    if(vertical)
+    {
+        std::swap(originalWidth, originalHeight);
+        std::swap(viewportWidth, viewportHeight);
+    }
+    plan.originalWidth  = originalWidth;
+    plan.originalHeight = originalHeight;
+    plan.textureSizes.insert(std::make_pair("Original", SizeOf(originalWidth, originalHeight)));
+    plan.textureSizes.insert(std::make_pair("FinalViewport", SizeOf(viewportWidth, viewportHeight)));
+
+    uint32_t sourceWidth  = originalWidth;
+    uint32_t sourceHeight = originalHeight;
+    for(size_t p = 0; p < m_scales.size(); p++)
+    {
+        if(p == m_scales.size() - 1) // last shader scales source to viewport
+        {
+            if(vertical)
+                std::swap(viewportWidth, viewportHeight);
+            plan.passSizes.push_back({sourceWidth, sourceHeight, viewportWidth, viewportHeight});
+            break;
+        }
+
+        const auto& scale = m_scales[p];
+        uint32_t    outputWidth;
+        uint32_t    outputHeight;
+        if(scale.viewportX)
+            outputWidth = static_cast<uint32_t>(viewportWidth * scale.x);
+        else if(scale.absoluteX)
+            outputWidth = static_cast<uint32_t>(scale.x);
+        else
+            outputWidth = static_cast<uint32_t>(sourceWidth * scale.x);
+        if(scale.viewportY)
+            outputHeight = static_cast<uint32_t>(viewportHeight * scale.y);
+        else if(scale.absoluteY)
+            outputHeight = static_cast<uint32_t>(scale.y);
+        else
+            outputHeight = static_cast<uint32_t>(sourceHeight * scale.y);
+        plan.passSizes.push_back({sourceWidth, sourceHeight, outputWidth, outputHeight});
+        if(!m_aliases[p].empty())
+        {
+            plan.textureSizes.insert(std::make_pair(m_aliases[p], SizeOf(outputWidth, outputHeight)));
+        }
+        sourceWidth  = outputWidth;
+        sourceHeight = outputHeight;
+    }
+
+    ElidePasses(plan, vertical);
+    AssignTargets(plan);
+    return plan;
+}
+
+void RenderGraph::ElidePasses(RenderPlan& plan, bool vertical) const
+{
+    // a passthrough pass that copies its source at the same size and format changes nothing, whatever its filter,
+    // as long as that source isn't swapped with its feedback every frame; a trailing one lets the pass before render
+    // to the display instead, unless that pass is read back as feedback, renders only once or in rotated space
+    const auto passCount = (int)plan.passSizes.size();
+    plan.elided.resize(passCount, false);
+    plan.displayPass = passCount - 1;
+    for(int p = 1; p < passCount; p++)
+    {
+        const auto& size = plan.passSizes[p];
+        if(!m_passthrough[p] || m_slots.Feedback(p) || size[0] != size[2] || size[1] != size[3])
+            continue;
+        if(p + 1 < passCount)
+            plan.elided[p] = m_formats[p] == m_formats[p - 1] && !m_slots.Feedback(p - 1);
+    }
+    for(int p = passCount - 1; p > 0 && !vertical; p--)
+    {
+        const auto& size = plan.passSizes[p];
+        if(!m_passthrough[p] || m_slots.Feedback(p) || size[0] != size[2] || size[1] != size[3])
+            break;
+
+        // nearest pass before it that still renders
+        auto source = p - 1;
+        while(source > 0 && plan.elided[source])
+            source--;
+        if(m_slots.Feedback(source) || m_static[source])
+            break;
+        plan.elided[p]   = true;
+        plan.displayPass = source;
+    }
+}
+
+void RenderGraph::AssignTargets(RenderPlan& plan) const
+{
+    // targets are shared between passes of matching size and format whose outputs are never
+    // live at the same time; feedback and static outputs persist across frames so they keep their own
+    // readers of an elided pass read its source, which has to live as long
+    std::vector<int> lastReaders(m_lastReaders);
+    std::vector<int> sources(plan.passSizes.size());
+    for(int p = 0; p < (int)plan.passSizes.size(); p++)
+    {
+        sources[p] = plan.elided[p] ? sources[p - 1] : p;
+        if(plan.elided[p])
+            lastReaders[sources[p]] = std::max<int>(lastReaders[sources[p]], lastReaders[p]);
+    }
+
+    std::vector<int> busyUntil; // last reader of each target's current output, -1 if dedicated
+    for(int p = 0; p + 1 < (int)plan.passSizes.size(); p++)
+    {
+        if(plan.elided[p] || p == plan.displayPass)
+        {
+            plan.passTargets.push_back(-1);
+            continue;
+        }
+
+        const auto& size   = plan.passSizes[p];
+        const auto  bytes  = (uint64_t)size[2] * size[3] * BytesPerPixel(m_formats[p]);
+        const auto  shared = !m_slots.Feedback(p) && !m_static[p];
+        plan.dedicatedBytes += bytes;
+
+        int target = -1;
+        for(int t = 0; shared && t < (int)plan.targets.size() && target < 0; t++)
+        {
+            const auto& candidate = plan.targets[t];
+            if(busyUntil[t] >= 0 && busyUntil[t] < p && candidate.width == size[2] && candidate.height == size[3] && candidate.format == m_formats[p])
+                target = t;
+        }
+        if(target < 0)
+        {
+            target = (int)plan.targets.size();
+            plan.targets.push_back({size[2], size[3], m_formats[p], p});
+            busyUntil.push_back(-1);
+            plan.aliasedBytes += bytes;
+        }
+        if(shared)
+            busyUntil[target] = lastReaders[p];
+        plan.passTargets.push_back(target);
+    }
+}
+
+std::vector<bool> RenderGraph::Invalidate(const RenderPlan& plan, const std::vector<bool>& changed) const
+{
+    const auto        passCount = (int)m_inputs.size();
+    std::vector<bool> render(changed);
+    render.resize(passCount, false);
+
+    // readers of an elided pass sample the output of the pass that last rendered before it
+    std::vector<int>              sources(passCount);
+    std::vector<std::vector<int>> inputs(passCount);
+    for(int p = 0; p < passCount; p++)
+    {
+        sources[p] = p < (int)plan.elided.size() && plan.elided[p] ? sources[p - 1] : p;
+        for(auto input : m_inputs[p])
+            inputs[p].push_back(sources[input]);
+    }
+
+    // target of each pass that renders to one, others never overwrite anything
+    auto targetOf = [&](int p) { return p < (int)plan.passTargets.size() && plan.passTargets[p] >= 0 ? plan.passTargets[p] : -1 - p; };
+
+    // fixed point, rendering a pass can only ever require more passes to render
+    bool updated = true;
+    while(updated)
+    {
+        updated = false;
+        for(int q = 0; q < passCount; q++)
+        {
+            if(render[q])
+                continue;
+
+            auto required = false;
+            for(auto p : inputs[q])
+                required |= render[p]; // reads a new output
+            for(int p = 0; p < q && !required; p++)
+                required = render[p] && targetOf(p) == targetOf(q); // an earlier pass on its target would overwrite it
+            for(int r = q + 1; r < passCount && !required; r++)
+            {
+                if(render[r] && std::find(inputs[r].begin(), inputs[r].end(), q) != inputs[r].end())
+                {
+                    // output is read again, but a later pass on its target has replaced it
+                    for(int m = q + 1; m < passCount && !required; m++)
+                        required = targetOf(m) == targetOf(q);
+                }
+            }
+
+            if(required)
+            {
+                render[q] = true;
+                updated   = true;
+            }
+        }
+    }
+    return render;
+}
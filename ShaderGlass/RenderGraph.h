@@ -0,0 +1,125 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "ResourceSlots.h"
+
+#include <array>
+
+using PassSize    = std::array<uint32_t, 4>; // source width, height, output width, height
+using TextureSize = std::array<float, 4>;    // width, height, 1/width, 1/height
+
+// scale_type/scale_x/scale_y of a pass
+struct PassScale
+{
+    PassScale() = default;
+    PassScale(const ShaderDef& shaderDef);
+
+    float x {1.0f};
+    float y {1.0f};
+    bool  viewportX {false};
+    bool  viewportY {false};
+    bool  absoluteX {false};
+    bool  absoluteY {false};
+};
+
+// output window area left after letterboxing the captured area
+struct Viewport
+{
+    long  width;
+    long  height;
+    float boxX;
+    float boxY;
+};
+
+Viewport FitViewport(long clientWidth, long clientHeight, long captureWidth, long captureHeight, float outputScaleW, float outputScaleH, bool freeScale);
+
+// physical texture backing one or more intermediate pass outputs
+struct RenderTarget
+{
+    uint32_t    width;
+    uint32_t    height;
+    std::string format;
+    int         firstPass;
+};
+
+// sizes of every pass for one original/viewport size, immutable once planned
+struct RenderPlan
+{
+    uint32_t                           originalWidth {0};
+    uint32_t                           originalHeight {0};
+    std::vector<PassSize>              passSizes;
+    std::map<std::string, TextureSize> textureSizes; // Original, FinalViewport and aliases
+    std::vector<RenderTarget>          targets;
+    std::vector<int>                   passTargets;        // target of each pass but the last, -1 if elided or the display pass
+    std::vector<bool>                  elided;             // passthrough copies, readers get their source instead
+    int                                displayPass {0};    // last pass that renders
+    uint64_t                           dedicatedBytes {0}; // with a target per pass
+    uint64_t                           aliasedBytes {0};
+};
+
+// pass chain of a preset independent of the graphics API: formats, scaling,
+// resource slots and how long each pass output stays in use
+class RenderGraph
+{
+public:
+    RenderGraph() = default;
+    RenderGraph(const std::vector<const ShaderDef*>& passes, const std::vector<std::string>& textures);
+
+    // original is the preprocessed input, viewport the final output size; vertical rotates everything but the last pass
+    RenderPlan Plan(uint32_t originalWidth, uint32_t originalHeight, uint32_t viewportWidth, uint32_t viewportHeight, bool vertical) const;
+
+    const ResourceSlots& Slots() const
+    {
+        return m_slots;
+    }
+
+    // pass p samples only preset textures and other static passes and doesn't depend on the frame,
+    // so its output holds until its parameters or size change; never the last pass
+    bool Static(size_t p) const
+    {
+        return m_static[p];
+    }
+
+    // nothing samples Original or its history and pass 0 point-samples its Source at scale 1, so when the
+    // preprocess pass is a plain downscale pass 0 can sample the captured texture instead
+    bool InputFusable() const
+    {
+        return m_inputFusable;
+    }
+
+    // fusable and this frame the preprocess pass maps the capture 1:1 with no cursor drawn over it,
+    // rotation or fovea, which need the preprocessed input
+    bool FuseInput(bool inputIdentity, bool cursorDrawn, bool vertical, bool foveated) const
+    {
+        return m_inputFusable && inputIdentity && !cursorDrawn && !vertical && !foveated;
+    }
+
+    // passes to render again when only those changed have new uniforms and everything else is as
+    // the last full frame of plan left it; outputs lost to a later pass sharing their target are
+    // rendered again if needed, as is any later pass on a target that gets overwritten
+    std::vector<bool> Invalidate(const RenderPlan& plan, const std::vector<bool>& changed) const;
+
+    static std::string FormatName(const ShaderDef& shaderDef);
+    static bool        IsPassthrough(const ShaderDef& shaderDef);
+    static uint32_t    BytesPerPixel(const std::string& format);
+
+private:
+    void ElidePasses(RenderPlan& plan, bool vertical) const;
+    void AssignTargets(RenderPlan& plan) const;
+
+    ResourceSlots                 m_slots;
+    std::vector<PassScale>        m_scales;
+    std::vector<std::string>      m_aliases;
+    std::vector<std::string>      m_formats;
+    std::vector<int>              m_lastReaders;
+    std::vector<std::vector<int>> m_inputs;
+    std::vector<bool>             m_static;
+    std::vector<bool>             m_passthrough;
+    bool                          m_inputFusable {false};
+};
@@ -0,0 +1,114 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "ResourceSlots.h"
+
+#include <cstring>
+
+ResourceSlots::ResourceSlots(const std::vector<const ShaderDef*>& passes, const std::vector<std::string>& textures) :
+    m_passCount {static_cast<int>(passes.size())}, m_outputCount {passes.empty() ? 0 : static_cast<int>(passes.size()) - 1}, m_textures {textures}
+{
+    for(const auto* pass : passes)
+    {
+        auto alias = pass->PresetParams.find("alias");
+        m_aliases.push_back(alias != pass->PresetParams.end() ? alias->second : std::string());
+    }
+
+    m_feedback.resize(passes.size(), false);
+    for(const auto* pass : passes)
+    {
+        for(const auto& sampler : pass->Samplers)
+        {
+            auto history = Suffix(sampler.name, "OriginalHistory");
+            if(history > m_historyDepth && history < MAX_HISTORY)
+                m_historyDepth = history;
+
+            auto feedback = FeedbackPass(sampler.name);
+            if(feedback >= 0)
+            {
+                m_feedback[feedback] = true;
+                m_requiresFeedback   = true;
+            }
+        }
+    }
+}
+
+int ResourceSlots::FeedbackPass(const std::string& name) const
+{
+    auto n = Suffix(name, "PassFeedback");
+    if(n >= 0 && n < m_passCount)
+        return n;
+    for(int p = 0; p < m_passCount; p++)
+    {
+        if(!m_aliases[p].empty() && name.size() == m_aliases[p].size() + 8 && name.starts_with(m_aliases[p]) && name.ends_with("Feedback"))
+            return p;
+    }
+    return -1;
+}
+
+int ResourceSlots::Suffix(const std::string& name, const char* prefix)
+{
+    auto length = strlen(prefix);
+    if(name.size() <= length || name.compare(0, length, prefix) != 0)
+        return -1;
+
+    int n = 0;
+    for(auto i = length; i < name.size(); i++)
+    {
+        if(name[i] < '0' || name[i] > '9' || n >= MAX_HISTORY * 10)
+            return -1;
+        n = n * 10 + (name[i] - '0');
+    }
+    return n;
+}
+
+int ResourceSlots::Resolve(const std::string& name) const
+{
+    if(name == "Source")
+        return SOURCE_SLOT;
+
+    // static textures take precedence, as they did when resources were looked up by name
+    for(int t = 0; t < m_textures.size(); t++)
+    {
+        if(m_textures[t] == name)
+            return Texture(t);
+    }
+
+    if(name == "Original")
+        return Original();
+
+    auto n = Suffix(name, "PassOutput");
+    if(n >= 0 && n < m_outputCount)
+        return PassOutput(n);
+    for(int p = 0; p < m_outputCount; p++)
+    {
+        if(!m_aliases[p].empty() && m_aliases[p] == name)
+            return PassOutput(p);
+    }
+
+    n = FeedbackPass(name);
+    if(n >= 0)
+        return PassFeedback(n);
+
+    if(name.starts_with("OriginalHistory"))
+    {
+        n = Suffix(name, "OriginalHistory");
+        if(n >= 1 && n <= m_historyDepth)
+            return History(n);
+        return Original(); // OriginalHistory0 is the current frame
+    }
+
+    return NO_SLOT;
+}
+
+std::vector<SlotBinding> ResourceSlots::Bind(const ShaderDef& shaderDef) const
+{
+    std::vector<SlotBinding> bindings;
+    for(const auto& sampler : shaderDef.Samplers)
+        bindings.push_back({sampler.binding, Resolve(sampler.name)});
+    return bindings;
+}
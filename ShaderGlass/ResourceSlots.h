@@ -0,0 +1,92 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "ShaderDef.h"
+
+constexpr auto NO_SLOT     = -1;
+constexpr auto SOURCE_SLOT = -2; // pass input, supplied per Render call
+constexpr auto MAX_HISTORY = 100;
+
+struct SlotBinding
+{
+    int binding;
+    int slot;
+};
+
+// flat table of the textures a preset's passes can sample, so samplers are
+// resolved to integer slots once per preset instead of by name every frame
+// layout: Original, OriginalHistory1..N, PassOutput0..P-2, PassFeedback0..P-1, preset textures
+class ResourceSlots
+{
+public:
+    ResourceSlots() = default;
+    ResourceSlots(const std::vector<const ShaderDef*>& passes, const std::vector<std::string>& textures);
+
+    std::vector<SlotBinding> Bind(const ShaderDef& shaderDef) const;
+    int                      Resolve(const std::string& name) const;
+
+    int Original() const
+    {
+        return 0;
+    }
+
+    // History(0) is Original
+    int History(int n) const
+    {
+        return n;
+    }
+
+    int PassOutput(int p) const
+    {
+        return 1 + m_historyDepth + p;
+    }
+
+    int PassFeedback(int p) const
+    {
+        return PassOutput(m_outputCount) + p;
+    }
+
+    int Texture(int t) const
+    {
+        return PassFeedback(m_passCount) + t;
+    }
+
+    size_t Count() const
+    {
+        return Texture(static_cast<int>(m_textures.size()));
+    }
+
+    int HistoryDepth() const
+    {
+        return m_historyDepth;
+    }
+
+    bool RequiresFeedback() const
+    {
+        return m_requiresFeedback;
+    }
+
+    // pass is sampled as PassFeedbackN or <alias>Feedback
+    bool Feedback(int p) const
+    {
+        return m_feedback[p];
+    }
+
+private:
+    static int Suffix(const std::string& name, const char* prefix);
+    int        FeedbackPass(const std::string& name) const;
+
+    int                      m_passCount {0};
+    int                      m_outputCount {0}; // last pass renders to the display
+    int                      m_historyDepth {0};
+    bool                     m_requiresFeedback {false};
+    std::vector<std::string> m_aliases;
+    std::vector<std::string> m_textures;
+    std::vector<bool>        m_feedback;
+};
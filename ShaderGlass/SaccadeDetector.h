@@ -0,0 +1,152 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <deque>
+
+#include "GazeRing.h"
+
+struct SaccadeSettings
+{
+    bool  reduce {false};      // render cheaper frames while a saccade is in flight
+    float onsetSpeed {2.0f};   // screens/s, faster starts a saccade
+    float offsetSpeed {0.8f};  // screens/s, slower ends it
+    float window {0.02f};      // s of samples speed is measured across, longer is steadier but ends saccades later
+    float maxDuration {0.12f}; // s, moving fast for longer is pursuit or the head, not a saccade
+    float maxGap {0.25f};      // s, start over after a longer silence (tracking lost)
+    int   maxFrames {6};       // cheaper frames in a row at most, then full ones until the saccade ends
+};
+
+enum class RenderTier
+{
+    Full,
+    Saccade // the eye is moving too fast to take in detail
+};
+
+// velocity threshold classifier with hysteresis: a saccade starts once gaze moves faster than
+// onsetSpeed and ends when it drops below offsetSpeed, measured over the samples of the last
+// window; one that runs on past maxDuration is called off until speed drops again
+class SaccadeDetector
+{
+public:
+    SaccadeDetector(const SaccadeSettings& settings = {}) : m_settings {settings} { }
+
+    void Update(const GazeSample& sample)
+    {
+        const auto dt = m_samples.empty() ? 0.0f : (sample.timestamp - m_samples.back().timestamp) / 1000000.0f;
+        if(dt > m_settings.maxGap || dt < -m_settings.maxGap)
+        {
+            m_samples.clear();
+            m_state = State::Fixation;
+        }
+        else if(!m_samples.empty() && dt <= 0)
+        {
+            return; // same or older timestamp
+        }
+        m_samples.push_back(sample);
+
+        // oldest sample kept is the newest one at least a window old
+        const auto window = static_cast<int64_t>(m_settings.window * 1000000);
+        while(m_samples.size() > 2 && sample.timestamp - m_samples[1].timestamp >= window)
+            m_samples.pop_front();
+
+        const auto& first = m_samples.front();
+        const auto  span  = (sample.timestamp - first.timestamp) / 1000000.0f;
+        m_speed           = span > 0 ? std::hypot(sample.x - first.x, sample.y - first.y) / span : 0.0f;
+
+        switch(m_state)
+        {
+        case State::Fixation:
+            if(m_speed > m_settings.onsetSpeed)
+            {
+                m_state = State::Saccade;
+                m_onset = sample.timestamp;
+            }
+            break;
+        case State::Saccade:
+            if(m_speed < m_settings.offsetSpeed)
+                m_state = State::Fixation;
+            else if((sample.timestamp - m_onset) / 1000000.0f > m_settings.maxDuration)
+                m_state = State::Moving;
+            break;
+        case State::Moving:
+            if(m_speed < m_settings.offsetSpeed)
+                m_state = State::Fixation;
+            break;
+        }
+    }
+
+    bool Saccade() const
+    {
+        return m_state == State::Saccade;
+    }
+
+    // screens/s across the window
+    float Speed() const
+    {
+        return m_speed;
+    }
+
+    const SaccadeSettings& Settings() const
+    {
+        return m_settings;
+    }
+
+private:
+    enum class State
+    {
+        Fixation,
+        Saccade,
+        Moving // fast for too long to be a saccade
+    };
+
+    SaccadeSettings        m_settings;
+    std::deque<GazeSample> m_samples;
+    State                  m_state {State::Fixation};
+    int64_t                m_onset {0}; // timestamp the saccade started
+    float                  m_speed {0};
+};
+
+// tier each frame renders at: cheaper while a saccade is in flight, for no more than maxFrames
+// in a row, and full again on the first frame after it ends
+class RenderBudget
+{
+public:
+    RenderBudget(const SaccadeSettings& settings = {}) : m_settings {settings} { }
+
+    RenderTier Frame(bool saccade)
+    {
+        if(!saccade)
+            m_spent = false;
+        else if(m_run >= m_settings.maxFrames)
+            m_spent = true;
+
+        if(saccade && m_settings.reduce && !m_spent)
+        {
+            m_run++;
+            m_saved++;
+            return RenderTier::Saccade;
+        }
+        m_run = 0;
+        return RenderTier::Full;
+    }
+
+    // frames rendered cheaper so far
+    uint64_t Saved() const
+    {
+        return m_saved;
+    }
+
+private:
+    SaccadeSettings m_settings;
+    int             m_run {0};       // cheaper frames in a row
+    bool            m_spent {false}; // of this saccade's cheaper frames
+    uint64_t        m_saved {0};
+};
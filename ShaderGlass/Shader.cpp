@@ -8,6 +8,7 @@ GNU General Public License v3.0
 #include "pch.h"
 
 #include "Shader.h"
+#include "RenderGraph.h"
 
 static HRESULT hr;
 
@@ -45,68 +46,36 @@ const static std::unordered_map<std::string, DXGI_FORMAT> sFormats = {{"R8_UNORM
 Shader::Shader(ShaderDef& shaderDef) :
     m_shaderDef(shaderDef), m_vertexShader {}, m_pixelShader {}, m_alias {}, m_scaleAbsoluteX {}, m_scaleAbsoluteY {}, m_scaleViewportX {}, m_scaleViewportY {}
 {
-    m_pushBuffer = std::make_unique<int[]>(BufferSize(PUSH_BUFFER));
-    m_uboBuffer  = std::make_unique<int[]>(BufferSize(UBO_BUFFER));
+    m_pushSize   = m_shaderDef.ParamsSize(PUSH_BUFFER);
+    m_uboSize    = m_shaderDef.ParamsSize(UBO_BUFFER);
+    m_pushBuffer = std::make_unique<int[]>(m_pushSize);
+    m_uboBuffer  = std::make_unique<int[]>(m_uboSize);
+    BindParams();
     for(auto& p : shaderDef.Params)
     {
-        SetParam(p.name, &p.defaultValue);
+        SetParam(&p, &p.defaultValue);
     }
+    Invalidate();
 
-    m_filterLinear = IsTrue("filter_linear");
-    if(IsTrue("srgb_framebuffer"))
-        m_format = DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
-    if(IsTrue("float_framebuffer"))
-        m_format = DXGI_FORMAT_R16G16B16A16_FLOAT;
-    if(shaderDef.Format != NULL && strlen(shaderDef.Format) > 0)
-    {
-        auto format = sFormats.find(shaderDef.Format);
-        if(format != sFormats.end())
-            m_format = format->second;
+    m_filterLinear  = IsTrue("filter_linear");
+    auto formatName = RenderGraph::FormatName(shaderDef);
+    auto format     = sFormats.find(formatName);
+    if(format != sFormats.end())
+        m_format = format->second;
 #ifdef _DEBUG
-        else
-            throw std::runtime_error("Unknown format " + std::string(shaderDef.Format));
+    else
+        throw std::runtime_error("Unknown format " + formatName);
 #endif
-    }
 
-    std::string value;
-
-    if(Get("scale_x", value))
-        m_scaleX = stof(value);
-    if(Get("scale_y", value))
-        m_scaleY = stof(value);
-    if(Get("scale", value))
-    {
-        m_scaleX = stof(value);
-        m_scaleY = m_scaleX;
-    }
+    const PassScale scale(shaderDef);
+    m_scaleX         = scale.x;
+    m_scaleY         = scale.y;
+    m_scaleViewportX = scale.viewportX;
+    m_scaleViewportY = scale.viewportY;
+    m_scaleAbsoluteX = scale.absoluteX;
+    m_scaleAbsoluteY = scale.absoluteY;
 
-    if(Get("scale_type_x", value))
-    {
-        if(value == "viewport")
-            m_scaleViewportX = true;
-        else if(value == "absolute")
-            m_scaleAbsoluteX = true;
-    }
-    if(Get("scale_type_y", value))
-    {
-        if(value == "viewport")
-            m_scaleViewportY = true;
-        else if(value == "absolute")
-            m_scaleAbsoluteY = true;
-    }
-    if(Get("scale_type", value))
-    {
-        if(value == "viewport")
-        {
-            m_scaleViewportX = true;
-            m_scaleViewportY = true;
-        }
-        else if(value == "absolute")
-        {
-            m_scaleAbsoluteX = true;
-            m_scaleAbsoluteY = true;
-        }
-    }
+    std::string value;
     if(Get("alias", value))
     {
         m_alias = value;
@@ -189,48 +158,91 @@ void Shader::Compile()
     m_shaderDef.FragmentLength   = m_pixelBlob->GetBufferSize();
 }
 
-void Shader::FillParams(int buffer, void* data)
+void Shader::BindParams()
 {
-    if(buffer == PUSH_BUFFER)
-        memcpy(data, m_pushBuffer.get(), BufferSize(buffer));
-    else
-        memcpy(data, m_uboBuffer.get(), BufferSize(buffer));
+    m_slots = ParamSlots(m_shaderDef.Params);
+    for(auto i : m_slots.UserParams())
+        m_userParams.push_back(&m_shaderDef.Params[i]);
 }
 
-std::vector<ShaderParam*> Shader::Params()
+const uint8_t* Shader::Params(int buffer) const
 {
-    std::vector<ShaderParam*> params;
-    for(auto& p : m_shaderDef.Params)
-        params.push_back(&p);
-    return params;
+    return (const uint8_t*)(buffer == PUSH_BUFFER ? m_pushBuffer.get() : m_uboBuffer.get());
 }
 
-void Shader::SetParam(ShaderParam* p, void* v)
+const DirtyRange& Shader::Dirty(int buffer) const
+{
+    return buffer == PUSH_BUFFER ? m_pushDirty : m_uboDirty;
+}
+
+void Shader::Uploaded(int buffer)
+{
+    (buffer == PUSH_BUFFER ? m_pushDirty : m_uboDirty).Clear();
+}
+
+void Shader::Invalidate()
 {
-    char* buf = (char*)(p->buffer == PUSH_BUFFER ? m_pushBuffer.get() : m_uboBuffer.get());
+    // whole buffers, e.g. for a pass that hasn't uploaded anything yet
+    m_pushDirty.Mark(0, m_pushSize);
+    m_uboDirty.Mark(0, m_uboSize);
+}
 
+const std::vector<ShaderParam*>& Shader::UserParams() const
+{
+    return m_userParams;
+}
+
+const ParamSlots& Shader::Slots() const
+{
+    return m_slots;
+}
+
+ParamSlot Shader::FindParam(const std::string& name) const
+{
+    return m_slots.Find(name);
+}
+
+void Shader::WriteParam(const ShaderParam& p, const void* v)
+{
+    // most params are rewritten every frame with the same value, only changes need uploading
+    char* buf = (char*)(p.buffer == PUSH_BUFFER ? m_pushBuffer.get() : m_uboBuffer.get());
+    if(memcmp(buf + p.offset, v, p.size) != 0)
+    {
+        memcpy(buf + p.offset, v, p.size);
+        (p.buffer == PUSH_BUFFER ? m_pushDirty : m_uboDirty).Mark(p.offset, p.size);
+    }
+}
+
+void Shader::SetParam(ShaderParam* p, void* v)
+{
     // if it's float remember value (user parameter)
     if(p->size == 4)
         p->currentValue = *((float*)v);
 
-    memcpy(buf + p->offset, v, p->size);
+    WriteParam(*p, v);
 }
 
-void Shader::SetParam(std::string name, void* v)
+void Shader::SetParam(const ParamSlot& slot, const void* v)
 {
-    for(auto& p : m_shaderDef.Params)
-    {
-        if(p.name == name)
-        {
-            SetParam(&p, v);
-            // return; // same param can be in both bufs
-        }
-    }
+    // same param can be in both bufs
+    if(slot.push >= 0)
+        WriteParam(m_shaderDef.Params[slot.push], v);
+    if(slot.ubo >= 0)
+        WriteParam(m_shaderDef.Params[slot.ubo], v);
+}
+
+void Shader::SetParam(const std::string& name, void* v)
+{
+    auto slot = FindParam(name);
+    if(slot.push >= 0)
+        SetParam(&m_shaderDef.Params[slot.push], v);
+    if(slot.ubo >= 0)
+        SetParam(&m_shaderDef.Params[slot.ubo], v);
 }
 
 size_t Shader::BufferSize(int buffer)
 {
-    return m_shaderDef.ParamsSize(buffer);
+    return buffer == PUSH_BUFFER ? m_pushSize : m_uboSize;
 }
 
 bool Shader::IsTrue(const std::string& presetParam)
@@ -10,9 +10,8 @@ GNU General Public License v3.0
 #pragma once
 
 #include "ShaderDef.h"
-
-constexpr auto PUSH_BUFFER = -1;
-constexpr auto UBO_BUFFER  = 0;
+#include "ConstantArena.h"
+#include "ParamSlots.h"
 
 struct float4
 {
@@ -58,11 +57,17 @@ public:
 
     void                      Create(winrt::com_ptr<ID3D11Device> d3dDevice);
     void                      Compile();
-    std::vector<ShaderParam*> Params();
-    void                      FillParams(int buffer, void* data);
-    void                      SetParam(ShaderParam* p, void* v);
-    void                      SetParam(std::string name, void* p);
-    size_t                    BufferSize(int buffer);
+    const std::vector<ShaderParam*>& UserParams() const;
+    const ParamSlots&                Slots() const;
+    ParamSlot                        FindParam(const std::string& name) const;
+    const uint8_t*                   Params(int buffer) const;
+    const DirtyRange&                Dirty(int buffer) const;
+    void                             Uploaded(int buffer);
+    void                             Invalidate();
+    void                             SetParam(ShaderParam* p, void* v);
+    void                             SetParam(const ParamSlot& slot, const void* v);
+    void                             SetParam(const std::string& name, void* v);
+    size_t                           BufferSize(int buffer);
 
 private:
     std::unique_ptr<int[]>   m_pushBuffer;
@@ -70,6 +75,15 @@ private:
     winrt::com_ptr<ID3DBlob> m_vertexBlob;
     winrt::com_ptr<ID3DBlob> m_pixelBlob;
 
+    ParamSlots                m_slots;
+    std::vector<ShaderParam*> m_userParams;
+    size_t                    m_pushSize {0};
+    size_t                    m_uboSize {0};
+    DirtyRange                m_pushDirty {};
+    DirtyRange                m_uboDirty {};
+
+    void BindParams();
+    void WriteParam(const ShaderParam& p, const void* v);
     bool IsTrue(const std::string& presetParam);
     bool Get(const std::string& presetParam, std::string& value);
 };
\ No newline at end of file
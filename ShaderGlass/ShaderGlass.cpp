@@ -14,10 +14,11 @@ GNU General Public License v3.0
 static HRESULT     hr;
 static const float background_colour[4] = {0, 0, 0, 1.0f};
 
-ShaderGlass::ShaderGlass(CursorEmulator& cursorEmulator) :
+ShaderGlass::ShaderGlass(CursorEmulator& cursorEmulator, GazeSource& gazeSource) :
     m_lastSize {}, m_lastPos {}, m_lastCaptureWindowPos {}, m_lastCaptureWindowSize {}, m_passthroughDef(), m_shaderPreset(new Preset(m_passthroughDef)),
     m_preprocessShader(m_preprocessShaderDef), m_preprocessPreset(m_preprocessPresetDef), m_preprocessPass(m_preprocessShader, m_preprocessPreset, true),
-    m_cursorEmulator(cursorEmulator)
+    m_rotateShader(m_preprocessShaderDef), m_compositeShader(m_compositeShaderDef), m_compositePass(m_compositeShader, m_preprocessPreset, false),
+    m_cursorEmulator(cursorEmulator), m_gazeSource(gazeSource)
 { }
 
 ShaderGlass::~ShaderGlass()
@@ -27,6 +28,8 @@ ShaderGlass::~ShaderGlass()
     DestroyShaders();
     DestroyPasses();
     DestroyTargets();
+    m_targetPool.Clear();
+    m_inputViews.Clear();
 
     m_context->Flush();
 }
@@ -148,6 +151,11 @@ void ShaderGlass::Initialize(HWND                                outputWindow,
     hr                         = m_device->CreateRasterizerState(&desc, m_rasterizerState.put());
     assert(SUCCEEDED(hr));
 
+    // for the fovea, which only renders a part of every pass
+    desc.ScissorEnable = TRUE;
+    hr                 = m_device->CreateRasterizerState(&desc, m_scissorState.put());
+    assert(SUCCEEDED(hr));
+
     if(m_useHDR)
     {
         hr = m_swapChain->QueryInterface(__uuidof(IDXGISwapChain3), reinterpret_cast<void**>(m_swapChain3.put()));
@@ -158,8 +166,73 @@ void ShaderGlass::Initialize(HWND                                outputWindow,
 
     m_context->RSSetState(m_rasterizerState.get());
 
+    // keep up to two 4K screens worth of idle targets around for resizes and preset switches
+    m_targetPool = TargetPool<PooledTarget>(
+        [this](const TargetKey& key) {
+            PooledTarget pooledTarget {key};
+
+            D3D11_TEXTURE2D_DESC desc2 = {};
+            desc2.Width                = key.width;
+            desc2.Height               = key.height;
+            desc2.MipLevels            = 1;
+            desc2.ArraySize            = 1;
+            desc2.Format               = static_cast<DXGI_FORMAT>(key.format);
+            desc2.SampleDesc.Count     = 1;
+            desc2.Usage                = D3D11_USAGE_DEFAULT;
+            desc2.BindFlags            = key.bind;
+            hr                         = m_device->CreateTexture2D(&desc2, nullptr, pooledTarget.texture.put());
+            assert(SUCCEEDED(hr));
+
+            if(key.bind & D3D11_BIND_RENDER_TARGET)
+            {
+                hr = m_device->CreateRenderTargetView(pooledTarget.texture.get(), nullptr, pooledTarget.target.put());
+                assert(SUCCEEDED(hr));
+            }
+            if(key.bind & D3D11_BIND_SHADER_RESOURCE)
+            {
+                hr = m_device->CreateShaderResourceView(pooledTarget.texture.get(), nullptr, pooledTarget.view.put());
+                assert(SUCCEEDED(hr));
+            }
+            return pooledTarget;
+        },
+        2ull * 3840 * 2160);
+
+    // uniforms of all passes go to one ring bound by offset where the driver allows
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+    if(SUCCEEDED(m_device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) && options.ConstantBufferOffsetting &&
+       options.MapNoOverwriteOnDynamicConstantBuffer)
+    {
+        m_uniformArena.ring = ConstantArena(D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * 16);
+
+        D3D11_BUFFER_DESC arenaDesc = {};
+        arenaDesc.ByteWidth         = static_cast<UINT>(m_uniformArena.ring.Capacity());
+        arenaDesc.Usage             = D3D11_USAGE_DYNAMIC;
+        arenaDesc.BindFlags         = D3D11_BIND_CONSTANT_BUFFER;
+        arenaDesc.CPUAccessFlags    = D3D11_CPU_ACCESS_WRITE;
+        hr                          = m_device->CreateBuffer(&arenaDesc, nullptr, m_uniformArena.buffer.put());
+        assert(SUCCEEDED(hr));
+        m_uniformArena.context = m_context.try_as<ID3D11DeviceContext1>();
+    }
+
+    // capture frame pools cycle through two textures, one extra for a pool being recreated
+    m_inputViews = InputViewCache(
+        [this](const winrt::com_ptr<ID3D11Texture2D>& texture) {
+            winrt::com_ptr<ID3D11ShaderResourceView> textureView;
+            hr = m_device->CreateShaderResourceView(texture.get(), nullptr, textureView.put());
+            assert(SUCCEEDED(hr));
+            return textureView;
+        },
+        3);
+
     m_preprocessShader.Create(m_device);
+    m_rotateShader.Create(m_device);
     m_preprocessPass.Initialize(m_device, m_context);
+    m_preprocessPass.SetArena(&m_uniformArena);
+    m_preprocessPass.SetBindings(ResourceSlots().Bind(m_preprocessShaderDef));
+    m_compositeShader.Create(m_device);
+    m_compositePass.Initialize(m_device, m_context);
+    m_compositePass.SetArena(&m_uniformArena);
+    m_compositePass.SetBindings({{2, SOURCE_SLOT}, {3, 0}}); // periphery, m_compositeResources
     RebuildShaders();
 
     m_running = true;
@@ -175,10 +248,20 @@ void ShaderGlass::RebuildShaders()
     }
     if(m_vertical)
     {
-        m_shaderPasses.emplace_back(m_preprocessShader, m_preprocessPreset, m_device, m_context);
+        // the final pass renders rotated itself, unless its output is read back as feedback
+        std::vector<const ShaderDef*> presetDefs;
+        for(const auto& shaderPass : m_shaderPasses)
+            presetDefs.push_back(&shaderPass.m_shader.m_shaderDef);
+        if(ResourceSlots(presetDefs, {}).Feedback((int)presetDefs.size() - 1))
+            m_shaderPasses.emplace_back(m_rotateShader, m_preprocessPreset, m_device, m_context);
+        else
+            m_shaderPasses.back().SetTransposed(true);
     }
+    for(auto& shaderPass : m_shaderPasses)
+        shaderPass.SetArena(&m_uniformArena);
     float vertical = m_vertical ? 1.0f : 0.0f;
     m_preprocessShader.SetParam("SGVertical", &vertical);
+    m_rotateShader.SetParam("SGVertical", &vertical);
 
     m_presetTextures.clear();
     for(auto& texture : m_shaderPreset->m_textures)
@@ -186,7 +269,38 @@ void ShaderGlass::RebuildShaders()
         m_presetTextures.insert(make_pair(texture.second.m_name, texture.second.m_textureView));
     }
 
-    ResetParams();
+    // resolve every sampler to a resource slot once
+    std::vector<const ShaderDef*> passDefs;
+    std::vector<std::string>      textureNames;
+    for(const auto& shaderPass : m_shaderPasses)
+        passDefs.push_back(&shaderPass.m_shader.m_shaderDef);
+    for(const auto& pt : m_presetTextures)
+        textureNames.push_back(pt.first);
+    m_renderGraph = RenderGraph(passDefs, textureNames);
+    for(auto& shaderPass : m_shaderPasses)
+        shaderPass.SetBindings(m_renderGraph.Slots().Bind(shaderPass.m_shader.m_shaderDef));
+
+    m_staticChain = true;
+    for(const auto* passDef : passDefs)
+        m_staticChain &= !passDef->DependsOnFrame();
+
+    m_gazeParams.clear();
+    for(int s = 0; s < (int)m_shaderPreset->m_shaders.size(); s++)
+    {
+        ShaderParam* x = nullptr;
+        ShaderParam* y = nullptr;
+        for(auto* p : m_shaderPreset->m_shaders[s].UserParams())
+        {
+            if(p->name == m_gazeBinding.xParam)
+                x = p;
+            else if(p->name == m_gazeBinding.yParam)
+                y = p;
+        }
+        if(x || y)
+            m_gazeParams.emplace_back(s, x, y);
+    }
+
+    ApplyParams(true);
 }
 
 void ShaderGlass::SetInputScale(float w, float h)
@@ -257,6 +371,185 @@ void ShaderGlass::SetVertical(bool vertical)
     }
 }
 
+void ShaderGlass::SetGazeBinding(const GazeBinding& binding)
+{
+    // only before the first frame, params are resolved when shaders are rebuilt
+    m_gazeBinding = binding;
+}
+
+void ShaderGlass::SetGazeFilter(const GazeFilterSettings& settings)
+{
+    // only before the first frame
+    m_gazeFilter = GazeFilter(settings);
+}
+
+void ShaderGlass::SetSaccadeBudget(const SaccadeSettings& settings)
+{
+    // only before the first frame
+    m_saccadeDetector = SaccadeDetector(settings);
+    m_renderBudget    = RenderBudget(settings);
+}
+
+void ShaderGlass::SetFoveation(const FoveaSettings& settings)
+{
+    // only before the first frame
+    m_foveaSettings = settings;
+}
+
+void ShaderGlass::SetTileRefresh(const TileSettings& settings)
+{
+    // only before the first frame
+    m_tileScheduler = TileScheduler(settings);
+}
+
+void ShaderGlass::BindGaze(LONG left, LONG top, UINT width, UINT height)
+{
+    m_gazeSamples.clear();
+    if(m_gazeSource.Read(m_gazeSamples))
+    {
+        for(const auto& sample : m_gazeSamples)
+        {
+            m_gazeFilter.Update(sample);
+            m_saccadeDetector.Update(sample);
+        }
+
+        const auto latency = (GazeSample::Now() - m_gazeSamples.back().timestamp) / 1000.0f;
+        m_gazeLatency      = m_gazeReceived ? m_gazeLatency * 0.9f + latency * 0.1f : latency;
+        m_gazeReceived     = true;
+    }
+    if(!m_gazeReceived)
+        return;
+
+    // where the gaze will be once this frame is on screen: rendered and presented as long
+    // as recent frames took, then composed by DWM at the next refresh
+    int64_t refreshPeriod = 0;
+    DWM_TIMING_INFO timingInfo {};
+    timingInfo.cbSize = sizeof(timingInfo);
+    LARGE_INTEGER frequency;
+    if(SUCCEEDED(DwmGetCompositionTimingInfo(nullptr, &timingInfo)) && QueryPerformanceFrequency(&frequency))
+        refreshPeriod = static_cast<int64_t>(timingInfo.qpcRefreshPeriod * 1000000 / frequency.QuadPart);
+    m_gazeBoundAt = GazeSample::Now();
+    m_gaze        = m_gazeFilter.Predict(m_gazeBoundAt + static_cast<int64_t>(m_presentLatency) + refreshPeriod);
+
+    // params span their whole range across the output, rebinding the same value leaves passes clean
+    const auto [x, y] = GazeBinding::ToWindow(
+        m_gaze, (float)GetSystemMetrics(SM_CXSCREEN), (float)GetSystemMetrics(SM_CYSCREEN), (float)left, (float)top, (float)width, (float)height);
+    m_gazePosition = {x, y};
+    for(const auto& [s, px, py] : m_gazeParams)
+    {
+        auto& shader = m_shaderPreset->m_shaders[s];
+        if(px)
+        {
+            auto value = std::clamp(px->minValue + x * (px->maxValue - px->minValue), px->minValue, px->maxValue);
+            shader.SetParam(px, &value);
+        }
+        if(py)
+        {
+            auto value = std::clamp(py->minValue + y * (py->maxValue - py->minValue), py->minValue, py->maxValue);
+            shader.SetParam(py, &value);
+        }
+    }
+}
+
+void ShaderGlass::BuildFoveation(UINT width, UINT height)
+{
+    D3D11_TEXTURE2D_DESC displayDesc = {};
+    m_displayTexture->GetDesc(&displayDesc);
+    const auto passBind = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
+
+    // periphery chain, which has no feedback to swap
+    std::vector<PooledTarget> targets;
+    for(const auto& target : m_peripheryPlan.targets)
+    {
+        targets.push_back(AcquireTarget(target.width, target.height, m_shaderPasses[target.firstPass].m_shader.m_format, passBind));
+        m_passTextures.push_back(targets.back());
+    }
+    m_peripheryResources = m_passResources;
+    for(size_t p = 0; p + 1 < m_shaderPasses.size(); p++)
+    {
+        winrt::com_ptr<ID3D11RenderTargetView>   target;
+        winrt::com_ptr<ID3D11ShaderResourceView> view;
+        if(m_peripheryPlan.passTargets[p] >= 0)
+        {
+            target = targets[m_peripheryPlan.passTargets[p]].target;
+            view   = targets[m_peripheryPlan.passTargets[p]].view;
+        }
+        else if(m_peripheryPlan.elided[p] && p > 0)
+        {
+            view = m_peripheryViews[p - 1];
+        }
+        m_peripheryTargets.push_back(target);
+        m_peripheryViews.push_back(view);
+        m_peripheryResources[m_renderGraph.Slots().PassOutput((int)p)] = view;
+    }
+
+    // both display passes render off screen for the composite
+    const auto& peripherySize   = m_peripheryPlan.passSizes[m_peripheryPlan.displayPass];
+    auto        peripheryOutput = AcquireTarget(peripherySize[2], peripherySize[3], displayDesc.Format, passBind);
+    auto        foveaOutput     = AcquireTarget(width, height, displayDesc.Format, passBind);
+    m_passTextures.push_back(peripheryOutput);
+    m_passTextures.push_back(foveaOutput);
+    m_peripheryOutput    = peripheryOutput.target;
+    m_foveaOutput        = foveaOutput.target;
+    m_compositeResources = {foveaOutput.view};
+
+    m_tileScheduler.Resize(peripherySize[2], peripherySize[3]);
+    m_cursorTile = {};
+
+    m_compositePass.Resize(peripherySize[2], peripherySize[3], width, height, {}, {});
+    m_compositePass.m_sourceView = peripheryOutput.view.get();
+    m_compositePass.m_targetView = m_displayRenderTarget.get();
+}
+
+void ShaderGlass::BindChain(const RenderPlan&                                              plan,
+                            const std::vector<winrt::com_ptr<ID3D11RenderTargetView>>&   targets,
+                            const std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>& views,
+                            ID3D11RenderTargetView*                                      output)
+{
+    // the fovea and periphery chains share passes, which take on the sizes and targets of the one rendering next
+    const auto& passSizes = plan.passSizes;
+    for(size_t p = 0; p < m_shaderPasses.size(); p++)
+    {
+        auto& shaderPass = m_shaderPasses[p];
+        shaderPass.Resize(passSizes[p][0], passSizes[p][1], passSizes[p][2], passSizes[p][3], plan.textureSizes, passSizes);
+        if((int)p == plan.displayPass)
+            shaderPass.m_targetView = output;
+        else
+            shaderPass.m_targetView = p < targets.size() ? targets[p].get() : nullptr;
+        if(p > 0)
+            shaderPass.m_sourceView = views[p - 1].get();
+    }
+}
+
+void ShaderGlass::RenderChain(const RenderPlan&                                              plan,
+                              ID3D11ShaderResourceView*                                    originalView,
+                              const std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>& resources,
+                              int                                                          frameNo,
+                              const std::vector<std::vector<FoveaRect>>*                   scissors)
+{
+    for(int p = 0; p <= plan.displayPass; p++)
+    {
+        if(plan.elided[p])
+            continue;
+
+        // a draw per scissor rect, or one of the whole output
+        const auto draws = scissors ? scissors->at(p).size() : 1;
+        for(size_t d = 0; d < draws; d++)
+        {
+            if(scissors)
+            {
+                const auto&      scissor = scissors->at(p)[d];
+                const D3D11_RECT rect {scissor.left, scissor.top, scissor.right, scissor.bottom};
+                m_context->RSSetScissorRects(1, &rect);
+            }
+            if(p == 0)
+                m_shaderPasses[p].Render(originalView, resources, frameNo, 0, 0);
+            else
+                m_shaderPasses[p].Render(resources, frameNo, 0, 0);
+        }
+    }
+}
+
 void ShaderGlass::DestroyTargets()
 {
     if(m_preprocessedRenderTarget != nullptr)
@@ -264,17 +557,27 @@ void ShaderGlass::DestroyTargets()
         m_preprocessedRenderTarget = nullptr;
         m_originalView             = nullptr;
         m_preprocessedTexture      = nullptr;
+        for(auto& originalTarget : m_originalTargets)
+            m_targetPool.Release(std::move(originalTarget));
+        m_originalTargets.clear();
+    }
+}
+
+PooledTarget ShaderGlass::AcquireTarget(UINT width, UINT height, DXGI_FORMAT format, UINT bindFlags)
+{
+    auto target = m_targetPool.Acquire({width, height, static_cast<uint32_t>(format), bindFlags});
+    if(target.target)
+    {
+        // may hold another preset's output
+        m_context->ClearRenderTargetView(target.target.get(), background_colour);
     }
+    return target;
 }
 
 void ShaderGlass::UpdateParams()
 {
-    for(auto& s : m_shaderPreset->m_shaders)
-        for(auto& p : s.Params())
-        {
-            if(p->size == 4 && p->name != "FrameCount")
-                s.SetParam(p, &p->currentValue);
-        }
+    // written into the shaders by the render thread, under the lock
+    m_paramsChanged = true;
 }
 
 float ShaderGlass::GetDefaultValue(ShaderParam* p)
@@ -290,29 +593,20 @@ float ShaderGlass::GetDefaultValue(ShaderParam* p)
 }
 
 void ShaderGlass::ResetParams()
+{
+    m_paramsReset = true;
+}
+
+void ShaderGlass::ApplyParams(bool reset)
 {
     for(auto& s : m_shaderPreset->m_shaders)
-        for(auto& p : s.Params())
+        for(auto& p : s.UserParams())
         {
-            if(p->size == 4 && p->name != "FrameCount")
-            {
-                // check for preset override
-                auto hasOverride = false;
-                for(auto& o : m_shaderPreset->m_presetDef.Overrides)
-                {
-                    if(o.name == p->name)
-                    {
-                        s.SetParam(p, &o.value);
-                        hasOverride = true;
-                        break;
-                    }
-                }
-                if(!hasOverride)
-                {
-                    s.SetParam(p, &p->defaultValue);
-                }
-            }
+            if(reset)
+                p->currentValue = GetDefaultValue(p); // preset override if there is one
+            s.SetParam(p, &p->currentValue);
         }
+    m_paramsUpdated = true;
 }
 
 std::vector<std::tuple<int, ShaderParam*>> ShaderGlass::Params()
@@ -321,9 +615,8 @@ std::vector<std::tuple<int, ShaderParam*>> ShaderGlass::Params()
     int                                        i = 0;
     for(auto& s : m_shaderPreset->m_shaders)
     {
-        for(auto& p : s.Params())
-            if(p->size == 4 && p->name != "FrameCount")
-                params.push_back(std::make_tuple(i, p));
+        for(auto& p : s.UserParams())
+            params.push_back(std::make_tuple(i, p));
 
         i++;
     }
@@ -345,9 +638,6 @@ bool ShaderGlass::TryResizeSwapChain(const RECT& clientRect, bool force)
 {
     if(force || (clientRect.right != m_lastSize.x) || (clientRect.bottom != m_lastSize.y))
     {
-        // force recreate
-        DestroyTargets();
-
         m_lastSize.x = clientRect.right;
         m_lastSize.y = clientRect.bottom;
 
@@ -385,16 +675,20 @@ void ShaderGlass::DestroyShaders()
 
 void ShaderGlass::DestroyPasses()
 {
-    for(auto& rs : m_passResources)
-    {
-        if(rs.first.starts_with("PassOutput") || rs.first.starts_with("PassFeedback"))
-        {
-            rs.second = nullptr;
-        }
-    }
     m_passTargets.clear();
+    m_passViews.clear();
+    m_feedbackTargets.clear();
+    m_feedbackViews.clear();
+    for(auto& passTexture : m_passTextures)
+        m_targetPool.Release(std::move(passTexture));
     m_passTextures.clear();
     m_passResources.clear();
+    m_peripheryTargets.clear();
+    m_peripheryViews.clear();
+    m_peripheryResources.clear();
+    m_compositeResources.clear();
+    m_peripheryOutput  = nullptr;
+    m_foveaOutput      = nullptr;
     m_requiresFeedback = false;
     m_requiresHistory  = 0;
 }
@@ -548,8 +842,8 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
     textureRect.right  = capturedTextureDesc.Width;
     textureRect.bottom = capturedTextureDesc.Height;
 
-    auto outputResized = false;
-    outputResized      = TryResizeSwapChain(clientRect, m_outputRescaled);
+    const bool outputRescaled = m_outputRescaled;
+    auto       outputResized  = TryResizeSwapChain(clientRect, outputRescaled);
 
     if(clientRect.right <= 0 || clientRect.bottom <= 0)
     {
@@ -564,47 +858,17 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
     float boxX = 0, boxY = 0;
     if(m_captureWindow || m_image)
     {
-        const auto captureW = (captureClient.right - captureClient.left);
-        const auto captureH = (captureClient.bottom - captureClient.top);
-
-        if(!m_freeScale)
-        {
-            clientWidth  = (LONG)roundf(captureW / m_outputScaleW);
-            clientHeight = (LONG)roundf(captureH / m_outputScaleH);
-        }
-
-        // box if needed
-        if(captureW != 0 && captureH != 0)
-        {
-            auto inputAspectRatio  = captureW / (float)captureH;
-            auto outputAspectRatio = (clientWidth * m_outputScaleW) / (clientHeight * m_outputScaleH);
-            if(outputAspectRatio > inputAspectRatio)
-            {
-                // output is wider
-                auto newWidth = (LONG)roundf(clientHeight * (m_outputScaleH / m_outputScaleW) * inputAspectRatio);
-                boxX          = (clientWidth - newWidth) / 2.0f;
-                clientWidth   = newWidth;
-            }
-            else if(outputAspectRatio < inputAspectRatio)
-            {
-                // output is narrower
-                auto newHeight = (LONG)roundf(clientWidth * (m_outputScaleW / m_outputScaleH) / inputAspectRatio);
-                boxY           = (clientHeight - newHeight) / 2.0f;
-                clientHeight   = newHeight;
-            }
-
-            // center (fullscreen?)
-            if(!m_freeScale)
-            {
-                boxX += (clientRect.right - (captureW / m_outputScaleW)) / 2.0f;
-                boxY += (clientRect.bottom - (captureH / m_outputScaleH)) / 2.0f;
-            }
-
-            if(boxX < 0)
-                boxX = 0;
-            if(boxY < 0)
-                boxY = 0;
-        }
+        auto viewport = FitViewport(clientWidth,
+                                    clientHeight,
+                                    captureClient.right - captureClient.left,
+                                    captureClient.bottom - captureClient.top,
+                                    m_outputScaleW,
+                                    m_outputScaleH,
+                                    m_freeScale);
+        clientWidth  = viewport.width;
+        clientHeight = viewport.height;
+        boxX         = viewport.boxX;
+        boxY         = viewport.boxY;
     }
     m_boxX = static_cast<int>(boxX);
     m_boxY = static_cast<int>(boxY);
@@ -669,7 +933,7 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
                 }
             }
             m_newParams.clear();
-            UpdateParams();
+            ApplyParams(false);
         }
         PostMessage(m_outputWindow, WM_COMMAND, IDM_UPDATE_PARAMS, 0);
         inputRescaled     = true;
@@ -678,6 +942,29 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
         m_verticalUpdated = false;
     }
 
+    // changed from the UI, only written here so that uploads can't clear a mark they didn't copy
+    if(m_paramsReset.exchange(false))
+    {
+        m_paramsChanged = false;
+        ApplyParams(true);
+        PostMessage(m_outputWindow, WM_COMMAND, IDM_UPDATE_PARAMS, 0);
+    }
+    else if(m_paramsChanged.exchange(false))
+    {
+        ApplyParams(false);
+    }
+
+    if(m_gazeSource.Active())
+    {
+        // gaze is relative to the output area, not the captured one
+        POINT origin {0, 0};
+        ClientToScreen(m_outputWindow, &origin);
+        BindGaze(origin.x + m_boxX, origin.y + m_boxY, viewportWidth, viewportHeight);
+    }
+
+    // detail is lost on the eye while it is in flight between fixations
+    const auto tier = m_renderBudget.Frame(m_gazeReceived && m_saccadeDetector.Saccade());
+
     // size of preprocessed input, which is 'original' for the shader chain
     UINT originalWidth  = static_cast<UINT>(destWidth / m_inputScaleW);
     UINT originalHeight = static_cast<UINT>(destHeight / m_inputScaleH);
@@ -690,242 +977,176 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
         originalHeight      = static_cast<UINT>(captureH / m_inputScaleH);
     }
 
-    // create preprocessed output texture, scaled down size, inverted etc.
-    if(m_preprocessedTexture == nullptr)
+    // with gaze the chain can render twice, at full resolution around it and at reduced scale everywhere,
+    // unless a pass reads back its own output, which would differ between the two
+    const auto foveable = m_foveaSettings.size > 0 && m_gazeReceived && !m_vertical && !m_renderGraph.Slots().RequiresFeedback();
+
+    // live resizing keeps the planned chain and stretches it in the final pass until the window settles,
+    // unless the final pass samples its own feedback which has to match the display, or was elided, or
+    // composited with the periphery
+    const auto finalPass = (int)m_shaderPasses.size() - 1;
+    const auto settled   = m_resizeHysteresis.Update(viewportWidth, viewportHeight) ||
+                         (outputResized && (m_renderGraph.Slots().Feedback(finalPass) || m_renderPlan.displayPass != finalPass || m_foveated));
+    const auto replan    = inputRescaled || inputResized || outputRescaled || settled || m_renderPlan.passSizes.empty() || foveable != m_foveable;
+    if(replan)
     {
-        D3D11_TEXTURE2D_DESC desc2 = {};
-        texture->GetDesc(&desc2);
-        desc2.Usage          = D3D11_USAGE_DEFAULT;
-        desc2.BindFlags      = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
-        desc2.CPUAccessFlags = 0;
-        desc2.MiscFlags      = 0;
-        desc2.Width          = m_vertical ? originalHeight : originalWidth;
-        desc2.Height         = m_vertical ? originalWidth : originalHeight;
-
-        hr = m_device->CreateTexture2D(&desc2, nullptr, m_preprocessedTexture.put());
-        assert(SUCCEEDED(hr));
-        outputResized = true;
+        m_renderPlan      = m_renderGraph.Plan(originalWidth, originalHeight, viewportWidth, viewportHeight, m_vertical);
+        const auto before = m_foveated;
+        m_foveated        = false;
+        if(foveable)
+        {
+            const auto [peripheryWidth, peripheryHeight] = Foveation::PeripherySize(viewportWidth, viewportHeight, m_foveaSettings);
+            m_peripheryPlan                              = m_renderGraph.Plan(originalWidth, originalHeight, peripheryWidth, peripheryHeight, false);
+
+            // only where the two chains shade clearly less than the whole one; most presets do most of
+            // their work at source scale, which the periphery repeats, and foveated frames give up the
+            // partial, static and fused input paths
+            const auto share = Foveation::Share(m_renderPlan.passSizes, m_peripheryPlan.passSizes, viewportWidth, viewportHeight, m_foveaSettings);
+            m_foveated       = Foveation::Pays(share, before);
+        }
+        m_resizeHysteresis.Reset(viewportWidth, viewportHeight);
         rebuildPasses = true;
-
-        hr = m_device->CreateShaderResourceView(m_preprocessedTexture.get(), nullptr, m_originalView.put());
-        assert(SUCCEEDED(hr));
+        m_foveable    = foveable;
     }
+    const auto foveated = m_foveated;
 
-    // create texture render target
-    if(m_preprocessedRenderTarget == nullptr)
+    // preprocessed output textures, scaled down size, inverted etc.; one per history frame
+    const TargetKey originalKey {m_renderPlan.originalWidth, m_renderPlan.originalHeight, static_cast<uint32_t>(capturedTextureDesc.Format), D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET};
+    if(m_preprocessedTexture != nullptr && (m_originalTargets.size() != m_renderGraph.Slots().HistoryDepth() + 1 || m_originalTargets[0].key != originalKey))
     {
-        hr = m_device->CreateRenderTargetView(m_preprocessedTexture.get(), NULL, m_preprocessedRenderTarget.put());
-        assert(SUCCEEDED(hr));
-        rebuildPasses = true;
+        DestroyTargets();
     }
-
-    if(inputRescaled || outputResized || inputResized)
+    if(m_preprocessedTexture == nullptr)
     {
-        if(m_vertical)
+        m_historyRing = HistoryRing(m_renderGraph.Slots().HistoryDepth());
+        for(int h = 0; h < m_historyRing.Size(); h++)
         {
-            std::swap(originalWidth, originalHeight);
-            std::swap(viewportWidth, viewportHeight);
+            m_originalTargets.push_back(AcquireTarget(originalKey.width, originalKey.height, capturedTextureDesc.Format, originalKey.bind));
         }
+        m_preprocessedTexture      = m_originalTargets[m_historyRing.Current()].texture;
+        m_preprocessedRenderTarget = m_originalTargets[m_historyRing.Current()].target;
+        m_originalView             = m_originalTargets[m_historyRing.Current()].view;
+    }
 
-        m_textureSizes.clear();
-        m_textureSizes.insert(std::make_pair("Original", float4 {(float)originalWidth, (float)originalHeight, 1.0f / originalWidth, 1.0f / originalHeight}));
-        m_textureSizes.insert(std::make_pair("FinalViewport", float4 {(float)viewportWidth, (float)viewportHeight, 1.0f / viewportWidth, 1.0f / viewportHeight}));
-
+    if(replan)
+    {
         // preprocess takes original texture full size
-        std::vector<std::array<UINT, 4>> passSizes;
-        m_preprocessPass.Resize(capturedTextureDesc.Width, capturedTextureDesc.Height, originalWidth, originalHeight, m_textureSizes, passSizes);
-
-        UINT sourceWidth  = originalWidth;
-        UINT sourceHeight = originalHeight;
-        for(int p = 0; p < m_shaderPasses.size(); p++)
-        {
-            auto& shaderPass = m_shaderPasses[p];
-            if(p == m_shaderPasses.size() - 1) // last shader scales source to viewport
-            {
-                if(m_vertical)
-                {
-                    std::swap(originalWidth, originalHeight);
-                    std::swap(viewportWidth, viewportHeight);
-                }
-                passSizes.push_back({sourceWidth, sourceHeight, viewportWidth, viewportHeight});
-            }
-            else
-            {
-                UINT outputWidth  = sourceWidth;
-                UINT outputHeight = sourceHeight;
-                if(shaderPass.m_shader.m_scaleViewportX)
-                    outputWidth = static_cast<UINT>(viewportWidth * shaderPass.m_shader.m_scaleX);
-                else if(shaderPass.m_shader.m_scaleAbsoluteX)
-                    outputWidth = static_cast<UINT>(shaderPass.m_shader.m_scaleX);
-                else
-                    outputWidth = static_cast<UINT>(sourceWidth * shaderPass.m_shader.m_scaleX);
-                if(shaderPass.m_shader.m_scaleViewportY)
-                    outputHeight = static_cast<UINT>(viewportHeight * shaderPass.m_shader.m_scaleY);
-                else if(shaderPass.m_shader.m_scaleAbsoluteY)
-                    outputHeight = static_cast<UINT>(shaderPass.m_shader.m_scaleY);
-                else
-                    outputHeight = static_cast<UINT>(sourceHeight * shaderPass.m_shader.m_scaleY);
-                passSizes.push_back({sourceWidth, sourceHeight, outputWidth, outputHeight});
-                if(!shaderPass.m_shader.m_alias.empty())
-                {
-                    m_textureSizes.insert(std::make_pair(shaderPass.m_shader.m_alias, float4 {(float)outputWidth, (float)outputHeight, 1.0f / outputWidth, 1.0f / outputHeight}));
-                }
-                sourceWidth  = outputWidth;
-                sourceHeight = outputHeight;
-            }
-        }
+        m_preprocessPass.Resize(capturedTextureDesc.Width, capturedTextureDesc.Height, m_renderPlan.originalWidth, m_renderPlan.originalHeight, m_renderPlan.textureSizes, {});
 
         // call resize once all textureSizes are determined
+        const auto& passSizes = m_renderPlan.passSizes;
         for(int p = 0; p < m_shaderPasses.size(); p++)
         {
             auto& shaderPass = m_shaderPasses[p];
-            shaderPass.Resize(passSizes[p][0], passSizes[p][1], passSizes[p][2], passSizes[p][3], m_textureSizes, passSizes);
+            shaderPass.Resize(passSizes[p][0], passSizes[p][1], passSizes[p][2], passSizes[p][3], m_renderPlan.textureSizes, passSizes);
         }
     }
+    else if(outputResized)
+    {
+        // window still being resized, final pass renders the planned chain to the new swapchain buffer
+        const auto& passSizes = m_renderPlan.passSizes;
+        m_shaderPasses[finalPass].Resize(passSizes[finalPass][0], passSizes[finalPass][1], viewportWidth, viewportHeight, m_renderPlan.textureSizes, passSizes);
+        m_shaderPasses[finalPass].m_targetView = m_displayRenderTarget.get();
+    }
 
     if(rebuildPasses)
     {
         DestroyPasses();
 
+        m_passResources.resize(m_renderGraph.Slots().Count());
+        int t = 0;
         for(auto& pt : m_presetTextures)
         {
             // re-add static preset textures
-            m_passResources.insert(pt);
+            m_passResources[m_renderGraph.Slots().Texture(t++)] = pt.second;
         }
 
-        m_passResources.insert(std::make_pair("Original", m_originalView));
-
-        m_preprocessPass.m_targetView = m_preprocessedRenderTarget.get();
+        m_requiresHistory  = m_renderGraph.Slots().HistoryDepth();
+        m_requiresFeedback = m_renderGraph.Slots().RequiresFeedback();
+        m_dedicatedBytes   = m_renderPlan.dedicatedBytes;
+        m_aliasedBytes     = m_renderPlan.aliasedBytes;
         if(m_shaderPasses.size() > 1)
         {
-            D3D11_TEXTURE2D_DESC desc2 = {};
-            texture->GetDesc(&desc2);
-            desc2.Usage          = D3D11_USAGE_DEFAULT;
-            desc2.BindFlags      = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
-            desc2.CPUAccessFlags = 0;
-            desc2.MiscFlags      = 0;
+            const auto allocated = m_targetPool.Allocated();
+            const auto passBind  = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
 
-            for(const auto& pass : m_shaderPasses)
+            // intermediate outputs share targets where their lifetimes don't overlap
+            std::vector<PooledTarget> targets;
+            for(const auto& target : m_renderPlan.targets)
             {
-                m_requiresFeedback |= pass.RequiresFeedback();
-                m_requiresHistory = max(m_requiresHistory, pass.RequiresHistory());
+                targets.push_back(AcquireTarget(target.width, target.height, m_shaderPasses[target.firstPass].m_shader.m_format, passBind));
+                m_passTextures.push_back(targets.back());
             }
+#ifdef _DEBUG
+            std::ostringstream report;
+            size_t staticPasses = 0, elidedPasses = 0;
+            for(size_t p = 0; p < m_shaderPasses.size(); p++)
+            {
+                staticPasses += m_renderGraph.Static(p) ? 1 : 0;
+                elidedPasses += m_renderPlan.elided[p] ? 1 : 0;
+            }
+            report << "Pass targets: " << m_renderPlan.targets.size() << " for " << m_shaderPasses.size() - 1 << " passes, " << (m_renderPlan.dedicatedBytes >> 20)
+                   << " MB -> " << (m_renderPlan.aliasedBytes >> 20) << " MB, " << m_targetPool.Allocated() - allocated << " created, " << m_targetPool.Idle()
+                   << " idle in pool, " << staticPasses << " static, " << elidedPasses << " elided\n";
+            OutputDebugStringA(report.str().c_str());
+#endif
 
             for(size_t p = 1; p < m_shaderPasses.size(); p++)
             {
-                const auto& pass = m_shaderPasses[p - 1];
-
-                desc2.Format = pass.m_shader.m_format;
-
-                // use shader output size
-                desc2.Width     = pass.m_destWidth;
-                desc2.Height    = pass.m_destHeight;
-                desc2.BindFlags = D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET;
-
-                winrt::com_ptr<ID3D11Texture2D> passTexture;
-                hr = m_device->CreateTexture2D(&desc2, nullptr, passTexture.put());
-                assert(SUCCEEDED(hr));
-                m_passTextures.push_back(passTexture);
-
-                winrt::com_ptr<ID3D11RenderTargetView> passTarget;
-                hr = m_device->CreateRenderTargetView(passTexture.get(), nullptr, passTarget.put());
-                assert(SUCCEEDED(hr));
-                m_passTargets.push_back(passTarget);
-
-                winrt::com_ptr<ID3D11ShaderResourceView> passResource;
-                hr = m_device->CreateShaderResourceView(passTexture.get(), nullptr, passResource.put());
-                assert(SUCCEEDED(hr));
-                m_passResources.insert(std::make_pair(std::string("PassOutput") + std::to_string(p - 1), passResource));
-                if(!pass.m_shader.m_alias.empty())
+                if(m_renderPlan.passTargets[p - 1] < 0)
                 {
-                    m_passResources.insert(std::make_pair(pass.m_shader.m_alias, passResource));
+                    // elided passes hand on their source's output, the display pass has none
+                    winrt::com_ptr<ID3D11ShaderResourceView> forwarded;
+                    if(m_renderPlan.elided[p - 1])
+                        forwarded = m_passViews[p - 2];
+                    m_passTargets.push_back(nullptr);
+                    m_passResources[m_renderGraph.Slots().PassOutput((int)p - 1)] = forwarded;
+                    m_passViews.push_back(forwarded);
+                    m_feedbackTargets.push_back(nullptr);
+                    m_feedbackViews.push_back(nullptr);
+                    m_shaderPasses[p].m_sourceView = forwarded.get();
+                    continue;
                 }
 
-                // create feedback textures if needed
-                if(m_requiresFeedback)
+                const auto& passTarget = targets[m_renderPlan.passTargets[p - 1]];
+                m_passTargets.push_back(passTarget.target);
+                m_passResources[m_renderGraph.Slots().PassOutput((int)p - 1)] = passTarget.view;
+                m_passViews.push_back(passTarget.view);
+
+                // second target for passes read as feedback, the two swap roles every frame
+                PooledTarget feedbackTarget;
+                if(m_renderGraph.Slots().Feedback((int)p - 1))
                 {
-                    desc2.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-
-                    winrt::com_ptr<ID3D11Texture2D> feedbackTexture;
-                    hr = m_device->CreateTexture2D(&desc2, nullptr, feedbackTexture.put());
-                    assert(SUCCEEDED(hr));
-                    m_passTextures.push_back(feedbackTexture);
-                    winrt::com_ptr<ID3D11ShaderResourceView> feedbackResource;
-                    hr = m_device->CreateShaderResourceView(feedbackTexture.get(), nullptr, feedbackResource.put());
-                    assert(SUCCEEDED(hr));
-                    m_passResources.insert(std::make_pair(std::string("PassFeedback") + std::to_string(p - 1), feedbackResource));
-                    if(!pass.m_shader.m_alias.empty())
-                    {
-                        m_passResources.insert(std::make_pair(pass.m_shader.m_alias + "Feedback", feedbackResource));
-                    }
+                    feedbackTarget = AcquireTarget(passTarget.key.width, passTarget.key.height, m_shaderPasses[p - 1].m_shader.m_format, passBind);
+                    m_passTextures.push_back(feedbackTarget);
+                    m_passResources[m_renderGraph.Slots().PassFeedback((int)p - 1)] = feedbackTarget.view;
                 }
+                m_feedbackTargets.push_back(feedbackTarget.target);
+                m_feedbackViews.push_back(feedbackTarget.view);
 
-                m_shaderPasses[p - 1].m_targetView = passTarget.get();
-                m_shaderPasses[p].m_sourceView     = passResource.get();
-            }
-        }
-        else
-        {
-            m_requiresHistory = m_shaderPasses.begin()->RequiresHistory();
-        }
-
-        if(m_requiresHistory)
-        {
-            D3D11_TEXTURE2D_DESC desc2 = {};
-            texture->GetDesc(&desc2);
-            desc2.Usage          = D3D11_USAGE_DEFAULT;
-            desc2.BindFlags      = D3D11_BIND_SHADER_RESOURCE;
-            desc2.CPUAccessFlags = 0;
-            desc2.MiscFlags      = 0;
-            desc2.Width          = m_vertical ? originalHeight : originalWidth;
-            desc2.Height         = m_vertical ? originalWidth : originalHeight;
-
-            for(int h = 0; h < m_requiresHistory; h++)
-            {
-                winrt::com_ptr<ID3D11Texture2D> historyTexture;
-                hr = m_device->CreateTexture2D(&desc2, nullptr, historyTexture.put());
-                assert(SUCCEEDED(hr));
-                m_passTextures.push_back(historyTexture);
-                winrt::com_ptr<ID3D11ShaderResourceView> historyResource;
-                hr = m_device->CreateShaderResourceView(historyTexture.get(), nullptr, historyResource.put());
-                assert(SUCCEEDED(hr));
-                m_passResources.insert(std::make_pair(std::string("OriginalHistory") + std::to_string(h + 1), historyResource));
+                m_shaderPasses[p - 1].m_targetView = passTarget.target.get();
+                m_shaderPasses[p].m_sourceView     = passTarget.view.get();
             }
         }
 
-        m_shaderPasses[m_shaderPasses.size() - 1].m_targetView = m_displayRenderTarget.get();
+        m_shaderPasses[m_renderPlan.displayPass].m_targetView = m_displayRenderTarget.get();
+        if(foveated)
+            BuildFoveation(viewportWidth, viewportHeight);
 
-        if(m_requiresFeedback)
+        if(m_renderGraph.Slots().Feedback(finalPass))
         {
             // add feedback for last pass
-            int         p        = (int)m_shaderPasses.size() - 1;
-            const auto& lastPass = m_shaderPasses[p];
-
             D3D11_TEXTURE2D_DESC desc2 = {};
             m_displayTexture->GetDesc(&desc2);
-            desc2.Usage          = D3D11_USAGE_DEFAULT;
-            desc2.BindFlags      = D3D11_BIND_SHADER_RESOURCE;
-            desc2.CPUAccessFlags = 0;
-            desc2.MiscFlags      = 0;
-            desc2.Width          = lastPass.m_destWidth;
-            desc2.Height         = lastPass.m_destHeight;
-
-            winrt::com_ptr<ID3D11Texture2D> feedbackTexture;
-            hr = m_device->CreateTexture2D(&desc2, nullptr, feedbackTexture.put());
-            assert(SUCCEEDED(hr));
-            m_passTextures.push_back(feedbackTexture);
-            winrt::com_ptr<ID3D11ShaderResourceView> feedbackResource;
-            hr = m_device->CreateShaderResourceView(feedbackTexture.get(), nullptr, feedbackResource.put());
-            assert(SUCCEEDED(hr));
-            m_passResources.insert(std::make_pair(std::string("PassFeedback") + std::to_string(p), feedbackResource));
-            if(!lastPass.m_shader.m_alias.empty())
-            {
-                m_passResources.insert(std::make_pair(lastPass.m_shader.m_alias + "Feedback", feedbackResource));
-            }
+
+            auto feedbackTarget = AcquireTarget(m_shaderPasses[finalPass].m_destWidth, m_shaderPasses[finalPass].m_destHeight, desc2.Format, D3D11_BIND_SHADER_RESOURCE);
+            m_passTextures.push_back(feedbackTarget);
+            m_passResources[m_renderGraph.Slots().PassFeedback(finalPass)] = feedbackTarget.view;
         }
     }
 
-    if(outputMoved || outputResized || inputResized || (m_lastPos.x != topLeft.x || m_lastPos.y != topLeft.y) || m_lockedAreaUpdated)
+    const auto inputMoved = outputMoved || outputResized || inputResized || replan || (m_lastPos.x != topLeft.x || m_lastPos.y != topLeft.y) || m_lockedAreaUpdated;
+    if(inputMoved)
     {
         // preprocess captured frame to a texture: crop (via scale & translation), reduce resolution, and whatnot (invert y?)
         float sx = 1.0f, sy = 1.0f, tx = 0.0f, ty = 0.0f;
@@ -997,6 +1218,7 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
             sy *= -1.0f;
             ty *= -1.0f;
         }
+        m_inputIdentity = sx == 1.0f && sy == 1.0f && tx == 0.0f && ty == 0.0f;
 
         // offset to move away from edges; needed for SG to consistently pick up n-th input pixel if asked to, but I should find a formula to calculate this
         tx += 0.0001f;
@@ -1007,107 +1229,264 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
         m_lastPos.y = topLeft.y;
     }
 
-    if(m_captureWindow && !m_clone)
+    // emulated cursor is drawn over the input
+    CURSORINFO ci {.cbSize = sizeof(CURSORINFO)};
+    const auto cursorDrawn = m_cursorEmulator.Hidden() && GetCursorInfo(&ci);
+    const auto cursorMoved = cursorDrawn != m_cursorDrawn ||
+                             (cursorDrawn && (ci.ptScreenPos.x != m_cursorPos.x || ci.ptScreenPos.y != m_cursorPos.y || ci.hCursor != m_cursorHandle));
+
+    // passes with new parameters and whatever depends on them
+    std::vector<bool> changed;
+    for(const auto& shaderPass : m_shaderPasses)
+        changed.push_back(!shaderPass.m_shader.Dirty(UBO_BUFFER).Empty() || !shaderPass.m_shader.Dirty(PUSH_BUFFER).Empty());
+    auto renderPasses = m_renderGraph.Invalidate(m_renderPlan, changed);
+
+    // captured texture covers the output 1:1 and preprocess would only downscale it, which
+    // pass 0 does just the same by point-sampling it at the downscaled texel centres
+    // pass 0; foveated chains render from the preprocessed input
+    const auto fused = m_renderGraph.FuseInput(m_inputIdentity, cursorDrawn, m_vertical, foveated);
+
+    // nothing in the chain animates and its input is the same, what's on display is still current but for those;
+    // the fovea follows the gaze over targets that hold only a part of the output
+    const auto partial = m_staticChain && inputFrameNo == m_renderedInputFrameNo && !inputMoved && !rebuildPasses && !cursorMoved && fused == m_inputFused && !foveated;
+    if(partial && std::find(renderPasses.begin(), renderPasses.end(), true) == renderPasses.end())
+        return;
+
+    // mid-saccade the last frame stays on display unless it has moved or the passes were rebuilt;
+    // foveated frames render the periphery alone instead
+    if(tier == RenderTier::Saccade && !foveated && !inputMoved && !rebuildPasses)
+        return;
+    if(!partial)
+    {
+        // static passes render once into their own targets, then only when invalidated
+        for(size_t p = 0; p < renderPasses.size(); p++)
+            renderPasses[p] = renderPasses[p] || rebuildPasses || !m_renderGraph.Static(p);
+    }
+
+    // preprocess renders into the current history slot, older slots become OriginalHistoryN
+    m_preprocessedTexture         = m_originalTargets[m_historyRing.Current()].texture;
+    m_preprocessedRenderTarget    = m_originalTargets[m_historyRing.Current()].target;
+    m_originalView                = m_originalTargets[m_historyRing.Current()].view;
+    m_preprocessPass.m_targetView = m_preprocessedRenderTarget.get();
+    for(int h = 0; h < m_historyRing.Size(); h++)
+    {
+        m_passResources[m_renderGraph.Slots().History(h)] = m_originalTargets[m_historyRing.Frame(h)].view;
+        if(foveated)
+            m_peripheryResources[m_renderGraph.Slots().History(h)] = m_originalTargets[m_historyRing.Frame(h)].view;
+    }
+
+    if(m_captureWindow && !m_clone && !partial && !fused)
     {
         // clear any blanks around captured window
         m_context->ClearRenderTargetView(m_preprocessedRenderTarget.get(), background_colour);
     }
 
-    winrt::com_ptr<ID3D11ShaderResourceView> textureView;
-    hr = m_device->CreateShaderResourceView(texture.get(), nullptr, textureView.put());
-    assert(SUCCEEDED(hr));
-    m_preprocessPass.Render(textureView.get(), m_passResources, logicalFrameNo, 0, 0);
+    if(m_inputViewsInvalidated)
+    {
+        m_inputViewsInvalidated = false;
+        m_inputViews.Clear();
+    }
+    const auto textureView = m_inputViews.Get({texture.get(), capturedTextureDesc.Width, capturedTextureDesc.Height, static_cast<uint32_t>(capturedTextureDesc.Format)}, texture);
+    m_uniformArena.ring.BeginFrame();
+    if(!partial && !fused)
+    {
+        // partial frames reuse the preprocessed input, fused ones have none
+        m_preprocessPass.Render(textureView.get(), m_passResources, logicalFrameNo, 0, 0);
+    }
 
-    if(m_cursorEmulator.Hidden())
+    FoveaRect cursorTile {};
+    if(cursorDrawn && !partial)
     {
-        CURSORINFO ci {.cbSize = sizeof(CURSORINFO)};
-        if(GetCursorInfo(&ci))
+        auto mx = ci.ptScreenPos.x;
+        auto my = ci.ptScreenPos.y;
+
+        if(!m_clone)
         {
-            auto mx = ci.ptScreenPos.x;
-            auto my = ci.ptScreenPos.y;
-            
-            if(!m_clone)
-            {
-                // glass
-                mx -= m_monitorOffset.x;
-                my -= m_monitorOffset.y;
+            // glass
+            mx -= m_monitorOffset.x;
+            my -= m_monitorOffset.y;
+
+            mx -= topLeft.x;
+            my -= topLeft.y;
+        }
+        else if(m_captureWindow)
+        {
+            mx -= captureTopLeft.x;
+            my -= captureTopLeft.y;
+        }
+
+        auto cursor = m_cursorEmulator.GetCursor();
+        if(cursor && cursor->image)
+        {
+            mx -= cursor->hotSpotX;
+            my -= cursor->hotSpotY;
 
-                mx -= topLeft.x;
-                my -= topLeft.y;
+            float cx, cy, cw, ch;
+
+            if(m_vertical)
+            {
+                cx = m_preprocessPass.m_destWidth - (my + cursor->w) / m_inputScaleW;
+                cy = m_preprocessPass.m_destHeight - (mx + cursor->h) / m_inputScaleH;
+                cw = cursor->w / m_inputScaleW;
+                ch = cursor->h / m_inputScaleH;
             }
-            else if(m_captureWindow)
+            else
             {
-                mx -= captureTopLeft.x;
-                my -= captureTopLeft.y;
+                cx = mx / m_inputScaleW;
+                cy = my / m_inputScaleH;
+                cw = cursor->w / m_inputScaleW;
+                ch = cursor->h / m_inputScaleH;
             }
+            m_preprocessPass.RenderCursor(cx, cy, cw, ch, cursor->view);
 
-            auto cursor = m_cursorEmulator.GetCursor();
-            if(cursor && cursor->image)
+            if(foveated)
             {
-                mx -= cursor->hotSpotX;
-                my -= cursor->hotSpotY;
+                // on the periphery output, with the reach of the passes around it
+                const auto& peripherySize = m_peripheryPlan.passSizes[m_peripheryPlan.displayPass];
+                const auto  sx            = peripherySize[2] / (float)m_preprocessPass.m_destWidth;
+                const auto  sy            = peripherySize[3] / (float)m_preprocessPass.m_destHeight;
+                const auto  margin        = m_foveaSettings.margin;
+                cursorTile                = {static_cast<int>(std::floor(cx * sx)) - margin,
+                                             static_cast<int>(std::floor(cy * sy)) - margin,
+                                             static_cast<int>(std::ceil((cx + cw) * sx)) + margin,
+                                             static_cast<int>(std::ceil((cy + ch) * sy)) + margin};
+            }
+        }
+    }
 
-                float cx, cy, cw, ch;
+    if(m_requiresFeedback)
+    {
+        // last frame's output becomes feedback
+        for(size_t q = 0; q < m_feedbackTargets.size(); q++)
+        {
+            if(!m_feedbackTargets[q])
+                continue;
 
-                if(m_vertical)
-                {
-                    cx = m_preprocessPass.m_destWidth - (my + cursor->w) / m_inputScaleW;
-                    cy = m_preprocessPass.m_destHeight - (mx + cursor->h) / m_inputScaleH;
-                    cw = cursor->w / m_inputScaleW;
-                    ch = cursor->h / m_inputScaleH;
-                }
-                else
-                {
-                    cx = mx / m_inputScaleW;
-                    cy = my / m_inputScaleH;
-                    cw = cursor->w / m_inputScaleW;
-                    ch = cursor->h / m_inputScaleH;
-                }
-                m_preprocessPass.RenderCursor(cx, cy, cw, ch, cursor->view);
-            }
+            const auto& target   = m_feedbackSwapped ? m_feedbackTargets[q] : m_passTargets[q];
+            const auto& output   = m_feedbackSwapped ? m_feedbackViews[q] : m_passViews[q];
+            const auto& feedback = m_feedbackSwapped ? m_passViews[q] : m_feedbackViews[q];
+
+            m_shaderPasses[q].m_targetView                        = target.get();
+            m_shaderPasses[q + 1].m_sourceView                    = output.get();
+            m_passResources[m_renderGraph.Slots().PassOutput((int)q)]   = output;
+            m_passResources[m_renderGraph.Slots().PassFeedback((int)q)] = feedback;
         }
+        m_feedbackSwapped = !m_feedbackSwapped;
     }
 
-    int p = 0;
-    for(auto& shaderPass : m_shaderPasses)
+    if(foveated)
     {
-        auto passBoxX = p == m_shaderPasses.size() - 1 ? m_boxX : 0;
-        auto passBoxY = p == m_shaderPasses.size() - 1 ? m_boxY : 0;
+        // whole periphery at reduced scale, then the passes at full resolution only as far as
+        // the fovea needs them, blended onto the display
+        m_foveaPlan = Foveation::Plan(m_renderPlan.passSizes, viewportWidth, viewportHeight, m_gazePosition.first, m_gazePosition.second, m_foveaSettings);
 
-        if(p == 0)
+        BindChain(m_peripheryPlan, m_peripheryTargets, m_peripheryViews, m_peripheryOutput.get());
+        if(m_tileScheduler.Settings().Temporal())
         {
-            shaderPass.Render(m_originalView.get(), m_passResources, logicalFrameNo, passBoxX, passBoxY);
+            // the periphery output holds its tiles from earlier frames, only those due, damaged
+            // or around where a saccade landed render again
+            if(rebuildPasses || inputMoved || m_paramsUpdated)
+                m_tileScheduler.Invalidate();
+            m_paramsUpdated = false;
+            if(cursorTile != m_cursorTile)
+            {
+                m_tileScheduler.Damage(m_cursorTile);
+                m_tileScheduler.Damage(cursorTile);
+            }
+            m_cursorTile = cursorTile;
+
+            const auto& schedule = m_tileScheduler.Schedule(m_gazePosition.first, m_gazePosition.second);
+            if(schedule.full)
+            {
+                RenderChain(m_peripheryPlan, m_originalView.get(), m_peripheryResources, logicalFrameNo, nullptr);
+            }
+            else if(!schedule.rects.empty())
+            {
+                // every pass covers the runs of tiles and what the next pass samples around them
+                const auto& peripherySize = m_peripheryPlan.passSizes[m_peripheryPlan.displayPass];
+                m_tileScissors.assign(m_peripheryPlan.passSizes.size(), {});
+                for(const auto& rect : schedule.rects)
+                {
+                    const auto scissors = Foveation::Scissors(m_peripheryPlan.passSizes,
+                                                              {rect.left / (float)peripherySize[2],
+                                                               rect.top / (float)peripherySize[3],
+                                                               rect.right / (float)peripherySize[2],
+                                                               rect.bottom / (float)peripherySize[3]},
+                                                              m_foveaSettings.margin);
+                    for(size_t p = 0; p < scissors.size(); p++)
+                        m_tileScissors[p].push_back(scissors[p]);
+                }
+                m_context->RSSetState(m_scissorState.get());
+                RenderChain(m_peripheryPlan, m_originalView.get(), m_peripheryResources, logicalFrameNo, &m_tileScissors);
+                m_context->RSSetState(m_rasterizerState.get());
+            }
         }
         else
         {
-            shaderPass.Render(m_passResources, logicalFrameNo, passBoxX, passBoxY);
+            RenderChain(m_peripheryPlan, m_originalView.get(), m_peripheryResources, logicalFrameNo, nullptr);
         }
-        p++;
-    }
 
-    if(m_requiresFeedback)
+        float bounds[4] = {m_foveaPlan.bounds[0], m_foveaPlan.bounds[1], m_foveaPlan.bounds[2], m_foveaPlan.bounds[3]};
+        if(tier == RenderTier::Saccade)
+        {
+            // no fovea to blend in, its bounds fall outside the output
+            bounds[0] = bounds[1] = 2.0f;
+            bounds[2] = bounds[3] = -1.0f;
+        }
+        else
+        {
+            BindChain(m_renderPlan, m_passTargets, m_passViews, m_foveaOutput.get());
+            m_foveaScissors.assign(m_foveaPlan.scissors.size(), {});
+            for(size_t p = 0; p < m_foveaPlan.scissors.size(); p++)
+                m_foveaScissors[p].push_back(m_foveaPlan.scissors[p]);
+            m_context->RSSetState(m_scissorState.get());
+            RenderChain(m_renderPlan, m_originalView.get(), m_passResources, logicalFrameNo, &m_foveaScissors);
+            m_context->RSSetState(m_rasterizerState.get());
+        }
+
+        float feather[4] = {m_foveaPlan.feather[0], m_foveaPlan.feather[1], 0, 0};
+        m_compositeShader.SetParam("FoveaBounds", bounds);
+        m_compositeShader.SetParam("FoveaFeather", feather);
+        m_compositePass.Render(m_compositeResources, logicalFrameNo, m_boxX, m_boxY);
+    }
+    else
     {
-        // copy output to feedback
-        for(size_t q = 0; q < m_shaderPasses.size() - 1; q++)
+        int p = 0;
+        for(auto& shaderPass : m_shaderPasses)
         {
-            auto                           passOutput   = m_passResources.find(std::string("PassOutput") + std::to_string(q));
-            auto                           passFeedback = m_passResources.find(std::string("PassFeedback") + std::to_string(q));
-            winrt::com_ptr<ID3D11Resource> outputResource;
-            winrt::com_ptr<ID3D11Resource> feedbackResource;
-            passOutput->second->GetResource(outputResource.put());
-            passFeedback->second->GetResource(feedbackResource.put());
-            m_context->CopyResource(feedbackResource.get(), outputResource.get());
+            if(!renderPasses[p] || m_renderPlan.elided[p])
+            {
+                // output of an earlier frame still holds, or of the source
+                p++;
+                continue;
+            }
+
+            auto passBoxX = p == m_renderPlan.displayPass ? m_boxX : 0;
+            auto passBoxY = p == m_renderPlan.displayPass ? m_boxY : 0;
+
+            if(p == 0)
+            {
+                shaderPass.Render(fused ? textureView.get() : m_originalView.get(), m_passResources, logicalFrameNo, passBoxX, passBoxY);
+            }
+            else
+            {
+                shaderPass.Render(m_passResources, logicalFrameNo, passBoxX, passBoxY);
+            }
+            p++;
         }
+    }
 
+    if(m_renderGraph.Slots().Feedback((int)m_shaderPasses.size() - 1))
+    {
         // copy display texture as last pass feedback
         auto displayTexture = m_displayTexture;
         if(displayTexture)
         {
             int                            p                = (int)m_shaderPasses.size() - 1;
             const auto&                    lastPass         = m_shaderPasses[p];
-            auto                           lastPassFeedback = m_passResources.find(std::string("PassFeedback") + std::to_string(p));
+            const auto&                    lastPassFeedback = m_passResources[m_renderGraph.Slots().PassFeedback(p)];
             winrt::com_ptr<ID3D11Resource> lastPassFeedbackResource;
-            lastPassFeedback->second->GetResource(lastPassFeedbackResource.put());
+            lastPassFeedback->GetResource(lastPassFeedbackResource.put());
             D3D11_TEXTURE2D_DESC desc3 = {};
             displayTexture->GetDesc(&desc3);
             if(m_boxX != 0 || m_boxY != 0 || lastPass.m_destWidth != desc3.Width || lastPass.m_destHeight != desc3.Height)
@@ -1128,34 +1507,23 @@ void ShaderGlass::Process(winrt::com_ptr<ID3D11Texture2D> texture, ULONGLONG fra
         }
     }
 
-    if(m_requiresHistory)
-    {
-        // lookup oldest History for reuse
-        const auto&                    lastHistory     = m_passResources.find(std::string("OriginalHistory" + std::to_string(m_requiresHistory)));
-        auto                           lastHistoryView = lastHistory->second;
-        winrt::com_ptr<ID3D11Resource> lastHistoryResource;
-        lastHistoryView->GetResource(lastHistoryResource.put());
+    m_historyRing.Advance();
+    m_uniformBytes         = m_uniformArena.ring.FrameBytes();
+    m_renderedInputFrameNo = inputFrameNo;
+    m_inputFused           = fused;
+    m_cursorDrawn          = cursorDrawn;
+    m_cursorPos            = ci.ptScreenPos;
+    m_cursorHandle         = ci.hCursor;
 
-        for(int h = m_requiresHistory; h > 1; h--)
-        {
-            // remap middle Histories one frame back
-            m_passResources[std::string("OriginalHistory" + std::to_string(h))] = m_passResources[std::string("OriginalHistory" + std::to_string(h - 1))];
-        }
-
-        // copy current Original to History1 for next pass
-        const auto&                    original = m_passResources.find("Original");
-        winrt::com_ptr<ID3D11Resource> originalResource;
-        original->second->GetResource(originalResource.put());
+    PresentFrame();
 
-        m_context->CopyResource(lastHistoryResource.get(), originalResource.get());
-        if(m_requiresHistory > 1)
-        {
-            m_passResources["OriginalHistory1"] = lastHistoryView;
-        }
+    if(m_gazeBoundAt)
+    {
+        const auto presentLatency = static_cast<float>(GazeSample::Now() - m_gazeBoundAt);
+        m_presentLatency          = m_presentLatency ? m_presentLatency * 0.9f + presentLatency * 0.1f : presentLatency;
+        m_gazeBoundAt             = 0;
     }
 
-    PresentFrame();
-
     m_renderCounter++;
     m_prevRenderTicks = GetTickCount64();
     if(m_prevRenderTicks - m_prevTicks > 1000)
@@ -1228,3 +1596,8 @@ void ShaderGlass::Stop()
 {
     m_running = false;
 }
+
+void ShaderGlass::InvalidateInputViews()
+{
+    m_inputViewsInvalidated = true;
+}
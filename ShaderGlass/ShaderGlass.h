@@ -9,16 +9,36 @@ GNU General Public License v3.0
 
 #include "Preset.h"
 #include "ShaderPass.h"
+#include "HistoryRing.h"
+#include "TargetPool.h"
+#include "ViewCache.h"
+#include "GazeSource.h"
+#include "GazeFilter.h"
+#include "Foveation.h"
+#include "TileScheduler.h"
+#include "SaccadeDetector.h"
 #include "Shaders\PreprocessShaderDef.h"
 #include "Shaders\PassthroughShaderDef.h"
 #include "Shaders\PassthroughPresetDef.h"
+#include "Shaders\FoveaCompositeShaderDef.h"
 
 class CursorEmulator;
 
+// texture leased from the target pool with its views, either may be null if not bound
+struct PooledTarget
+{
+    TargetKey                                key;
+    winrt::com_ptr<ID3D11Texture2D>          texture;
+    winrt::com_ptr<ID3D11RenderTargetView>   target;
+    winrt::com_ptr<ID3D11ShaderResourceView> view;
+};
+
+using InputViewCache = ViewCache<winrt::com_ptr<ID3D11Texture2D>, winrt::com_ptr<ID3D11ShaderResourceView>>;
+
 class ShaderGlass
 {
 public:
-    ShaderGlass(CursorEmulator& cursorEmulator);
+    ShaderGlass(CursorEmulator& cursorEmulator, GazeSource& gazeSource);
     void  Initialize(HWND                                outputWindow,
                      HWND                                captureWindow,
                      HMONITOR                            captureMonitor,
@@ -39,16 +59,35 @@ public:
     void  SetCroppedArea(RECT area);
     void  SetFreeScale(bool freeScale);
     void  SetVertical(bool vertical);
+    void  SetGazeBinding(const GazeBinding& binding);
+    void  SetGazeFilter(const GazeFilterSettings& settings);
+    void  SetFoveation(const FoveaSettings& settings);
+    void  SetTileRefresh(const TileSettings& settings);
+    void  SetSaccadeBudget(const SaccadeSettings& settings);
     float FPS()
     {
         return m_fps;
     }
+    size_t UniformBytes()
+    {
+        return m_uniformBytes;
+    }
+    float GazeLatency()
+    {
+        return m_gazeLatency;
+    }
+    // intermediate targets with one per pass, and as allocated with aliasing
+    std::pair<uint64_t, uint64_t> TargetBytes()
+    {
+        return {m_dedicatedBytes, m_aliasedBytes};
+    }
     winrt::com_ptr<ID3D11Texture2D>            GrabOutput();
     std::vector<std::tuple<int, ShaderParam*>> Params();
     void                                       UpdateParams();
     void                                       ResetParams();
     float                                      GetDefaultValue(ShaderParam* p);
     void                                       Stop();
+    void                                       InvalidateInputViews();
     ~ShaderGlass();
 
 private:
@@ -58,7 +97,13 @@ private:
     void DestroyPasses();
     void DestroyTargets();
     void RebuildShaders();
+    void ApplyParams(bool reset);
+    PooledTarget AcquireTarget(UINT width, UINT height, DXGI_FORMAT format, UINT bindFlags);
     void PresentFrame();
+    void BindGaze(LONG left, LONG top, UINT width, UINT height);
+    void BuildFoveation(UINT width, UINT height);
+    void BindChain(const RenderPlan& plan, const std::vector<winrt::com_ptr<ID3D11RenderTargetView>>& targets, const std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>& views, ID3D11RenderTargetView* output);
+    void RenderChain(const RenderPlan& plan, ID3D11ShaderResourceView* originalView, const std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>& resources, int frameNo, const std::vector<std::vector<FoveaRect>>* scissors);
 
     POINT                                    m_lastSize;
     POINT                                    m_lastPos;
@@ -70,17 +115,34 @@ private:
     winrt::com_ptr<IDXGISwapChain1>          m_swapChain {nullptr};
     winrt::com_ptr<IDXGISwapChain3>          m_swapChain3 {nullptr};
     winrt::com_ptr<ID3D11RasterizerState>    m_rasterizerState {nullptr};
+    winrt::com_ptr<ID3D11RasterizerState>    m_scissorState {nullptr};
     winrt::com_ptr<ID3D11Texture2D>          m_displayTexture {nullptr};
     winrt::com_ptr<ID3D11RenderTargetView>   m_displayRenderTarget {nullptr};
     winrt::com_ptr<ID3D11Texture2D>          m_preprocessedTexture {nullptr};
     winrt::com_ptr<ID3D11RenderTargetView>   m_preprocessedRenderTarget {nullptr};
+    HistoryRing                              m_historyRing {};
 
-    std::vector<winrt::com_ptr<ID3D11Texture2D>>                    m_passTextures;
+    TargetPool<PooledTarget>                                        m_targetPool;
+    ResizeHysteresis                                                m_resizeHysteresis;
+    std::vector<PooledTarget>                                       m_originalTargets; // m_historyRing slots
+    std::vector<PooledTarget>                                       m_passTextures;    // everything leased for m_renderPlan
+    InputViewCache                                                  m_inputViews;
     std::vector<winrt::com_ptr<ID3D11RenderTargetView>>             m_passTargets;
-    std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>> m_passResources;
+    std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>           m_passViews;
+    std::vector<winrt::com_ptr<ID3D11RenderTargetView>>             m_feedbackTargets; // ping-pong partner of m_passTargets, if sampled
+    std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>           m_feedbackViews;
+    std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>           m_passResources; // indexed by m_renderGraph slots
     std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>> m_presetTextures;
-    std::map<std::string, float4>                                   m_textureSizes;
     std::vector<ShaderPass>                                         m_shaderPasses;
+    RenderGraph                                                     m_renderGraph;
+    RenderPlan                                                      m_renderPlan;
+    RenderPlan                                                      m_peripheryPlan; // m_renderPlan at reduced scale, while foveated
+    std::vector<winrt::com_ptr<ID3D11RenderTargetView>>             m_peripheryTargets;
+    std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>           m_peripheryViews;
+    std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>           m_peripheryResources;
+    winrt::com_ptr<ID3D11RenderTargetView>                          m_peripheryOutput;
+    winrt::com_ptr<ID3D11RenderTargetView>                          m_foveaOutput;
+    std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>           m_compositeResources; // fovea output
 
     POINT      m_monitorOffset {0, 0};
     HWND       m_outputWindow {0};
@@ -100,23 +162,60 @@ private:
     ULONGLONG  m_prevFrameTicks {0};
     int        m_prevInputFrameNo {0};
     int        m_prevLogicalFrameNo {0};
+    int        m_renderedInputFrameNo {-1}; // on display, re-presented as is while m_staticChain
+    bool       m_staticChain {false};       // no pass changes its output without new input
+    bool       m_inputIdentity {false};     // preprocess maps captured texels 1:1 to the output
+    bool       m_inputFused {false};        // pass 0 sampled the captured texture directly
+    bool       m_cursorDrawn {false};
+    POINT      m_cursorPos {0, 0};
+    HCURSOR    m_cursorHandle {0};
     float      m_fps {0};
+    size_t     m_uniformBytes {0}; // uploaded last frame
+    uint64_t   m_dedicatedBytes {0};
+    uint64_t   m_aliasedBytes {0};
     bool       m_requiresFeedback {false};
+    bool       m_feedbackSwapped {false};
     int        m_requiresHistory {0};
     std::mutex m_mutex {};
     int        m_boxX {0};
     int        m_boxY {0};
 
-    CursorEmulator&                                   m_cursorEmulator;
-    PassthroughPresetDef                              m_passthroughDef;
-    PreprocessShaderDef                               m_preprocessShaderDef;
-    PresetDef                                         m_preprocessPresetDef;
-    Preset                                            m_preprocessPreset;
-    Shader                                            m_preprocessShader;
-    ShaderPass                                        m_preprocessPass;
-    std::unique_ptr<Preset>                           m_shaderPreset {nullptr};
-    std::unique_ptr<Preset>                           m_newShaderPreset {nullptr};
-    std::vector<std::tuple<int, std::string, double>> m_newParams;
+    CursorEmulator&                                          m_cursorEmulator;
+    GazeSource&                                              m_gazeSource;
+    GazeBinding                                              m_gazeBinding;
+    std::vector<std::tuple<int, ShaderParam*, ShaderParam*>> m_gazeParams; // shader and its x/y params, either may be null
+    std::vector<GazeSample>                                  m_gazeSamples;
+    GazeFilter                                               m_gazeFilter;
+    SaccadeDetector                                          m_saccadeDetector;
+    RenderBudget                                             m_renderBudget;
+    GazeSample                                               m_gaze;
+    int64_t                                                  m_gazeBoundAt {0};    // this frame's gaze was predicted, 0 once presented
+    float                                                    m_presentLatency {0}; // us from binding gaze to present, smoothed
+    bool                                                     m_gazeReceived {false};
+    float                                                    m_gazeLatency {0}; // ms from sample to uniform, smoothed
+    std::pair<float, float>                                  m_gazePosition {0.5f, 0.5f}; // on the output, normalized
+    FoveaSettings                                            m_foveaSettings;
+    FoveaPlan                                                m_foveaPlan;
+    bool                                                     m_foveable {false}; // gaze and settings allow foveation
+    bool                                                     m_foveated {false}; // fovea and periphery render separately
+    TileScheduler                                            m_tileScheduler;    // of the periphery output
+    std::vector<std::vector<FoveaRect>>                      m_tileScissors;     // of every periphery pass, a rect per run of tiles
+    std::vector<std::vector<FoveaRect>>                      m_foveaScissors;    // m_foveaPlan's, one a pass
+    FoveaRect                                                m_cursorTile;       // where the cursor was drawn on the periphery output
+    PassthroughPresetDef                                     m_passthroughDef;
+    PreprocessShaderDef                                      m_preprocessShaderDef;
+    PresetDef                                                m_preprocessPresetDef;
+    Preset                                                   m_preprocessPreset;
+    Shader                                                   m_preprocessShader;
+    ShaderPass                                               m_preprocessPass;
+    Shader                                                   m_rotateShader; // preprocess shader for the vertical pass, uniforms differ
+    FoveaCompositeShaderDef                                  m_compositeShaderDef;
+    Shader                                                   m_compositeShader;
+    ShaderPass                                               m_compositePass;
+    UniformArena                                             m_uniformArena;
+    std::unique_ptr<Preset>                                  m_shaderPreset {nullptr};
+    std::unique_ptr<Preset>                                  m_newShaderPreset {nullptr};
+    std::vector<std::tuple<int, std::string, double>>        m_newParams;
 
     volatile int   m_frameSkip {0};
     volatile bool  m_running {false};
@@ -135,4 +234,9 @@ private:
     volatile bool  m_croppedAreaUpdated {false};
     volatile bool  m_vertical {false};
     volatile bool  m_verticalUpdated {false};
+    volatile bool  m_inputViewsInvalidated {false};
+    volatile bool  m_paramsUpdated {false}; // written into the shaders since the last frame
+
+    std::atomic<bool> m_paramsChanged {false}; // by the UI, not yet written into the shaders
+    std::atomic<bool> m_paramsReset {false};
 };
@@ -16,7 +16,34 @@ GNU General Public License v3.0
 
 std::vector<PresetDef*> RetroArchPresetList = RetroArch::PresetList;
 
+// when present, a pack built with ShaderGen -pack replaces the embedded library
+static ShaderPack sShaderPack;
+
+bool OpenShaderPack(const std::filesystem::path& path)
+{
+    try
+    {
+        sShaderPack.Open(path);
+        return true;
+    }
+    catch(std::runtime_error&)
+    {
+        return false;
+    }
+}
+
+std::vector<PresetDef*> RetroArchPresets()
+{
+    if(sShaderPack.IsOpen())
+        return sShaderPack.Presets();
+
+    return RetroArchPresetList;
+}
+
 std::vector<CachedShader> RetroArchCachedShaders()
 {
+    if(sShaderPack.IsOpen())
+        return sShaderPack.CachedShaders();
+
     return RetroArch::CachedShaders();
 }
\ No newline at end of file
@@ -11,6 +11,7 @@ GNU General Public License v3.0
 #include "TextureDef.h"
 #include "PresetDef.h"
 #include "ShaderCache.h"
+#include "ShaderPack.h"
 
 #include "shaders\PassthroughShaderDef.h"
 #include "shaders\PreprocessShaderDef.h"
@@ -18,4 +19,6 @@ GNU General Public License v3.0
 #include "shaders\PassthroughPresetDef.h"
 
 extern std::vector<PresetDef*> RetroArchPresetList;
-extern std::vector<CachedShader> RetroArchCachedShaders();
\ No newline at end of file
+extern std::vector<CachedShader> RetroArchCachedShaders();
+extern std::vector<PresetDef*> RetroArchPresets();
+extern bool OpenShaderPack(const std::filesystem::path& path);
\ No newline at end of file
@@ -10,7 +10,8 @@ GNU General Public License v3.0
 #include "ShaderPass.h"
 #include "Helpers.h"
 
-static HRESULT hr;
+static HRESULT                         hr;
+static ID3D11ShaderResourceView* const sNullViews[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT] = {};
 
 ShaderPass::ShaderPass(Shader& shader, Preset& preset, bool preprocess) : m_shader {shader}, m_preset {preset}, m_preprocess {preprocess} { }
 
@@ -127,13 +128,17 @@ void ShaderPass::Initialize(winrt::com_ptr<ID3D11Device> device, winrt::com_ptr<
         m_samplers.insert(std::make_pair(texture.binding, samplerState));
     }
 
+    // params changed since the last upload are copied alone where the driver allows it
+    D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+    if(SUCCEEDED(m_device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) && options.ConstantBufferPartialUpdate)
+        m_partialContext = m_context.try_as<ID3D11DeviceContext1>();
+
     if(m_shader.BufferSize(0) > 0)
     {
         D3D11_BUFFER_DESC constantBufferDesc = {};
         constantBufferDesc.ByteWidth         = (m_shader.BufferSize(0) + 0xf) & 0xfffffff0;
-        constantBufferDesc.Usage             = D3D11_USAGE_DYNAMIC;
+        constantBufferDesc.Usage             = D3D11_USAGE_DEFAULT;
         constantBufferDesc.BindFlags         = D3D11_BIND_CONSTANT_BUFFER;
-        constantBufferDesc.CPUAccessFlags    = D3D11_CPU_ACCESS_WRITE;
 
         hr = m_device->CreateBuffer(&constantBufferDesc, nullptr, m_constantBuffer.put());
         assert(SUCCEEDED(hr));
@@ -147,9 +152,8 @@ void ShaderPass::Initialize(winrt::com_ptr<ID3D11Device> device, winrt::com_ptr<
     {
         D3D11_BUFFER_DESC pushBufferDesc = {};
         pushBufferDesc.ByteWidth         = (m_shader.BufferSize(-1) + 0xf) & 0xfffffff0;
-        pushBufferDesc.Usage             = D3D11_USAGE_DYNAMIC;
+        pushBufferDesc.Usage             = D3D11_USAGE_DEFAULT;
         pushBufferDesc.BindFlags         = D3D11_BIND_CONSTANT_BUFFER;
-        pushBufferDesc.CPUAccessFlags    = D3D11_CPU_ACCESS_WRITE;
 
         hr = m_device->CreateBuffer(&pushBufferDesc, nullptr, m_pushBuffer.put());
         assert(SUCCEEDED(hr));
@@ -159,6 +163,9 @@ void ShaderPass::Initialize(winrt::com_ptr<ID3D11Device> device, winrt::com_ptr<
         m_pushBuffer = nullptr;
     }
 
+    // new buffers hold nothing yet
+    m_shader.Invalidate();
+
     // create MVP
     memset(&m_modelViewProj, 0, 16 * sizeof(float));
     m_modelViewProj.m[0][0] = 2.0f;
@@ -211,6 +218,18 @@ void ShaderPass::UpdateMVP(float sx, float sy, float tx, float ty)
     m_modelViewProj.m[3][1] = ty;
 }
 
+void ShaderPass::SetTransposed(bool transposed)
+{
+    // swapping x and y of the output position is what the vertical rotation pass did,
+    // the pass keeps seeing its output size in rotated space
+    if(transposed != m_transposed)
+    {
+        for(int i = 0; i < 4; i++)
+            std::swap(m_modelViewProj.m[i][0], m_modelViewProj.m[i][1]);
+        m_transposed = transposed;
+    }
+}
+
 ShaderPass::~ShaderPass()
 {
     m_inputLayout    = nullptr;
@@ -220,8 +239,7 @@ ShaderPass::~ShaderPass()
     m_samplers.clear();
 }
 
-void ShaderPass::Resize(
-    int sourceWidth, int sourceHeight, int destWidth, int destHeight, const std::map<std::string, float4>& textureSizes, const std::vector<std::array<UINT, 4>>& passSizes)
+void ShaderPass::Resize(int sourceWidth, int sourceHeight, int destWidth, int destHeight, const std::map<std::string, TextureSize>& textureSizes, const std::vector<PassSize>& passSizes)
 {
     m_destWidth  = destWidth;
     m_destHeight = destHeight;
@@ -230,62 +248,165 @@ void ShaderPass::Resize(
     params_SourceSize[1] = static_cast<float>(sourceHeight);
     params_SourceSize[2] = 1.0f / sourceWidth;
     params_SourceSize[3] = 1.0f / sourceHeight;
+    if(m_transposed)
+        std::swap(destWidth, destHeight);
     params_OutputSize[0] = static_cast<float>(destWidth);
     params_OutputSize[1] = static_cast<float>(destHeight);
     params_OutputSize[2] = 1.0f / destWidth;
     params_OutputSize[3] = 1.0f / destHeight;
-    m_shader.SetParam("SourceSize", params_SourceSize);
-    m_shader.SetParam("OutputSize", params_OutputSize);
+    m_shader.SetParam(m_shader.Slots().SourceSize(), params_SourceSize);
+    m_shader.SetParam(m_shader.Slots().OutputSize(), params_OutputSize);
 
-    for(const auto& tx : textureSizes)
+    // only look up sizes the shader actually declares
+    for(const auto& ts : m_shader.Slots().TextureSizes())
     {
-        auto sizeParam = tx.first + "Size";
-        m_shader.SetParam(sizeParam, (void*)&tx.second);
+        auto tx = textureSizes.find(ts.first);
+        if(tx != textureSizes.end())
+            m_shader.SetParam(ts.second, &tx->second);
     }
-    for(auto p = 0; p < passSizes.size(); p++)
+    for(auto p = 0; p < passSizes.size() && p < m_shader.Slots().PassOutputSizes().size(); p++)
     {
         const auto& passSize = passSizes.at(p);
         if(passSize[2] != 0 && passSize[3] != 0)
         {
-            auto  sizeParam    = "PassOutputSize" + std::to_string(p);
             float passSizeF[4] = {(float)passSize[2], (float)passSize[3], 1.0f / passSize[2], 1.0f / passSize[3]};
-            m_shader.SetParam(sizeParam, passSizeF);
+            m_shader.SetParam(m_shader.Slots().PassOutputSizes()[p], passSizeF);
         }
     }
 }
 
-void ShaderPass::Render(std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>>& resources, int frameNo, int boxX, int boxY)
+void ShaderPass::SetBindings(const std::vector<SlotBinding>& bindings)
 {
-    Render(m_sourceView, resources, frameNo, boxX, boxY);
+    m_bindings = bindings;
+    m_views.clear();
+    m_samplerStates.clear();
+    if(m_bindings.empty())
+        return;
+
+    // bind a contiguous range in a single call, gaps stay null
+    UINT lastBinding = 0;
+    m_firstBinding   = D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT;
+    for(const auto& b : m_bindings)
+    {
+        m_firstBinding = min(m_firstBinding, static_cast<UINT>(b.binding));
+        lastBinding    = max(lastBinding, static_cast<UINT>(b.binding));
+#ifdef _DEBUG
+        if(b.slot == NO_SLOT)
+        {
+            for(const auto& texture : m_shader.m_shaderDef.Samplers)
+            {
+                if(texture.binding == b.binding)
+                {
+                    OutputDebugStringW(convertCharArrayToLPCWSTR(texture.name.c_str()));
+                    OutputDebugStringW(L"\n");
+                }
+            }
+        }
+#endif
+    }
+    m_views.resize(lastBinding - m_firstBinding + 1, nullptr);
+    m_samplerStates.resize(m_views.size(), nullptr);
+    for(const auto& b : m_bindings)
+    {
+        m_samplerStates[b.binding - m_firstBinding] = m_samplers.at(b.binding).get();
+    }
 }
 
-void ShaderPass::Render(ID3D11ShaderResourceView* sourceView, std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>>& resources, int frameNo, int boxX, int boxY)
+void ShaderPass::SetArena(UniformArena* arena)
 {
-    params_FrameCount = frameNo;
-    if(m_shader.m_frameCountMod > 0)
+    m_arena = arena;
+    m_shader.Invalidate();
+}
+
+void ShaderPass::Upload(int buffer, ID3D11Buffer* passBuffer, ArenaSlice& slice)
+{
+    if(passBuffer == nullptr)
+        return;
+
+    if(m_arena != nullptr && m_arena->context != nullptr)
     {
-        while(params_FrameCount >= m_shader.m_frameCountMod)
-            params_FrameCount -= m_shader.m_frameCountMod;
+        const auto upload = m_arena->ring.Upload(m_shader.Dirty(buffer), m_shader.BufferSize(buffer), slice);
+        if(!upload.copy)
+            return;
+
+        D3D11_MAPPED_SUBRESOURCE mappedSubresource;
+        m_context->Map(m_arena->buffer.get(), 0, upload.discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mappedSubresource);
+        memcpy((char*)mappedSubresource.pData + upload.target, m_shader.Params(buffer) + upload.source, upload.size);
+        m_context->Unmap(m_arena->buffer.get(), 0);
+        m_shader.Uploaded(buffer);
     }
+    else
+    {
+        const auto upload = PassBufferUpload(m_shader.Dirty(buffer), m_shader.BufferSize(buffer), m_partialContext != nullptr);
+        if(!upload.copy)
+            return;
 
-    m_shader.SetParam("FrameCount", &params_FrameCount);
-    m_shader.SetParam("MVP", &m_modelViewProj);
+        if(m_partialContext != nullptr)
+        {
+            D3D11_BOX box = {(UINT)upload.target, 0, 0, (UINT)(upload.target + upload.size), 1, 1};
+            m_partialContext->UpdateSubresource1(passBuffer, 0, &box, m_shader.Params(buffer) + upload.source, 0, 0, 0);
+        }
+        else
+        {
+            m_context->UpdateSubresource(passBuffer, 0, nullptr, m_shader.Params(buffer), 0, 0);
+        }
+        m_shader.Uploaded(buffer);
+        if(m_arena != nullptr)
+            m_arena->ring.Count(upload.size);
+    }
+}
 
-    if(m_constantBuffer != nullptr)
+void ShaderPass::BindUniforms()
+{
+    if(m_arena != nullptr && m_arena->context != nullptr)
     {
-        D3D11_MAPPED_SUBRESOURCE mappedSubresource;
-        m_context->Map(m_constantBuffer.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubresource);
-        m_shader.FillParams(0, (char*)mappedSubresource.pData);
-        m_context->Unmap(m_constantBuffer.get(), 0);
+        ID3D11Buffer* buffer[1] = {m_arena->buffer.get()};
+        if(m_constantBuffer != nullptr)
+        {
+            m_arena->context->VSSetConstantBuffers1(0, 1, buffer, &m_uboSlice.first, &m_uboSlice.count);
+            m_arena->context->PSSetConstantBuffers1(0, 1, buffer, &m_uboSlice.first, &m_uboSlice.count);
+        }
+        if(m_pushBuffer != nullptr)
+        {
+            m_arena->context->VSSetConstantBuffers1(1, 1, buffer, &m_pushSlice.first, &m_pushSlice.count);
+            m_arena->context->PSSetConstantBuffers1(1, 1, buffer, &m_pushSlice.first, &m_pushSlice.count);
+        }
+        return;
     }
 
+    if(m_constantBuffer != nullptr)
+    {
+        ID3D11Buffer* buffer[1] = {m_constantBuffer.get()};
+        m_context->VSSetConstantBuffers(0, 1, buffer);
+        m_context->PSSetConstantBuffers(0, 1, buffer);
+    }
     if(m_pushBuffer != nullptr)
     {
-        D3D11_MAPPED_SUBRESOURCE mappedSubresource;
-        m_context->Map(m_pushBuffer.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubresource);
-        m_shader.FillParams(-1, (char*)mappedSubresource.pData);
-        m_context->Unmap(m_pushBuffer.get(), 0);
+        ID3D11Buffer* buffer[1] = {m_pushBuffer.get()};
+        m_context->VSSetConstantBuffers(1, 1, buffer);
+        m_context->PSSetConstantBuffers(1, 1, buffer);
     }
+}
+
+void ShaderPass::Render(const std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>& resources, int frameNo, int boxX, int boxY)
+{
+    Render(m_sourceView, resources, frameNo, boxX, boxY);
+}
+
+void ShaderPass::Render(ID3D11ShaderResourceView* sourceView, const std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>& resources, int frameNo, int boxX, int boxY)
+{
+    params_FrameCount = frameNo;
+    if(m_shader.m_frameCountMod > 0)
+    {
+        while(params_FrameCount >= m_shader.m_frameCountMod)
+            params_FrameCount -= m_shader.m_frameCountMod;
+    }
+
+    m_shader.SetParam(m_shader.Slots().FrameCount(), &params_FrameCount);
+    m_shader.SetParam(m_shader.Slots().MVP(), &m_modelViewProj);
+
+    Upload(UBO_BUFFER, m_constantBuffer.get(), m_uboSlice);
+    Upload(PUSH_BUFFER, m_pushBuffer.get(), m_pushSlice);
 
     D3D11_VIEWPORT viewport = {static_cast<float>(boxX), static_cast<float>(boxY), static_cast<float>(m_destWidth), static_cast<float>(m_destHeight), 0.0f, 1.0f};
     m_context->RSSetViewports(1, &viewport);
@@ -301,53 +422,23 @@ void ShaderPass::Render(ID3D11ShaderResourceView* sourceView, std::map<std::stri
     m_context->VSSetShader(m_shader.m_vertexShader.get(), NULL, 0);
     m_context->PSSetShader(m_shader.m_pixelShader.get(), NULL, 0);
 
-    std::vector<int> bindings;
-    for(const auto& texture : m_shader.m_shaderDef.Samplers)
+    if(!m_views.empty())
     {
-        auto& sampler = m_samplers.at(texture.binding);
-        if(texture.name == "Source")
+        for(const auto& b : m_bindings)
         {
-            ID3D11ShaderResourceView* localResources[1] = {sourceView};
-            m_context->PSSetShaderResources(texture.binding, 1, localResources);
-            bindings.push_back(texture.binding);
-        }
-        else
-        {
-            auto it = resources.find(texture.name);
-            if(it == resources.end() && texture.name.starts_with("OriginalHistory"))
-            {
-                it = resources.find("Original"); // should only map 0 to Original
-            }
-            if(it != resources.end())
-            {
-                ID3D11ShaderResourceView* localResources[1] = {it->second.get()};
-                m_context->PSSetShaderResources(texture.binding, 1, localResources);
-                bindings.push_back(texture.binding);
-            }
+            auto& view = m_views[b.binding - m_firstBinding];
+            if(b.slot == SOURCE_SLOT)
+                view = sourceView;
+            else if(b.slot >= 0 && b.slot < resources.size())
+                view = resources[b.slot].get();
             else
-            {
-#ifdef _DEBUG
-                OutputDebugStringW(convertCharArrayToLPCWSTR(texture.name.c_str()));
-                OutputDebugStringW(L"\n");
-#endif
-            }
+                view = nullptr;
         }
-        ID3D11SamplerState* samplers[1] = {sampler.get()};
-        m_context->PSSetSamplers(texture.binding, 1, samplers);
+        m_context->PSSetShaderResources(m_firstBinding, static_cast<UINT>(m_views.size()), m_views.data());
+        m_context->PSSetSamplers(m_firstBinding, static_cast<UINT>(m_samplerStates.size()), m_samplerStates.data());
     }
 
-    if(m_constantBuffer != nullptr)
-    {
-        ID3D11Buffer* buffer[1] = {m_constantBuffer.get()};
-        m_context->VSSetConstantBuffers(0, 1, buffer);
-        m_context->PSSetConstantBuffers(0, 1, buffer);
-    }
-    if(m_pushBuffer != nullptr)
-    {
-        ID3D11Buffer* buffer[1] = {m_pushBuffer.get()};
-        m_context->VSSetConstantBuffers(1, 1, buffer);
-        m_context->PSSetConstantBuffers(1, 1, buffer);
-    }
+    BindUniforms();
 
     if(m_preprocess)
     {
@@ -359,10 +450,9 @@ void ShaderPass::Render(ID3D11ShaderResourceView* sourceView, std::map<std::stri
     }
 
     // unbind to allow rebinding as input/output
-    for(auto& b : bindings)
+    if(!m_views.empty())
     {
-        ID3D11ShaderResourceView* null[] = {nullptr};
-        m_context->PSSetShaderResources(b, 1, null);
+        m_context->PSSetShaderResources(m_firstBinding, static_cast<UINT>(m_views.size()), sNullViews);
     }
     ID3D11RenderTargetView* null[] = {nullptr};
     m_context->OMSetRenderTargets(1, null, NULL);
@@ -376,14 +466,9 @@ void ShaderPass::RenderCursor(float x, float y, float w, float h, winrt::com_ptr
     D3D11_VIEWPORT viewport = {static_cast<float>(x), static_cast<float>(y), w, h, 0.0f, 1.0f};
     m_context->RSSetViewports(1, &viewport);
 
-    m_shader.SetParam("MVP", &m_cursorMVP);
-    if(m_constantBuffer != nullptr)
-    {
-        D3D11_MAPPED_SUBRESOURCE mappedSubresource;
-        m_context->Map(m_constantBuffer.get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mappedSubresource);
-        m_shader.FillParams(0, (char*)mappedSubresource.pData);
-        m_context->Unmap(m_constantBuffer.get(), 0);
-    }
+    m_shader.SetParam(m_shader.Slots().MVP(), &m_cursorMVP);
+    Upload(UBO_BUFFER, m_constantBuffer.get(), m_uboSlice);
+    BindUniforms();
 
     ID3D11RenderTargetView*   targets[1]        = {m_targetView};
     ID3D11ShaderResourceView* localResources[1] = {cursorView.get()};
@@ -398,38 +483,3 @@ void ShaderPass::RenderCursor(float x, float y, float w, float h, winrt::com_ptr
     m_context->OMSetBlendState(NULL, NULL, 0xffffffff);
     m_context->PSSetShaderResources(m_sourceBinding, 1, nullResources);
 }
-
-bool ShaderPass::RequiresFeedback() const
-{
-    for(const auto& texture : m_shader.m_shaderDef.Samplers)
-    {
-        if(texture.name.ends_with("Feedback") || texture.name.starts_with("PassFeedback"))
-        {
-            return true;
-        }
-    }
-    return false;
-}
-
-int ShaderPass::RequiresHistory() const
-{
-    int maxHistory = 0;
-    for(const auto& texture : m_shader.m_shaderDef.Samplers)
-    {
-        if(texture.name.starts_with("OriginalHistory"))
-        {
-            try
-            {
-                auto historyString = texture.name.substr(15);
-                auto historyNum    = std::stoi(historyString);
-                if(historyNum > 0 && historyNum < 100)
-                {
-                    maxHistory = max(maxHistory, historyNum);
-                }
-            }
-            catch(...)
-            { }
-        }
-    }
-    return maxHistory;
-}
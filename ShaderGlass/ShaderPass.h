@@ -9,9 +9,19 @@ GNU General Public License v3.0
 
 #include "Shader.h"
 #include "Preset.h"
+#include "RenderGraph.h"
 
 #pragma once
 
+// ring all passes' uniforms are uploaded to and bound from by offset; without a
+// context supporting constant buffer offsets each pass keeps its own buffers
+struct UniformArena
+{
+    ConstantArena                        ring;
+    winrt::com_ptr<ID3D11Buffer>         buffer;
+    winrt::com_ptr<ID3D11DeviceContext1> context;
+};
+
 class ShaderPass
 {
 public:
@@ -20,14 +30,14 @@ public:
     ~ShaderPass();
 
     void Initialize(winrt::com_ptr<ID3D11Device> device, winrt::com_ptr<ID3D11DeviceContext> context);
-    void Render(std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>>& resources, int frameCount, int boxX, int boxY);
-    void Render(ID3D11ShaderResourceView* sourceView, std::map<std::string, winrt::com_ptr<ID3D11ShaderResourceView>>& resources, int frameCount, int boxX, int boxY);
+    void SetBindings(const std::vector<SlotBinding>& bindings);
+    void SetArena(UniformArena* arena);
+    void Render(const std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>& resources, int frameCount, int boxX, int boxY);
+    void Render(ID3D11ShaderResourceView* sourceView, const std::vector<winrt::com_ptr<ID3D11ShaderResourceView>>& resources, int frameCount, int boxX, int boxY);
     void RenderCursor(float x, float y, float w, float h, winrt::com_ptr<ID3D11ShaderResourceView> cursorView);
-    void
-    Resize(int sourceWidth, int sourceHeight, int destWidth, int destHeight, const std::map<std::string, float4>& textureSizes, const std::vector<std::array<UINT, 4>>& passSizes);
+    void Resize(int sourceWidth, int sourceHeight, int destWidth, int destHeight, const std::map<std::string, TextureSize>& textureSizes, const std::vector<PassSize>& passSizes);
     void UpdateMVP(float sx, float sy, float tx, float ty);
-    bool RequiresFeedback() const;
-    int  RequiresHistory() const;
+    void SetTransposed(bool transposed);
 
     Shader&                   m_shader;
     Preset&                   m_preset;
@@ -37,9 +47,13 @@ public:
     int                       m_destHeight {0};
 
 private:
+    void Upload(int buffer, ID3D11Buffer* passBuffer, ArenaSlice& slice);
+    void BindUniforms();
+
     float4x4                                          m_modelViewProj {};
     winrt::com_ptr<ID3D11Device>                      m_device {nullptr};
     winrt::com_ptr<ID3D11DeviceContext>               m_context {nullptr};
+    winrt::com_ptr<ID3D11DeviceContext1>              m_partialContext {nullptr}; // set where constant buffers update in part
     winrt::com_ptr<ID3D11InputLayout>                 m_inputLayout {nullptr};
     winrt::com_ptr<ID3D11Buffer>                      m_vertexBuffer {nullptr};
     winrt::com_ptr<ID3D11Buffer>                      m_constantBuffer {nullptr};
@@ -55,4 +69,12 @@ private:
     winrt::com_ptr<ID3D11BlendState>                  m_blendState;
     int                                               m_sourceBinding {-1};
     float4x4                                          m_cursorMVP {};
+    std::vector<SlotBinding>                          m_bindings;
+    UINT                                              m_firstBinding {0};
+    std::vector<ID3D11ShaderResourceView*>            m_views; // m_firstBinding onwards
+    std::vector<ID3D11SamplerState*>                  m_samplerStates;
+    UniformArena*                                     m_arena {nullptr};
+    ArenaSlice                                        m_uboSlice {};
+    ArenaSlice                                        m_pushSlice {};
+    bool                                              m_transposed {false}; // renders rotated for vertical mode
 };
@@ -1293,7 +1293,7 @@ void ShaderWindow::UpdateTitle()
             }
         }
 
-        wchar_t     title[200];
+        wchar_t     title[240];
         const char* scaleString = m_captureOptions.freeScale ? "free" : outputScale.mnemonic;
         const auto  inFPS       = (int)roundf(m_captureManager.InFPS());
         const auto  outFPS      = (int)roundf(m_captureManager.OutFPS());
@@ -1308,15 +1308,24 @@ void ShaderWindow::UpdateTitle()
         }
         if(m_captureOptions.maxCaptureRate)
             advancedFlags[a++] = 'M';
+        if(m_captureOptions.gazeInput)
+            advancedFlags[a++] = 'G';
         advancedFlags[a] = 0;
         if(a == 1)
             advancedFlags[0] = 0;
         char inFPSdisplay[20] = "";
         if(m_captureOptions.flipMode || m_captureOptions.maxCaptureRate)
             snprintf(inFPSdisplay, 20, "%d->", inFPS);
+        char gazeDisplay[20] = "";
+        if(m_captureOptions.gazeInput && m_captureManager.GazeLatency() > 0)
+            snprintf(gazeDisplay, 20, ", gaze %.1fms", m_captureManager.GazeLatency());
+        char       targetsDisplay[40] = "";
+        const auto targetBytes        = m_captureManager.TargetBytes();
+        if(targetBytes.second < targetBytes.first)
+            snprintf(targetsDisplay, 40, ", targets %lluMB->%lluMB", targetBytes.first >> 20, targetBytes.second >> 20);
         _snwprintf_s(title,
-                     200,
-                     _T("ShaderGlass (%s%S, %Spx, %S%%, ~%S, %S%dfps%S)"),
+                     240,
+                     _T("ShaderGlass (%s%S, %Spx, %S%%, ~%S, %S%dfps%S%S%S)"),
                      windowName,
                      shader->Name.c_str(),
                      pixelSize.mnemonic,
@@ -1324,7 +1333,9 @@ void ShaderWindow::UpdateTitle()
                      aspectRatio.mnemonic,
                      inFPSdisplay,
                      outFPS,
-                     advancedFlags);
+                     advancedFlags,
+                     gazeDisplay,
+                     targetsDisplay);
         SetWindowTextW(m_mainWindow, title);
     }
     else if(m_firstStart)
@@ -1491,6 +1502,18 @@ LRESULT CALLBACK ShaderWindow::WndProc(HWND hWnd, UINT message, WPARAM wParam, L
                 SaveMaxCaptureRateState(true);
             }
             break;
+        case ID_ADVANCED_GAZEINPUT:
+            if(GetMenuState(m_advancedMenu, ID_ADVANCED_GAZEINPUT, MF_BYCOMMAND) & MF_CHECKED)
+            {
+                CheckMenuItem(m_advancedMenu, ID_ADVANCED_GAZEINPUT, MF_UNCHECKED);
+                SaveGazeInputState(false);
+            }
+            else
+            {
+                CheckMenuItem(m_advancedMenu, ID_ADVANCED_GAZEINPUT, MF_CHECKED);
+                SaveGazeInputState(true);
+            }
+            break;
         case ID_ADVANCED_USEHDR:
             if(GetMenuState(m_advancedMenu, ID_ADVANCED_USEHDR, MF_BYCOMMAND) & MF_CHECKED)
             {
@@ -2466,6 +2489,24 @@ bool ShaderWindow::Create(_In_ HINSTANCE hInstance, _In_ int nCmdShow)
         ModifyMenu(
             m_advancedMenu, ID_ADVANCED_MAXCAPTUREFRAMERATE, MF_BYCOMMAND | MF_STRING | MF_DISABLED | MF_GRAYED, ID_ADVANCED_MAXCAPTUREFRAMERATE, L"Max Capture Rate (Win11 24H2)");
     }
+    if(GetGazeInputState())
+    {
+        CheckMenuItem(m_advancedMenu, ID_ADVANCED_GAZEINPUT, MF_BYCOMMAND | MF_CHECKED);
+        m_captureOptions.gazeInput = true;
+        m_captureOptions.gazePort  = GetRegistryInt(TEXT("Gaze Port"), GAZE_DEFAULT_PORT);
+
+        m_captureOptions.gazeFilter.type = static_cast<GazeFilterType>(GetRegistryInt(TEXT("Gaze Filter"), static_cast<int>(GazeFilterType::OneEuro)));
+        m_captureOptions.saccades.reduce = GetRegistryInt(TEXT("Saccade Frames"), 0) != 0;
+
+        // percentages of the output
+        m_captureOptions.foveation.size           = GetRegistryInt(TEXT("Fovea Size"), 0) / 100.0f;
+        m_captureOptions.foveation.peripheryScale = GetRegistryInt(TEXT("Periphery Scale"), 50) / 100.0f;
+
+        // periphery refreshes every N frames, every N/2 nearer the fovea and every frame around its edge
+        const auto refresh                    = std::max<int>(1, GetRegistryInt(TEXT("Periphery Refresh"), 1));
+        const auto edge                       = m_captureOptions.foveation.size / 2;
+        m_captureOptions.peripheryTiles.tiers = {{edge + 0.1f, 1}, {edge + 0.25f, std::max<int>(1, refresh / 2)}, {2.0f, refresh}};
+    }
 
     m_captureOptions.monitor      = nullptr;
     m_captureOptions.outputWindow = m_mainWindow;
@@ -2618,6 +2659,16 @@ bool ShaderWindow::GetMaxCaptureRateState()
     return GetRegistryOption(TEXT("Max Capture Rate"), false);
 }
 
+void ShaderWindow::SaveGazeInputState(bool state)
+{
+    SaveRegistryOption(TEXT("Gaze Input"), state);
+}
+
+bool ShaderWindow::GetGazeInputState()
+{
+    return GetRegistryOption(TEXT("Gaze Input"), false);
+}
+
 void ShaderWindow::SaveUseHDRState(bool state)
 {
     SaveRegistryOption(TEXT("Use HDR"), state);
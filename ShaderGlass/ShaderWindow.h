@@ -130,6 +130,8 @@ private:
     bool         GetTearingState();
     void         SaveMaxCaptureRateState(bool state);
     bool         GetMaxCaptureRateState();
+    void         SaveGazeInputState(bool state);
+    bool         GetGazeInputState();
     void         SaveUseHDRState(bool state);
     bool         GetUseHDRState();
     void         SaveRememberFPS(int fps);
@@ -0,0 +1,124 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+// blends the full resolution fovea over the upscaled periphery, weighted like
+// Foveation::Weight; compiled when created
+class FoveaCompositeShaderDef : public ShaderDef
+{
+public:
+    FoveaCompositeShaderDef() : ShaderDef {}
+    {
+        Name           = "fovea-composite";
+        FrameDependent = 0;
+        Params.push_back(ShaderParam("MVP", 0, 0, 64, 0.000000f, 0.000000f, 0.000000f));
+        Params.push_back(ShaderParam("SourceSize", -1, 0, 16, 0.000000f, 0.000000f, 0.000000f));
+        Params.push_back(ShaderParam("OutputSize", -1, 16, 16, 0.000000f, 0.000000f, 0.000000f));
+        Params.push_back(ShaderParam("FoveaBounds", -1, 32, 16, 0.000000f, 0.000000f, 0.000000f));
+        Params.push_back(ShaderParam("FoveaFeather", -1, 48, 16, 0.000000f, 0.000000f, 0.000000f));
+        Samplers.push_back(ShaderSampler("Source", 2));
+        Samplers.push_back(ShaderSampler("Fovea", 3));
+        PresetParams.insert(std::make_pair("filter_linear", "true"));
+        PresetParams.insert(std::make_pair("wrap_mode", "clamp_to_edge"));
+
+        VertexSource = R"(
+cbuffer UBO : register(b0)
+{
+    row_major float4x4 global_MVP : packoffset(c0);
+};
+
+static float4 gl_Position;
+static float4 Position;
+static float2 vTexCoord;
+static float2 TexCoord;
+
+struct SPIRV_Cross_Input
+{
+    float4 Position : TEXCOORD0;
+    float2 TexCoord : TEXCOORD1;
+};
+
+struct SPIRV_Cross_Output
+{
+    float2 vTexCoord : TEXCOORD0;
+    float4 gl_Position : SV_Position;
+};
+
+void vert_main()
+{
+    gl_Position = mul(Position, global_MVP);
+    vTexCoord = TexCoord;
+}
+
+SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
+{
+    Position = stage_input.Position;
+    TexCoord = stage_input.TexCoord;
+    vert_main();
+    SPIRV_Cross_Output stage_output;
+    stage_output.gl_Position = gl_Position;
+    stage_output.vTexCoord = vTexCoord;
+    return stage_output;
+}
+)";
+
+        FragmentSource = R"(
+cbuffer Push : register(b1)
+{
+    float4 params_SourceSize : packoffset(c0);
+    float4 params_OutputSize : packoffset(c1);
+    float4 params_FoveaBounds : packoffset(c2);
+    float4 params_FoveaFeather : packoffset(c3);
+};
+
+Texture2D<float4> Source : register(t2);
+SamplerState _Source_sampler : register(s2);
+Texture2D<float4> Fovea : register(t3);
+SamplerState _Fovea_sampler : register(s3);
+
+static float4 FragColor;
+static float2 vTexCoord;
+
+struct SPIRV_Cross_Input
+{
+    float2 vTexCoord : TEXCOORD0;
+};
+
+struct SPIRV_Cross_Output
+{
+    float4 FragColor : SV_Target0;
+};
+
+float ease(float distance, float band)
+{
+    return band > 0.0 ? smoothstep(0.0, band, distance) : step(0.000001, distance);
+}
+
+void frag_main()
+{
+    float2 distance = min(vTexCoord - params_FoveaBounds.xy, params_FoveaBounds.zw - vTexCoord);
+    float weight = ease(distance.x, params_FoveaFeather.x) * ease(distance.y, params_FoveaFeather.y);
+    float3 colour = Source.Sample(_Source_sampler, vTexCoord).rgb;
+    if(weight > 0.0)
+    {
+        colour = lerp(colour, Fovea.SampleLevel(_Fovea_sampler, vTexCoord, 0.0).rgb, weight);
+    }
+    FragColor = float4(colour, 1.0);
+}
+
+SPIRV_Cross_Output main(SPIRV_Cross_Input stage_input)
+{
+    vTexCoord = stage_input.vTexCoord;
+    frag_main();
+    SPIRV_Cross_Output stage_output;
+    stage_output.FragColor = FragColor;
+    return stage_output;
+}
+)";
+    }
+};
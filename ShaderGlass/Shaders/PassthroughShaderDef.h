@@ -70,6 +70,7 @@ public:
         VertexLength     = sizeof(PassthroughShaderDefs::sVertexByteCode);
         FragmentByteCode = PassthroughShaderDefs::sFragmentByteCode;
         FragmentLength   = sizeof(PassthroughShaderDefs::sFragmentByteCode);
+        FrameDependent   = 0;
         Params.push_back(ShaderParam("MVP", 0, 0, 64, 0.000000f, 0.000000f, 0.000000f));
         Params.push_back(ShaderParam("SourceSize", -1, 0, 16, 0.000000f, 0.000000f, 0.000000f));
         Params.push_back(ShaderParam("OriginalSize", -1, 16, 16, 0.000000f, 0.000000f, 0.000000f));
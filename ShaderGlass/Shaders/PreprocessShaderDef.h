@@ -74,6 +74,7 @@ public:
         VertexLength     = sizeof(PreprocessShaderDefs::sVertexByteCode);
         FragmentByteCode = PreprocessShaderDefs::sFragmentByteCode;
         FragmentLength   = sizeof(PreprocessShaderDefs::sFragmentByteCode);
+        FrameDependent   = 0;
         Params.push_back(ShaderParam("MVP", 0, 0, 64, 0.000000f, 0.000000f, 0.000000f));
         Params.push_back(ShaderParam("SGVertical", 0, 64, 4, 0, 1, 0, 0));
         Samplers.push_back(ShaderSampler("Source", 2));
@@ -0,0 +1,150 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+
+struct TargetKey
+{
+    uint32_t width {0};
+    uint32_t height {0};
+    uint32_t format {0};
+    uint32_t bind {0};
+
+    bool operator==(const TargetKey&) const = default;
+};
+
+// render targets kept across pass rebuilds and preset switches, so returning to a
+// recent size or format reuses textures instead of creating them again; T carries
+// the key it was allocated for, idle targets are evicted least recently released
+// first once over budget texels
+template<typename T> class TargetPool
+{
+public:
+    using Allocator = std::function<T(const TargetKey& key)>;
+
+    TargetPool() = default;
+    TargetPool(Allocator allocator, uint64_t budget) : m_allocator {allocator}, m_budget {budget} { }
+
+    T Acquire(const TargetKey& key)
+    {
+        for(auto it = m_idle.begin(); it != m_idle.end(); it++)
+        {
+            if(it->key == key)
+            {
+                T target = std::move(*it);
+                m_idle.erase(it);
+                m_idleTexels -= Texels(key);
+                m_reused++;
+                return target;
+            }
+        }
+        m_allocated++;
+        return m_allocator(key);
+    }
+
+    void Release(T target)
+    {
+        m_idleTexels += Texels(target.key);
+        m_idle.push_front(std::move(target));
+        while(m_idleTexels > m_budget && !m_idle.empty())
+        {
+            m_idleTexels -= Texels(m_idle.back().key);
+            m_idle.pop_back();
+        }
+    }
+
+    void Clear()
+    {
+        m_idle.clear();
+        m_idleTexels = 0;
+    }
+
+    size_t Allocated() const
+    {
+        return m_allocated;
+    }
+
+    size_t Reused() const
+    {
+        return m_reused;
+    }
+
+    size_t Idle() const
+    {
+        return m_idle.size();
+    }
+
+private:
+    static uint64_t Texels(const TargetKey& key)
+    {
+        return (uint64_t)key.width * key.height;
+    }
+
+    Allocator    m_allocator;
+    uint64_t     m_budget {0};
+    uint64_t     m_idleTexels {0};
+    std::list<T> m_idle; // most recently released first
+    size_t       m_allocated {0};
+    size_t       m_reused {0};
+};
+
+// decides when a live window size is worth re-planning the pass chain for: once it has
+// held for settleFrames frames, or straight away when it leaves the shrink..grow band
+// around the planned size; in between the final pass stretches the planned chain
+class ResizeHysteresis
+{
+public:
+    ResizeHysteresis(int settleFrames = 8, float shrink = 0.5f, float grow = 1.5f) : m_settleFrames {settleFrames}, m_shrink {shrink}, m_grow {grow} { }
+
+    // chain is now planned for width x height
+    void Reset(uint32_t width, uint32_t height)
+    {
+        m_plannedWidth  = width;
+        m_plannedHeight = height;
+        m_pendingWidth  = width;
+        m_pendingHeight = height;
+        m_stableFrames  = 0;
+    }
+
+    // called every frame, true if the chain should be re-planned for width x height
+    bool Update(uint32_t width, uint32_t height)
+    {
+        if(width == m_plannedWidth && height == m_plannedHeight)
+        {
+            Reset(width, height);
+            return false;
+        }
+
+        if(width == m_pendingWidth && height == m_pendingHeight)
+        {
+            m_stableFrames++;
+        }
+        else
+        {
+            m_pendingWidth  = width;
+            m_pendingHeight = height;
+            m_stableFrames  = 0;
+        }
+
+        return m_stableFrames >= m_settleFrames || width < m_plannedWidth * m_shrink || height < m_plannedHeight * m_shrink || width > m_plannedWidth * m_grow ||
+               height > m_plannedHeight * m_grow;
+    }
+
+private:
+    int      m_settleFrames;
+    float    m_shrink;
+    float    m_grow;
+    uint32_t m_plannedWidth {0};
+    uint32_t m_plannedHeight {0};
+    uint32_t m_pendingWidth {0};
+    uint32_t m_pendingHeight {0};
+    int      m_stableFrames {0};
+};
@@ -14,6 +14,47 @@ GNU General Public License v3.0
 #include "Texture.h"
 #include "WIC\WICTextureLoader11.h"
 
+#include <wincodec.h>
+
+// decoded images kept around for switching between presets sharing them
+#define TEXTURE_CACHE_BUDGET (256 * 1024 * 1024)
+
+// WIC decode to RGBA32, safe to call from worker threads
+static bool DecodeWIC(const uint8_t* data, size_t length, DecodedImage& image)
+{
+    auto init = CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+    bool ok   = false;
+    {
+        winrt::com_ptr<IWICImagingFactory>    factory;
+        winrt::com_ptr<IWICStream>            stream;
+        winrt::com_ptr<IWICBitmapDecoder>     decoder;
+        winrt::com_ptr<IWICBitmapFrameDecode> frame;
+        winrt::com_ptr<IWICFormatConverter>   converter;
+        UINT                                  width, height;
+
+        if(SUCCEEDED(CoCreateInstance(CLSID_WICImagingFactory2, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(factory.put()))) &&
+           SUCCEEDED(factory->CreateStream(stream.put())) && SUCCEEDED(stream->InitializeFromMemory((BYTE*)data, (DWORD)length)) &&
+           SUCCEEDED(factory->CreateDecoderFromStream(stream.get(), nullptr, WICDecodeMetadataCacheOnDemand, decoder.put())) &&
+           SUCCEEDED(decoder->GetFrame(0, frame.put())) && SUCCEEDED(frame->GetSize(&width, &height)) && SUCCEEDED(factory->CreateFormatConverter(converter.put())) &&
+           SUCCEEDED(converter->Initialize(frame.get(), GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom)))
+        {
+            image.width  = width;
+            image.height = height;
+            image.pixels.resize((size_t)width * height * 4);
+            ok = SUCCEEDED(converter->CopyPixels(nullptr, width * 4, (UINT)image.pixels.size(), image.pixels.data()));
+        }
+    }
+    if(SUCCEEDED(init))
+        CoUninitialize();
+    return ok;
+}
+
+TextureCache& Texture::Cache()
+{
+    static TextureCache cache(TEXTURE_CACHE_BUDGET, DecodeWIC);
+    return cache;
+}
+
 Texture::Texture(TextureDef& textureDef) : m_linear(false), m_mipmap(false), m_repeat(false), m_clamp(false), m_mirror(false), m_textureDef(textureDef)
 {
     m_name = textureDef.PresetParams["name"];
@@ -49,6 +90,40 @@ void Texture::Create(winrt::com_ptr<ID3D11Device> d3dDevice)
                                                     m_textureView.put());
 }
 
+void Texture::Create(winrt::com_ptr<ID3D11Device> d3dDevice, const DecodedImage* image)
+{
+    if(image == nullptr)
+    {
+        // formats WIC couldn't convert go through the loader as before
+        Create(d3dDevice);
+        return;
+    }
+
+    // same as WIC loader with WIC_LOADER_FORCE_RGBA32 | WIC_LOADER_IGNORE_SRGB
+    D3D11_TEXTURE2D_DESC desc = {};
+    desc.Width                = image->width;
+    desc.Height               = image->height;
+    desc.MipLevels            = 1;
+    desc.ArraySize            = 1;
+    desc.Format               = DXGI_FORMAT_R8G8B8A8_UNORM;
+    desc.SampleDesc.Count     = 1;
+    desc.Usage                = D3D11_USAGE_DEFAULT;
+    desc.BindFlags            = D3D11_BIND_SHADER_RESOURCE;
+
+    D3D11_SUBRESOURCE_DATA initData = {};
+    initData.pSysMem                = image->pixels.data();
+    initData.SysMemPitch            = image->width * 4;
+
+    winrt::com_ptr<ID3D11Texture2D> texture;
+    if(FAILED(d3dDevice->CreateTexture2D(&desc, &initData, texture.put())))
+    {
+        Create(d3dDevice);
+        return;
+    }
+    m_textureResource = texture.as<ID3D11Resource>();
+    d3dDevice->CreateShaderResourceView(m_textureResource.get(), nullptr, m_textureView.put());
+}
+
 bool Texture::Get(const std::string& presetParam, std::string& value)
 {
     auto it = m_textureDef.PresetParams.find(presetParam);
@@ -8,6 +8,7 @@ GNU General Public License v3.0
 #include "pch.h"
 
 #include "TextureDef.h"
+#include "TextureCache.h"
 
 #pragma once
 
@@ -26,8 +27,11 @@ public:
 
     Texture(TextureDef& textureDef);
     void Create(winrt::com_ptr<ID3D11Device> d3dDevice);
+    void Create(winrt::com_ptr<ID3D11Device> d3dDevice, const DecodedImage* image);
     ~Texture();
 
+    static TextureCache& Cache();
+
 private:
     bool Get(const std::string& presetParam, std::string& value);
 };
\ No newline at end of file
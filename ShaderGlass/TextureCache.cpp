@@ -0,0 +1,122 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "TextureCache.h"
+
+#include <algorithm>
+#include <thread>
+
+TextureCache::TextureCache(size_t budget, Decoder decoder) : m_budget {budget}, m_decoder {decoder} { }
+
+uint64_t TextureCache::Key(const uint8_t* data, size_t length)
+{
+    // FNV-1a, an order of magnitude cheaper than decoding and plenty for a few hundred images
+    uint64_t hash = 0xcbf29ce484222325ull ^ length;
+    for(size_t i = 0; i < length; i++)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+std::shared_ptr<const DecodedImage> TextureCache::Find(uint64_t key)
+{
+    std::lock_guard lock(m_mutex);
+
+    auto it = m_index.find(key);
+    if(it == m_index.end())
+        return nullptr;
+
+    m_entries.splice(m_entries.begin(), m_entries, it->second);
+    return it->second->second;
+}
+
+void TextureCache::Insert(uint64_t key, std::shared_ptr<const DecodedImage> image)
+{
+    std::lock_guard lock(m_mutex);
+
+    if(m_index.contains(key))
+        return;
+
+    m_entries.emplace_front(key, image);
+    m_index[key] = m_entries.begin();
+    m_size += image->pixels.size();
+
+    // always keep the newest entry even if it alone exceeds the budget
+    while(m_size > m_budget && m_entries.size() > 1)
+    {
+        const auto& oldest = m_entries.back();
+        m_size -= oldest.second->pixels.size();
+        m_index.erase(oldest.first);
+        m_entries.pop_back();
+    }
+}
+
+std::vector<std::shared_ptr<const DecodedImage>> TextureCache::Decode(const std::vector<std::pair<const uint8_t*, size_t>>& inputs)
+{
+    std::vector<std::shared_ptr<const DecodedImage>> images(inputs.size());
+    std::vector<uint64_t>                            keys(inputs.size());
+    std::vector<size_t>                              pending; // first input for each uncached key
+
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        keys[i]   = Key(inputs[i].first, inputs[i].second);
+        images[i] = Find(keys[i]);
+        if(images[i])
+        {
+            m_hits++;
+            continue;
+        }
+
+        bool duplicate = false;
+        for(auto p : pending)
+            duplicate |= keys[p] == keys[i];
+        if(!duplicate)
+        {
+            m_misses++;
+            pending.push_back(i);
+        }
+    }
+
+    std::atomic<size_t> next {0};
+    auto                decode = [&]() {
+        size_t n;
+        while((n = next++) < pending.size())
+        {
+            auto i     = pending[n];
+            auto image = std::make_shared<DecodedImage>();
+            if(m_decoder(inputs[i].first, inputs[i].second, *image))
+            {
+                images[i] = image;
+                Insert(keys[i], image);
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    auto                     threads = std::min<size_t>(pending.size(), std::thread::hardware_concurrency());
+    for(size_t t = 1; t < threads; t++)
+        workers.emplace_back(decode);
+    decode(); // this thread works too
+    for(auto& w : workers)
+        w.join();
+
+    // repeated inputs within the batch
+    for(size_t i = 0; i < inputs.size(); i++)
+    {
+        if(images[i])
+            continue;
+        for(auto p : pending)
+        {
+            if(keys[p] == keys[i])
+                images[i] = images[p];
+        }
+    }
+
+    return images;
+}
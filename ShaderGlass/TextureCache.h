@@ -0,0 +1,69 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct DecodedImage
+{
+    uint32_t             width {0};
+    uint32_t             height {0};
+    std::vector<uint8_t> pixels; // RGBA32, tightly packed
+};
+
+// decoded texture images shared between presets, keyed by content hash and
+// evicted least recently used first once over budget bytes
+class TextureCache
+{
+public:
+    using Decoder = std::function<bool(const uint8_t* data, size_t length, DecodedImage& image)>;
+
+    TextureCache(size_t budget, Decoder decoder);
+
+    // decodes uncached inputs on worker threads, failed ones come back as nullptr
+    std::vector<std::shared_ptr<const DecodedImage>> Decode(const std::vector<std::pair<const uint8_t*, size_t>>& inputs);
+
+    size_t Hits() const
+    {
+        return m_hits;
+    }
+
+    size_t Misses() const
+    {
+        return m_misses;
+    }
+
+    size_t Size() const
+    {
+        std::lock_guard lock(m_mutex);
+        return m_size;
+    }
+
+private:
+    using Entry = std::pair<uint64_t, std::shared_ptr<const DecodedImage>>;
+
+    static uint64_t                     Key(const uint8_t* data, size_t length);
+    std::shared_ptr<const DecodedImage> Find(uint64_t key);
+    void                                Insert(uint64_t key, std::shared_ptr<const DecodedImage> image);
+
+    size_t                                                   m_budget;
+    Decoder                                                  m_decoder;
+    std::list<Entry>                                         m_entries; // most recent first
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> m_index;
+    size_t                                                   m_size {0};
+    std::atomic<size_t>                                      m_hits {0};
+    std::atomic<size_t>                                      m_misses {0};
+    mutable std::mutex                                       m_mutex;
+};
@@ -0,0 +1,265 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "Foveation.h"
+
+// tiles at most radius from the gaze, in fractions of the output's longer side, refresh every period frames
+struct TileTier
+{
+    float radius;
+    int   period;
+};
+
+struct TileSettings
+{
+    int                   tileSize {64};                            // output pixels
+    std::vector<TileTier> tiers {{0.15f, 1}, {0.35f, 1}, {2.0f, 1}}; // by radius, tiles beyond the last take its period
+    float                 budget {1.0f};                            // most of the output refreshed a frame, but forced and every-frame tiles
+    float                 saccadeJump {0.1f};                       // gaze moving further between frames, tiles around the landing refresh
+
+    // refreshes less often than every frame
+    bool Temporal() const
+    {
+        for(const auto& tier : tiers)
+            if(tier.period > 1)
+                return true;
+        return false;
+    }
+};
+
+// what to render of the output this frame
+struct TileSchedule
+{
+    std::vector<FoveaRect> rects;      // runs of tiles, output pixels
+    size_t                 tiles {0};  // refreshed
+    size_t                 forced {0}; // of them by damage or a saccade
+    bool                   full {false};
+    float                  pixelFraction {0}; // of the output
+};
+
+// splits the output into tiles that refresh round-robin at rates falling with their distance
+// from the gaze; damaged tiles and the landing of a saccade refresh at once, every choice is
+// down to the calls made so replaying them gives the same schedules
+class TileScheduler
+{
+public:
+    TileScheduler(const TileSettings& settings = {}) : m_settings {settings} { }
+
+    void Resize(uint32_t width, uint32_t height)
+    {
+        m_width   = width;
+        m_height  = height;
+        m_columns = m_settings.tileSize > 0 ? (int)(width + m_settings.tileSize - 1) / m_settings.tileSize : 0;
+        m_rows    = m_settings.tileSize > 0 ? (int)(height + m_settings.tileSize - 1) / m_settings.tileSize : 0;
+        m_tiles.assign(static_cast<size_t>(m_columns) * m_rows, Tile {});
+        Invalidate();
+    }
+
+    // whole output refreshes next frame
+    void Invalidate()
+    {
+        for(auto& tile : m_tiles)
+            tile.forced = true;
+        m_staggered = false;
+    }
+
+    // output pixels that changed, refreshed next frame
+    void Damage(const FoveaRect& rect)
+    {
+        const auto size = m_settings.tileSize;
+        if(m_tiles.empty() || rect.Area() == 0)
+            return;
+        const auto c0 = std::clamp(rect.left / size, 0, m_columns - 1);
+        const auto c1 = std::clamp((rect.right - 1) / size, 0, m_columns - 1);
+        const auto r0 = std::clamp(rect.top / size, 0, m_rows - 1);
+        const auto r1 = std::clamp((rect.bottom - 1) / size, 0, m_rows - 1);
+        for(auto r = r0; r <= r1; r++)
+            for(auto c = c0; c <= c1; c++)
+                m_tiles[r * m_columns + c].forced = true;
+    }
+
+    // gaze normalized to the output
+    const TileSchedule& Schedule(float gazeX, float gazeY)
+    {
+        m_schedule = {};
+        if(m_tiles.empty())
+            return m_schedule;
+
+        const auto longer = static_cast<float>(std::max<uint32_t>(m_width, m_height));
+        const auto gx     = gazeX * m_width;
+        const auto gy     = gazeY * m_height;
+        if(m_gazed && std::hypot(gx - m_gazeX, gy - m_gazeY) > m_settings.saccadeJump * longer && m_settings.tiers.size() > 1)
+        {
+            // landed where tiles were refreshing slowly
+            const auto reach = m_settings.tiers[1].radius * longer;
+            for(auto i = 0; i < (int)m_tiles.size(); i++)
+                if(Distance(i, gx, gy) <= reach)
+                    m_tiles[i].forced = true;
+        }
+        m_gazeX = gx;
+        m_gazeY = gy;
+        m_gazed = true;
+
+        // tiles that can wait, most overdue and then nearest first
+        m_due.clear();
+        size_t everyFrame = 0;
+        for(auto i = 0; i < (int)m_tiles.size(); i++)
+        {
+            auto& tile = m_tiles[i];
+            tile.age++;
+            tile.period = Period(Distance(i, gx, gy) / longer);
+            if(tile.forced)
+                m_schedule.forced++;
+            else if(tile.period == 1)
+                everyFrame++;
+            else if(tile.age >= tile.period)
+                m_due.push_back(i);
+        }
+        std::stable_sort(m_due.begin(), m_due.end(), [this](int a, int b) {
+            const auto overdueA = m_tiles[a].age * m_tiles[b].period;
+            const auto overdueB = m_tiles[b].age * m_tiles[a].period;
+            return overdueA != overdueB ? overdueA > overdueB : m_tiles[a].period < m_tiles[b].period;
+        });
+
+        const auto budget = static_cast<size_t>(std::ceil(std::clamp(m_settings.budget, 0.0f, 1.0f) * m_tiles.size()));
+        m_render.assign(m_tiles.size(), false);
+        for(auto i = 0; i < (int)m_tiles.size(); i++)
+            m_render[i] = m_tiles[i].forced || m_tiles[i].period == 1;
+        m_schedule.tiles = m_schedule.forced + everyFrame;
+        for(auto i : m_due)
+        {
+            if(m_schedule.tiles >= budget)
+                break;
+            m_render[i] = true;
+            m_schedule.tiles++;
+        }
+
+        uint64_t pixels = 0;
+        for(auto i = 0; i < (int)m_tiles.size(); i++)
+        {
+            if(!m_render[i])
+                continue;
+            auto& tile  = m_tiles[i];
+            tile.forced = false;
+            tile.age    = 0;
+            pixels += Rect(i).Area();
+        }
+        if(!m_staggered)
+        {
+            // after a full refresh tiles of the same rate would come due together, spread them
+            for(auto i = 0; i < (int)m_tiles.size(); i++)
+                m_tiles[i].age = (i % m_columns + i / m_columns) % m_tiles[i].period;
+            m_staggered = true;
+        }
+
+        m_schedule.full          = m_schedule.tiles == m_tiles.size();
+        m_schedule.pixelFraction = static_cast<float>(pixels / (double(m_width) * m_height));
+        Merge();
+        return m_schedule;
+    }
+
+    const TileSettings& Settings() const
+    {
+        return m_settings;
+    }
+
+private:
+    struct Tile
+    {
+        int  age {0};    // frames since refreshed
+        int  period {1}; // of its tier this frame
+        bool forced {true};
+    };
+
+    FoveaRect Rect(int i) const
+    {
+        const auto size = m_settings.tileSize;
+        const auto c    = i % m_columns;
+        const auto r    = i / m_columns;
+        return {c * size, r * size, std::min<int>(m_width, (c + 1) * size), std::min<int>(m_height, (r + 1) * size)};
+    }
+
+    // from the gaze to the nearest point of tile i
+    float Distance(int i, float x, float y) const
+    {
+        const auto rect = Rect(i);
+        const auto dx   = std::max<float>({(float)rect.left - x, 0.0f, x - (float)rect.right});
+        const auto dy   = std::max<float>({(float)rect.top - y, 0.0f, y - (float)rect.bottom});
+        return std::hypot(dx, dy);
+    }
+
+    int Period(float eccentricity) const
+    {
+        if(m_settings.tiers.empty())
+            return 1;
+        for(const auto& tier : m_settings.tiers)
+            if(eccentricity <= tier.radius)
+                return std::max<int>(1, tier.period);
+        return std::max<int>(1, m_settings.tiers.back().period);
+    }
+
+    // rendered tiles into runs along rows, and runs spanning the same columns down rows into one
+    void Merge()
+    {
+        std::vector<FoveaRect> open;
+        for(auto r = 0; r < m_rows; r++)
+        {
+            std::vector<FoveaRect> row;
+            for(auto c = 0; c < m_columns; c++)
+            {
+                const auto i = r * m_columns + c;
+                if(!m_render[i])
+                    continue;
+                const auto rect = Rect(i);
+                if(!row.empty() && row.back().right == rect.left)
+                    row.back().right = rect.right;
+                else
+                    row.push_back(rect);
+            }
+
+            std::vector<FoveaRect> next;
+            for(auto& run : row)
+            {
+                auto extended = std::find_if(open.begin(), open.end(), [&run](const FoveaRect& o) { return o.left == run.left && o.right == run.right; });
+                if(extended != open.end())
+                {
+                    extended->bottom = run.bottom;
+                    next.push_back(*extended);
+                    open.erase(extended);
+                }
+                else
+                {
+                    next.push_back(run);
+                }
+            }
+            m_schedule.rects.insert(m_schedule.rects.end(), open.begin(), open.end());
+            open = std::move(next);
+        }
+        m_schedule.rects.insert(m_schedule.rects.end(), open.begin(), open.end());
+    }
+
+    TileSettings      m_settings;
+    uint32_t          m_width {0};
+    uint32_t          m_height {0};
+    int               m_columns {0};
+    int               m_rows {0};
+    std::vector<Tile> m_tiles;
+    std::vector<int>  m_due;
+    std::vector<bool> m_render;
+    bool              m_staggered {false};
+    bool              m_gazed {false};
+    float             m_gazeX {0}; // last frame's, output pixels
+    float             m_gazeY {0};
+    TileSchedule      m_schedule;
+};
@@ -0,0 +1,85 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct ViewKey
+{
+    const void* texture {nullptr};
+    uint32_t    width {0};
+    uint32_t    height {0};
+    uint32_t    format {0};
+
+    bool operator==(const ViewKey&) const = default;
+};
+
+// views of input textures that keep coming back, e.g. the two surfaces of a capture frame
+// pool, so steady-state frames create none; entries hold a reference to their texture so
+// its address can't be reused while cached, least recently used is dropped past capacity
+template<typename Texture, typename View> class ViewCache
+{
+public:
+    using Creator = std::function<View(const Texture& texture)>;
+
+    ViewCache() = default;
+    ViewCache(Creator creator, size_t capacity) : m_creator {creator}, m_capacity {capacity} { }
+
+    View Get(const ViewKey& key, const Texture& texture)
+    {
+        for(size_t i = 0; i < m_entries.size(); i++)
+        {
+            if(m_entries[i].key == key)
+            {
+                // move to front
+                for(; i > 0; i--)
+                    std::swap(m_entries[i], m_entries[i - 1]);
+                m_hits++;
+                return m_entries[0].view;
+            }
+        }
+
+        m_created++;
+        m_entries.insert(m_entries.begin(), {key, texture, m_creator(texture)});
+        if(m_entries.size() > m_capacity)
+            m_entries.pop_back();
+        return m_entries[0].view;
+    }
+
+    // source of the textures has been recreated
+    void Clear()
+    {
+        m_entries.clear();
+    }
+
+    size_t Created() const
+    {
+        return m_created;
+    }
+
+    size_t Hits() const
+    {
+        return m_hits;
+    }
+
+private:
+    struct Entry
+    {
+        ViewKey key;
+        Texture texture;
+        View    view;
+    };
+
+    Creator            m_creator;
+    size_t             m_capacity {0};
+    std::vector<Entry> m_entries; // most recent first
+    size_t             m_created {0};
+    size_t             m_hits {0};
+};
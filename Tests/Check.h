@@ -0,0 +1,66 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// minimal self-registering checks, every test executable runs all TESTs linked into it
+struct TestCase
+{
+    const char* name;
+    void (*run)();
+};
+
+inline std::vector<TestCase>& TestCases()
+{
+    static std::vector<TestCase> cases;
+    return cases;
+}
+
+inline int& CheckFailures()
+{
+    static int failures = 0;
+    return failures;
+}
+
+struct TestRegistrar
+{
+    TestRegistrar(const char* name, void (*run)())
+    {
+        TestCases().push_back({name, run});
+    }
+};
+
+inline void CheckFailed(const char* file, int line, const char* condition, const std::string& context)
+{
+    // a broken invariant over the whole preset corpus would otherwise flood the log
+    if(CheckFailures()++ < 50)
+        std::fprintf(stderr, "%s:%d: CHECK(%s) failed%s%s\n", file, line, condition, context.empty() ? "" : ": ", context.c_str());
+}
+
+#define TEST(name) \
+    static void          name(); \
+    static TestRegistrar name##Registrar(#name, name); \
+    static void          name()
+
+#define CHECK(condition) \
+    do \
+    { \
+        if(!(condition)) \
+            CheckFailed(__FILE__, __LINE__, #condition, {}); \
+    } while(false)
+
+// context is only evaluated on failure
+#define CHECK_MSG(condition, context) \
+    do \
+    { \
+        if(!(condition)) \
+            CheckFailed(__FILE__, __LINE__, #condition, context); \
+    } while(false)
@@ -0,0 +1,124 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "CompileCache.h"
+
+#include <fstream>
+
+namespace
+{
+CompileCacheEntry MakeEntry()
+{
+    CompileCacheEntry entry;
+    entry.spirv    = {0x07230203, 1, 2, 3};
+    entry.hlsl     = "float4 main() : SV_Target { return 0; }";
+    entry.metadata = "{\"ubo\":[]}";
+    entry.bytecode = {'D', 'X', 'B', 'C', 0, 1, 2};
+    entry.log      = "warning: implicit truncation\n";
+    entry.warn     = true;
+    return entry;
+}
+
+struct CacheDirectory
+{
+    CacheDirectory() : path {std::filesystem::temp_directory_path() / "CompileCacheTests"}
+    {
+        std::filesystem::remove_all(path);
+    }
+
+    ~CacheDirectory()
+    {
+        std::filesystem::remove_all(path);
+    }
+
+    // the single entry file
+    std::filesystem::path Entry() const
+    {
+        for(const auto& p : std::filesystem::directory_iterator(path))
+            return p.path();
+        return {};
+    }
+
+    std::string Read() const
+    {
+        std::ifstream file(Entry(), std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void Write(const std::string& content) const
+    {
+        std::ofstream file(Entry(), std::ios::binary | std::ios::trunc);
+        file.write(content.data(), content.size());
+    }
+
+    std::filesystem::path path;
+};
+} // namespace
+
+TEST(CompileCacheRoundTrip)
+{
+    CacheDirectory directory;
+    CompileCache   cache(directory.path, 1 << 20);
+    const auto     stored = MakeEntry();
+
+    CompileCacheEntry entry;
+    CHECK(!cache.Find("source", true, entry));
+    cache.Store("source", true, stored);
+    CHECK(!cache.Find("source", false, entry)); // keyed by stage too
+    CHECK(cache.Find("source", true, entry));
+    CHECK(entry.spirv == stored.spirv && entry.hlsl == stored.hlsl && entry.metadata == stored.metadata && entry.bytecode == stored.bytecode);
+    CHECK(entry.log == stored.log && entry.warn);
+    CHECK(cache.Hits() == 1 && cache.Misses() == 2);
+}
+
+TEST(CompileCacheDamagedEntries)
+{
+    CacheDirectory directory;
+    CompileCache   cache(directory.path, 1 << 20);
+    cache.Store("source", false, MakeEntry());
+    const auto original = directory.Read();
+
+    // header lengths that don't add up to the file are refused before anything is allocated
+    for(size_t field = 2; field < 7; field++)
+    {
+        auto damaged = original;
+        std::fill_n(damaged.begin() + field * sizeof(uint32_t), sizeof(uint32_t), '\xff');
+        directory.Write(damaged);
+        CompileCacheEntry entry;
+        CHECK(!cache.Find("source", false, entry));
+    }
+
+    // a flipped payload byte, a truncated or extended file
+    auto flipped = original;
+    flipped[flipped.size() / 2] ^= 0x20;
+    for(const auto& damaged : {flipped, original.substr(0, original.size() - 1), original + "x", original.substr(0, 10)})
+    {
+        directory.Write(damaged);
+        CompileCacheEntry entry;
+        CHECK(!cache.Find("source", false, entry) && entry.hlsl.empty());
+    }
+
+    directory.Write(original);
+    CompileCacheEntry entry;
+    CHECK(cache.Find("source", false, entry));
+}
+
+TEST(CompileCacheEviction)
+{
+    CacheDirectory directory;
+    CompileCache   cache(directory.path, 2000);
+    auto           entry = MakeEntry();
+    entry.hlsl.resize(300, ' ');
+    for(int i = 0; i < 20; i++)
+        cache.Store("source " + std::to_string(i), true, entry);
+    CHECK(cache.Size() <= 2000);
+
+    CompileCacheEntry found;
+    CHECK(cache.Find("source 19", true, found));
+    CHECK(!cache.Find("source 0", true, found));
+}
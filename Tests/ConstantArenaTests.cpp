@@ -0,0 +1,200 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "ConstantArena.h"
+
+#include <cstring>
+#include <random>
+
+namespace
+{
+// a pass's params as Shader keeps them: written values marked dirty if they changed, and
+// uploaded through the ring or copied in place into the pass's own buffer as ShaderPass::Upload does
+struct PassBuffer
+{
+    PassBuffer(size_t size) : size {size}, cpu((size + 15) & ~size_t(15)), gpu(cpu.size(), 0xcd)
+    {
+        dirty.Mark(0, size); // as Shader::Invalidate does for new buffers
+    }
+
+    void Write(size_t offset, const void* value, size_t length)
+    {
+        if(memcmp(cpu.data() + offset, value, length) != 0)
+        {
+            memcpy(cpu.data() + offset, value, length);
+            dirty.Mark(offset, length);
+        }
+    }
+
+    // bytes copied either way
+    size_t Upload(ConstantArena& arena, std::vector<uint8_t>& ring)
+    {
+        const auto upload = arena.Upload(dirty, size, slice);
+        if(!upload.copy)
+            return 0;
+        if(upload.discard)
+            std::fill(ring.begin(), ring.end(), 0xcd); // contents are undefined after a discard
+        memcpy(ring.data() + upload.target, cpu.data() + upload.source, upload.size);
+        dirty.Clear();
+        return upload.size;
+    }
+
+    size_t Update(bool partial)
+    {
+        const auto upload = PassBufferUpload(dirty, size, partial);
+        if(!upload.copy)
+            return 0;
+        memcpy(gpu.data() + upload.target, cpu.data() + upload.source, upload.size);
+        dirty.Clear();
+        return upload.size;
+    }
+
+    size_t               size;
+    std::vector<uint8_t> cpu; // Shader's buffers have room for whole constants
+    std::vector<uint8_t> gpu; // the pass's own buffer
+    DirtyRange           dirty;
+    ArenaSlice           slice;
+};
+
+// up to three params of random passes changing a frame, most frames changing nothing new
+template<typename F> void RandomWrites(std::mt19937& random, std::vector<PassBuffer>& passes, F&& frame)
+{
+    for(int f = 0; f < 2000; f++)
+    {
+        const auto writes = random() % 4;
+        for(unsigned w = 0; w < writes; w++)
+        {
+            auto&       pass   = passes[random() % passes.size()];
+            const auto  offset = (random() % (pass.size / 4)) * 4;
+            const float value  = static_cast<float>(random() % 3);
+            pass.Write(offset, &value, sizeof(value));
+        }
+        frame(f);
+    }
+}
+
+std::vector<PassBuffer> Passes()
+{
+    std::vector<PassBuffer> passes;
+    for(size_t size : {64, 256, 80, 1024, 16, 520})
+        passes.emplace_back(size);
+    return passes;
+}
+} // namespace
+
+TEST(DirtyRanges)
+{
+    DirtyRange range;
+    CHECK(range.Empty() && range.Size() == 0);
+    range.Mark(32, 16);
+    CHECK(range.begin == 32 && range.end == 48 && range.Size() == 16);
+    range.Mark(0, 4);
+    CHECK(range.begin == 0 && range.end == 48);
+    range.Mark(64, 64);
+    CHECK(range.begin == 0 && range.end == 128);
+    range.Clear();
+    CHECK(range.Empty());
+    range.Mark(100, 4); // a fresh mark doesn't reach back to 0
+    CHECK(range.begin == 100 && range.Size() == 4);
+    range.Mark(100, 0);
+    CHECK(range.Size() == 4);
+}
+
+TEST(ArenaAllocation)
+{
+    ConstantArena unused;
+    bool          discard = false;
+    CHECK(unused.Allocate(16, discard) == 0 && discard); // empty arenas discard every time
+
+    ConstantArena arena(1024);
+    CHECK(ConstantArena::Align(1) == 256 && ConstantArena::Align(256) == 256 && ConstantArena::Align(257) == 512);
+
+    // first allocation starts the ring
+    CHECK(arena.Allocate(100, discard) == 0 && discard && arena.Generation() == 1);
+    CHECK(arena.Allocate(300, discard) == 256 && !discard);
+    CHECK(arena.Allocate(256, discard) == 768 && !discard);
+    CHECK(arena.FrameBytes() == 1024);
+
+    arena.BeginFrame();
+    CHECK(arena.Allocate(16, discard) == 0 && discard && arena.Generation() == 2);
+    arena.Count(64);
+    CHECK(arena.FrameBytes() == 256 + 64);
+}
+
+TEST(ArenaUploads)
+{
+    // the ring starting over every few frames; what's bound when a pass draws must match what was written
+    std::mt19937         random(7);
+    ConstantArena        arena(8 * 1024);
+    std::vector<uint8_t> ring(arena.Capacity());
+    auto                 passes = Passes();
+    size_t               uploads = 0, generations = 0;
+    RandomWrites(random, passes, [&](int frame) {
+        arena.BeginFrame();
+        // each pass draws right after its upload, a later discard doesn't affect draws already issued
+        const auto generation = arena.Generation();
+        for(size_t p = 0; p < passes.size(); p++)
+        {
+            auto& pass = passes[p];
+            pass.Upload(arena, ring);
+            CHECK_MSG(pass.slice.generation == arena.Generation() && pass.slice.count * 16 == ConstantArena::Align(pass.size) &&
+                          memcmp(ring.data() + pass.slice.first * 16, pass.cpu.data(), pass.size) == 0,
+                      "frame " + std::to_string(frame) + " pass " + std::to_string(p));
+        }
+        generations += arena.Generation() != generation;
+        uploads += arena.FrameBytes() / ConstantArena::ALIGNMENT;
+    });
+
+    // unchanged passes cost nothing, so frames upload far less than everything on average
+    size_t everything = 0;
+    for(const auto& pass : passes)
+        everything += ConstantArena::Align(pass.size) / ConstantArena::ALIGNMENT;
+    CHECK(generations > 10);
+    CHECK(uploads * 2 < everything * 2000);
+    printf("  %zu slices uploaded over 2000 frames, ring started over %zu times\n", uploads, generations);
+}
+
+TEST(PassBufferRanges)
+{
+    DirtyRange dirty;
+    CHECK(!PassBufferUpload(dirty, 80, true).copy);
+
+    // dirty bytes widen to the constants holding them, never past the buffer
+    dirty.Mark(20, 4);
+    auto upload = PassBufferUpload(dirty, 80, true);
+    CHECK(upload.copy && upload.source == 16 && upload.target == 16 && upload.size == 16);
+    dirty.Mark(68, 8);
+    upload = PassBufferUpload(dirty, 76, true);
+    CHECK(upload.source == 16 && upload.size == 64);
+
+    // without partial updates the whole buffer goes, in whole constants
+    upload = PassBufferUpload(dirty, 76, false);
+    CHECK(upload.copy && upload.source == 0 && upload.target == 0 && upload.size == 80);
+}
+
+TEST(PassBufferUpdates)
+{
+    // passes updating their own buffers in place, with and without partial updates; the
+    // buffer must hold what was written whenever the pass draws
+    size_t copied[2] = {0, 0};
+    for(bool partial : {false, true})
+    {
+        std::mt19937 random(7);
+        auto         passes = Passes();
+        RandomWrites(random, passes, [&](int frame) {
+            for(size_t p = 0; p < passes.size(); p++)
+            {
+                auto& pass = passes[p];
+                copied[partial] += pass.Update(partial);
+                CHECK_MSG(memcmp(pass.gpu.data(), pass.cpu.data(), pass.size) == 0, "frame " + std::to_string(frame) + " pass " + std::to_string(p));
+            }
+        });
+    }
+    CHECK(copied[1] * 4 < copied[0]);
+    printf("  %zu bytes copied over 2000 frames in place, %zu replacing whole buffers\n", copied[1], copied[0]);
+}
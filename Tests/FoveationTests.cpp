@@ -0,0 +1,224 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "Foveation.h"
+#include "PresetCorpus.h"
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+FoveaSettings Settings(float size, float peripheryScale = 0.5f)
+{
+    FoveaSettings settings;
+    settings.size           = size;
+    settings.peripheryScale = peripheryScale;
+    return settings;
+}
+
+// what every pass of a scissored chain must render: within its output, and enough of it for
+// the next pass to cover its own scissor plus margin texels of its source around it; compared
+// normalized, with a texel of slack either side for rounding to whole pixels
+void CheckScissors(const std::vector<PassSize>& sizes, const FoveaPlan& plan, int margin, const std::string& label)
+{
+    CHECK_MSG(plan.scissors.size() == sizes.size(), label);
+    if(plan.scissors.size() != sizes.size() || sizes.empty())
+        return;
+    CHECK_MSG(plan.scissors.back() == plan.fovea, label);
+    for(size_t p = 0; p < sizes.size(); p++)
+    {
+        const auto& r    = plan.scissors[p];
+        const auto& size = sizes[p];
+        CHECK_MSG(r.left >= 0 && r.top >= 0 && r.right <= (int)size[2] && r.bottom <= (int)size[3], label + " pass " + std::to_string(p));
+        if(p + 1 == sizes.size() || plan.scissors[p + 1].Area() == 0)
+            continue;
+
+        const auto& next = plan.scissors[p + 1];
+        const auto& to   = sizes[p + 1];
+        const auto  sx = 1.0 / size[2] + 1.0 / to[2], sy = 1.0 / size[3] + 1.0 / to[3];
+        const auto  mx = margin / (double)to[0], my = margin / (double)to[1];
+        CHECK_MSG(r.left / (double)size[2] <= std::max(0.0, next.left / (double)to[2] - mx) + sx &&
+                      r.top / (double)size[3] <= std::max(0.0, next.top / (double)to[3] - my) + sy &&
+                      r.right / (double)size[2] >= std::min(1.0, next.right / (double)to[2] + mx) - sx &&
+                      r.bottom / (double)size[3] >= std::min(1.0, next.bottom / (double)to[3] + my) - sy,
+                  label + " pass " + std::to_string(p));
+    }
+}
+} // namespace
+
+TEST(FoveaPlacement)
+{
+    auto f = Foveation::Fovea(1000, 500, 0.5f, 0.5f, 0.3f);
+    CHECK(f.Width() == 300 && f.Height() == 150 && f.left == 350 && f.top == 175);
+
+    // shifted to stay on the output
+    f = Foveation::Fovea(1000, 500, 0.0f, 1.0f, 0.3f);
+    CHECK(f.left == 0 && f.bottom == 500 && f.Width() == 300 && f.Height() == 150);
+    f = Foveation::Fovea(1000, 500, 1.2f, -0.5f, 0.3f);
+    CHECK(f.right == 1000 && f.top == 0);
+    f = Foveation::Fovea(1000, 500, 1.0f, 0.0f, 1.0f);
+    CHECK((f == FoveaRect {0, 0, 1000, 500}));
+    CHECK(Foveation::Fovea(1000, 500, 0.5f, 0.5f, 0).Area() == 0);
+
+    const auto [w, h] = Foveation::PeripherySize(1920, 1080, Settings(0.3f, 0.5f));
+    CHECK(w == 960 && h == 540);
+    CHECK(Foveation::PeripherySize(3, 3, Settings(0.3f, 0.1f)) == std::make_pair(1u, 1u));
+
+    // bounds reach past edges the fovea touches so the composite doesn't fade there
+    const auto plan = Foveation::Plan({PassSize {640, 360, 1920, 1080}}, 1920, 1080, 0.0f, 0.5f, Settings(0.3f));
+    CHECK(plan.bounds[0] < 0 && plan.bounds[2] > 0 && plan.bounds[2] < 1);
+}
+
+TEST(FoveaScissors)
+{
+    // two passes at source scale, one to the viewport
+    const std::vector<PassSize> sizes = {PassSize {640, 360, 640, 360}, PassSize {640, 360, 640, 360}, PassSize {640, 360, 1920, 1080}};
+    const auto                  plan  = Foveation::Plan(sizes, 1920, 1080, 0.5f, 0.5f, Settings(0.3f));
+    CheckScissors(sizes, plan, 8, "hand");
+    CHECK(plan.scissors[2] == plan.fovea);
+    CHECK(plan.scissors[1].left <= 640 * 0.35 - 8 + 1);
+    CHECK(plan.scissors[0].left <= plan.scissors[1].left - 8);
+
+    // a fovea of the whole output renders every pass in full
+    const auto all = Foveation::Plan(sizes, 1920, 1080, 0.5f, 0.5f, Settings(1));
+    CHECK(Foveation::Pixels(all.scissors) == Foveation::Pixels(sizes));
+}
+
+TEST(FoveaWeights)
+{
+    const std::vector<PassSize> sizes = {PassSize {640, 360, 1920, 1080}};
+    auto                        plan  = Foveation::Plan(sizes, 1920, 1080, 0.5f, 0.5f, Settings(0.3f));
+    CHECK(Foveation::Weight(plan, 0.5f, 0.5f) == 1.0f);
+    CHECK(Foveation::Weight(plan, 0.1f, 0.5f) == 0.0f);
+    CHECK(Foveation::Weight(plan, plan.bounds[0], 0.5f) == 0.0f);
+
+    // rising from the edge to the centre, and only where the chain rendered at full resolution
+    float previous = 0;
+    for(int i = 0; i <= 100; i++)
+    {
+        const auto w = Foveation::Weight(plan, plan.bounds[0] + (0.5f - plan.bounds[0]) * i / 100, 0.5f);
+        CHECK(w >= previous - 1e-6f);
+        previous = w;
+    }
+    for(int x = 0; x < 1920; x++)
+    {
+        if(Foveation::Weight(plan, (x + 0.5f) / 1920, 0.5f) > 0)
+            CHECK(x >= plan.fovea.left && x < plan.fovea.right);
+    }
+    for(int y = 0; y < 1080; y++)
+    {
+        if(Foveation::Weight(plan, 0.5f, (y + 0.5f) / 1080) > 0)
+            CHECK(y >= plan.fovea.top && y < plan.fovea.bottom);
+    }
+
+    // touching the edge doesn't fade there
+    plan = Foveation::Plan(sizes, 1920, 1080, 0.0f, 0.5f, Settings(0.3f));
+    CHECK(Foveation::Weight(plan, 0.001f, 0.5f) == 1.0f);
+}
+
+TEST(CorpusFoveation)
+{
+    // every preset planned for a 1080p capture to 4K with the gaze at a few places; reports the
+    // pixels foveated rendering shades (scissored chain, periphery chain and the composite)
+    // against the chain at full resolution, which only pays off where most of the work is in
+    // passes scaled to the viewport: the periphery keeps passes at source scale as they are
+    const FoveaSettings           settings = Settings(0.35f, 0.5f);
+    const uint32_t                width = 3840, height = 2160;
+    const auto [pw, ph]                    = Foveation::PeripherySize(width, height, settings);
+    std::vector<double>           shares;
+    size_t                        gated = 0;
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        RenderGraph graph(preset.Passes(), preset.textures);
+        const auto  full      = graph.Plan(1920, 1080, width, height, false);
+        const auto  periphery = graph.Plan(1920, 1080, pw, ph, false);
+        double      share     = 0;
+        for(const auto& gaze : {std::make_pair(0.5f, 0.5f), std::make_pair(0.05f, 0.1f), std::make_pair(1.0f, 0.7f)})
+        {
+            const auto plan = Foveation::Plan(full.passSizes, width, height, gaze.first, gaze.second, settings);
+            CheckScissors(full.passSizes, plan, settings.margin, preset.Label());
+            CHECK_MSG(Foveation::Pixels(plan.scissors) <= Foveation::Pixels(full.passSizes), preset.Label());
+            const auto pixels = Foveation::Pixels(plan.scissors) + Foveation::Pixels(periphery.passSizes) + static_cast<uint64_t>(width) * height;
+            share += pixels / (double)Foveation::Pixels(full.passSizes) / 3;
+        }
+        shares.push_back(share);
+
+        // ShaderGlass only foveates presets it makes clearly cheaper, whether it was foveating before or not
+        const auto gate = Foveation::Share(full.passSizes, periphery.passSizes, width, height, settings);
+        CHECK_MSG(gate >= share - 1e-9, preset.Label()); // the centred fovea is the costliest
+        if(share >= 1)
+            CHECK_MSG(!Foveation::Pays(gate, false) && !Foveation::Pays(gate, true), preset.Label());
+        gated += Foveation::Pays(gate, false);
+    }
+    std::sort(shares.begin(), shares.end());
+    const auto fewer = std::count_if(shares.begin(), shares.end(), [](double s) { return s < 1; });
+    printf("  foveated pixel work against full: median %.0f%%, best %.0f%%, worst %.0f%%, less in %lld of %zu presets, %zu foveated\n",
+           100 * shares[shares.size() / 2],
+           100 * shares.front(),
+           100 * shares.back(),
+           static_cast<long long>(fewer),
+           shares.size(),
+           gated);
+    CHECK(gated > 0 && gated <= static_cast<size_t>(fewer));
+}
+
+TEST(FoveationBenchmark)
+{
+    // a 9-tap filter per shaded pixel standing in for the GPU: four passes at 1080p against
+    // a half resolution periphery, the scissored chain and the composite; taps are what's
+    // compared, the time is only reported as it depends on whatever else the machine runs
+    struct Work
+    {
+        double   ms {0};
+        uint64_t taps {0};
+    };
+    auto run = [](const std::vector<PassSize>& chain, const std::vector<FoveaRect>* scissors, Work& work) {
+        std::vector<float> a(1920 * 1080, 1.0f), b(a.size());
+        const auto         start = std::chrono::steady_clock::now();
+        for(size_t p = 0; p < chain.size(); p++)
+        {
+            const int w = chain[p][2], h = chain[p][3];
+            const auto r = scissors ? (*scissors)[p] : FoveaRect {0, 0, w, h};
+            for(int y = std::max(1, r.top); y < std::min(h - 1, r.bottom); y++)
+                for(int x = std::max(1, r.left); x < std::min(w - 1, r.right); x++)
+                {
+                    float s = 0;
+                    for(int j = -1; j <= 1; j++)
+                        for(int i = -1; i <= 1; i++)
+                            s += a[(y + j) * w + x + i];
+                    b[y * w + x] = s / 9;
+                    work.taps += 9;
+                }
+            std::swap(a, b);
+        }
+        work.ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    const std::vector<PassSize> chain(4, PassSize {1920, 1080, 1920, 1080}), periphery(4, PassSize {960, 540, 960, 540}), composite(1, chain[0]);
+    const auto                  settings = Settings(0.35f);
+    const auto                  plan     = Foveation::Plan(chain, 1920, 1080, 0.5f, 0.5f, settings);
+    Work                        full, foveated;
+    for(int i = 0; i < 5; i++)
+    {
+        run(chain, nullptr, full);
+        run(periphery, nullptr, foveated);
+        run(chain, &plan.scissors, foveated);
+        run(composite, nullptr, foveated);
+    }
+    printf("  4 passes at 1080p: full %.1f ms, %.1f M taps; foveated %.1f ms, %.1f M taps per frame\n", full.ms / 5, full.taps / 5e6, foveated.ms / 5, foveated.taps / 5e6);
+    CHECK(foveated.taps < full.taps * 0.8);
+
+    // the gate agrees, its pixel share tracking the taps
+    const auto share = Foveation::Share(chain, periphery, 1920, 1080, settings);
+    CHECK(Foveation::Pays(share, false) && std::abs(share - foveated.taps / (double)full.taps) < 0.02);
+
+    // between the thresholds whatever was chosen stays
+    CHECK(Foveation::Pays(0.85, true) && !Foveation::Pays(0.85, false) && !Foveation::Pays(0.95, true));
+}
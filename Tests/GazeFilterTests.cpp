@@ -0,0 +1,203 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "GazeFilter.h"
+#include "GazeTraces.h"
+
+namespace
+{
+// how far the filtered gaze is from where the eye looks once the frame is on screen,
+// latency after each sample arrives: rms in screens once a fixation has settled (jitter)
+// and during pursuit, and ms after a saccade ends until the gaze is within 0.05 of it
+struct FilterError
+{
+    double jitter {0};
+    double pursuit {0};
+    double landing {0};
+};
+
+FilterError Replay(const GazeTrace& trace, const std::vector<GazeSample>& samples, const GazeFilterSettings& settings, double latency)
+{
+    const auto saccades = trace.Segments(GazeMotion::Saccade);
+    GazeFilter filter(settings);
+    double     jitter = 0, pursuit = 0, landing = 0;
+    size_t     jitterCount = 0, pursuitCount = 0, landed = 0, saccade = 0;
+    bool       pending = false;
+    for(const auto& sample : samples)
+    {
+        filter.Update(sample);
+        const auto  time      = sample.timestamp / 1000000.0 + latency;
+        const auto  predicted = filter.Predict(static_cast<int64_t>(time * 1000000));
+        const auto  truth     = trace.At(time);
+        const auto& segment   = trace.Segment(time);
+        const auto  error     = std::hypot(predicted.x - truth.x, predicted.y - truth.y);
+        if(segment.motion == GazeMotion::Fixation && time - segment.start > 0.15)
+        {
+            jitter += error * error;
+            jitterCount++;
+        }
+        else if(segment.motion == GazeMotion::Pursuit)
+        {
+            pursuit += error * error;
+            pursuitCount++;
+        }
+
+        for(; saccade < saccades.size() && saccades[saccade].end <= time; saccade++)
+            pending = true;
+        if(pending && error < 0.05)
+        {
+            landing += time - saccades[saccade - 1].end;
+            landed++;
+            pending = false;
+        }
+    }
+    return {std::sqrt(jitter / std::max<size_t>(jitterCount, 1)), std::sqrt(pursuit / std::max<size_t>(pursuitCount, 1)), 1000 * landing / std::max<size_t>(landed, 1)};
+}
+
+GazeFilterSettings Settings(GazeFilterType type, bool predict)
+{
+    GazeFilterSettings settings;
+    settings.type    = type;
+    settings.predict = predict;
+    return settings;
+}
+
+void Print(const char* name, const FilterError& e)
+{
+    printf("  %-16s jitter %.4f, pursuit %.4f, landing %.1f ms\n", name, e.jitter, e.pursuit, e.landing);
+}
+} // namespace
+
+TEST(FilterFixation)
+{
+    // a 120 Hz tracker with 0.01 screens of noise looking at one point
+    const auto trace   = GazeTrace::Fixation(0.3f, 0.6f, 10);
+    const auto samples = trace.Sample(1, 120, 0.01);
+    const auto none    = Replay(trace, samples, Settings(GazeFilterType::None, false), 0);
+    CHECK(none.jitter > 0.012);
+    for(auto type : {GazeFilterType::OneEuro, GazeFilterType::Kalman})
+    {
+        CHECK(Replay(trace, samples, Settings(type, false), 0).jitter < none.jitter * 0.75);
+        CHECK(Replay(trace, samples, Settings(type, true), 0.016).jitter < none.jitter * 0.75);
+    }
+}
+
+TEST(FilterSamplesOrder)
+{
+    GazeFilter filter;
+    CHECK(!filter.Started());
+    filter.Update({1000000, 0.2f, 0.2f});
+    CHECK(filter.Started());
+
+    // older or repeated samples are ignored
+    filter.Update({1000000, 0.9f, 0.9f});
+    filter.Update({990000, 0.9f, 0.9f});
+    auto p = filter.Predict(1000000);
+    CHECK(std::abs(p.x - 0.2f) < 1e-6f && std::abs(p.y - 0.2f) < 1e-6f);
+
+    // after tracking was lost it starts from the new sample instead of sliding over
+    filter.Update({2000000, 0.8f, 0.7f});
+    p = filter.Predict(2000000);
+    CHECK(std::abs(p.x - 0.8f) < 1e-6f && std::abs(p.y - 0.7f) < 1e-6f);
+
+    // never extrapolated off the screen or past maxPrediction
+    GazeFilterSettings settings;
+    settings.minPredictionSpeed = 0;
+    settings.maxPredictionSpeed = 100;
+    GazeFilter moving(settings);
+    for(int i = 0; i < 60; i++)
+        moving.Update({i * 16667, std::min(0.2f + i * 0.02f, 0.99f), 0.5f});
+    p = moving.Predict(59 * 16667 + 500000);
+    CHECK(p.x <= 1.0f && p.timestamp <= 59 * 16667 + 50000);
+}
+
+TEST(FilterTraces)
+{
+    // 60 Hz tracker with jittered intervals over two minutes of fixations, saccades and
+    // pursuit: the default filter steadies fixations, prediction makes up for pursuit lag,
+    // and neither holds up landing after a saccade by more than a couple of samples; the
+    // Kalman filter trades steadiness for its pursuit tracking at these settings
+    const auto trace = GazeTrace::Synthetic(1, 120, true);
+    for(unsigned seed : {2u, 3u})
+    {
+        const auto samples = trace.Sample(seed, 60, 0.008, 0.002);
+        for(double latency : {0.016, 0.033})
+        {
+            const auto none = Replay(trace, samples, Settings(GazeFilterType::None, false), latency);
+            if(seed == 2)
+            {
+                printf("  %.0f ms latency\n", latency * 1000);
+                Print("none", none);
+            }
+            for(auto type : {GazeFilterType::OneEuro, GazeFilterType::Kalman})
+            {
+                const auto smoothed  = Replay(trace, samples, Settings(type, false), latency);
+                const auto predicted = Replay(trace, samples, Settings(type, true), latency);
+                if(type == GazeFilterType::OneEuro)
+                {
+                    CHECK(smoothed.jitter < none.jitter * 0.8);
+                    CHECK(predicted.jitter < none.jitter * 0.9); // extrapolating noise costs some
+                }
+                CHECK(predicted.pursuit < none.pursuit * 0.9);
+                CHECK(predicted.landing < none.landing + 35);
+                if(seed == 2)
+                {
+                    Print(type == GazeFilterType::Kalman ? "kalman" : "one euro", smoothed);
+                    Print(type == GazeFilterType::Kalman ? "kalman+predict" : "one euro+predict", predicted);
+                }
+            }
+        }
+    }
+}
+
+namespace
+{
+// the defaults against a sweep of their parameters: none may be both steadier and land
+// sooner by a clear margin, which would make it the better default
+void Tune(const char* name, const GazeFilterSettings& defaults, const std::vector<GazeFilterSettings>& sweep)
+{
+    const auto trace   = GazeTrace::Synthetic(4, 60, true);
+    const auto samples = trace.Sample(5, 60, 0.008, 0.002);
+    const auto latency = 0.033;
+    const auto base    = Replay(trace, samples, defaults, latency);
+    Print(name, base);
+    for(const auto& settings : sweep)
+    {
+        const auto e = Replay(trace, samples, settings, latency);
+        CHECK_MSG(e.jitter > base.jitter * 0.9 || e.landing > base.landing * 0.9 || e.pursuit > base.pursuit * 0.9,
+                  std::string(name) + " dominated, jitter " + std::to_string(e.jitter) + " landing " + std::to_string(e.landing));
+    }
+}
+} // namespace
+
+TEST(FilterTuning)
+{
+    std::vector<GazeFilterSettings> euro;
+    for(float minCutoff : {0.25f, 0.5f, 1.0f, 2.0f, 4.0f})
+        for(float beta : {1.0f, 5.0f, 20.0f, 50.0f, 100.0f, 200.0f})
+            for(float derivativeCutoff : {0.5f, 1.0f, 2.0f, 5.0f})
+            {
+                GazeFilterSettings settings;
+                settings.minCutoff        = minCutoff;
+                settings.beta             = beta;
+                settings.derivativeCutoff = derivativeCutoff;
+                euro.push_back(settings);
+            }
+    Tune("one euro", {}, euro);
+
+    std::vector<GazeFilterSettings> kalman;
+    for(float acceleration : {1.0f, 2.0f, 5.0f, 10.0f, 20.0f, 50.0f, 100.0f})
+        for(float noise : {0.002f, 0.004f, 0.008f, 0.016f, 0.03f})
+        {
+            auto settings         = Settings(GazeFilterType::Kalman, true);
+            settings.acceleration = acceleration;
+            settings.noise        = noise;
+            kalman.push_back(settings);
+        }
+    Tune("kalman", Settings(GazeFilterType::Kalman, true), kalman);
+}
@@ -0,0 +1,177 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "GazeRing.h"
+
+#include <limits>
+#include <memory>
+#include <thread>
+
+namespace
+{
+std::unique_ptr<GazeRing> MakeRing()
+{
+    auto ring = std::make_unique<GazeRing>();
+    ring->Initialize();
+    return ring;
+}
+
+GazeSample Sample(int64_t n)
+{
+    return {n, static_cast<float>(n), static_cast<float>(n) * 2};
+}
+} // namespace
+
+TEST(GazeRingOrder)
+{
+    auto                    ring = MakeRing();
+    GazeReader              reader;
+    std::vector<GazeSample> samples;
+    CHECK(reader.Read(*ring, samples) == 0);
+
+    for(int64_t n = 0; n < 10; n++)
+        ring->Write(Sample(n));
+    CHECK(reader.Read(*ring, samples) == 10 && samples.front().timestamp == 0 && samples.back().timestamp == 9);
+    CHECK(reader.Read(*ring, samples) == 0); // every sample once
+
+    // a reader falling behind gets the newest CAPACITY samples, still in order
+    samples.clear();
+    for(int64_t n = 10; n < 10 + 3 * GazeRing::CAPACITY; n++)
+        ring->Write(Sample(n));
+    CHECK(reader.Read(*ring, samples) == GazeRing::CAPACITY);
+    CHECK(samples.front().timestamp == 10 + 2 * GazeRing::CAPACITY && samples.back().timestamp == 9 + 3 * GazeRing::CAPACITY);
+
+    // producer restarting is picked up from its first sample
+    ring->Initialize();
+    ring->Write(Sample(1000));
+    samples.clear();
+    CHECK(reader.Read(*ring, samples) == 1 && samples[0].timestamp == 1000);
+}
+
+TEST(GazeRingNonFinite)
+{
+    auto       ring = MakeRing();
+    const auto nan  = std::numeric_limits<float>::quiet_NaN();
+    const auto inf  = std::numeric_limits<float>::infinity();
+    ring->Write({1, 0.5f, 0.5f});
+    ring->Write({2, nan, 0.5f});
+    ring->Write({3, 0.5f, -inf});
+    ring->Write({4, inf, nan});
+    ring->Write({5, 0.25f, 0.75f});
+
+    GazeReader              reader;
+    std::vector<GazeSample> samples;
+    CHECK(reader.Read(*ring, samples) == 2 && samples[0].timestamp == 1 && samples[1].timestamp == 5);
+}
+
+TEST(GazeBindingWindow)
+{
+    // 1000x600 window at (460, 240) on a 1920x1080 screen
+    auto p = GazeBinding::ToWindow({0, 0.5f, 0.5f}, 1920, 1080, 460, 240, 1000, 600);
+    CHECK(std::abs(p.first - 0.5f) < 1e-6f && std::abs(p.second - 0.5f) < 1e-6f);
+    p = GazeBinding::ToWindow({0, 460 / 1920.0f, 840 / 1080.0f}, 1920, 1080, 460, 240, 1000, 600);
+    CHECK(std::abs(p.first) < 1e-6f && std::abs(p.second - 1.0f) < 1e-6f);
+    p = GazeBinding::ToWindow({0, 0.0f, 1.0f}, 1920, 1080, 460, 240, 1000, 600);
+    CHECK(p.first == 0.0f && p.second == 1.0f); // sticks to the edge
+    p = GazeBinding::ToWindow({0, 0.9f, 0.1f}, 1920, 1080, 460, 240, 0, 0);
+    CHECK(p.first == 0.5f && p.second == 0.5f); // no window yet
+}
+
+TEST(GazeSampleToUniform)
+{
+    // tracker writing at 1 kHz while frames poll the ring, bind the newest sample to the
+    // window and store it as the uniform value; no sample may be torn or out of order and
+    // the uniform trails the tracker by about a frame
+    auto              ring = MakeRing();
+    std::atomic<bool> done {false};
+    const int64_t     total = 1000;
+    std::thread       tracker([&] {
+        for(int64_t n = 0; n < total; n++)
+        {
+            ring->Write({GazeSample::Now(), (n % 1000) / 1000.0f, 1.0f - (n % 1000) / 1000.0f});
+            std::this_thread::sleep_for(std::chrono::microseconds(1000));
+        }
+        done = true;
+    });
+
+    GazeReader              reader;
+    std::vector<GazeSample> samples;
+    std::vector<int64_t>    latencies;
+    size_t                  received = 0, torn = 0, unordered = 0;
+    int64_t                 last     = 0;
+    float                   uniform  = 0;
+    while(!done)
+    {
+        samples.clear();
+        reader.Read(*ring, samples);
+        for(const auto& s : samples)
+        {
+            torn += std::abs(s.x + s.y - 1.0f) > 1e-5f;
+            unordered += s.timestamp <= last;
+            last = s.timestamp;
+        }
+        received += samples.size();
+        if(samples.size())
+        {
+            uniform = GazeBinding::ToWindow(samples.back(), 1920, 1080, 0, 0, 1920, 1080).first;
+            latencies.push_back(GazeSample::Now() - samples.back().timestamp);
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(4000)); // 250 fps
+    }
+    tracker.join();
+
+    CHECK(torn == 0 && unordered == 0);
+    CHECK(received > total * 9 / 10 && received <= static_cast<size_t>(total));
+    CHECK(uniform >= 0 && uniform <= 1);
+    CHECK(!latencies.empty());
+    if(latencies.empty())
+        return;
+
+    std::sort(latencies.begin(), latencies.end());
+    const auto median = latencies[latencies.size() / 2];
+    printf("  %zu of %lld samples, sample to uniform median %.2f ms, max %.2f ms over %zu frames\n",
+           received,
+           static_cast<long long>(total),
+           median / 1000.0,
+           latencies.back() / 1000.0,
+           latencies.size());
+    CHECK(median < 20000); // within a frame, with scheduling slack
+}
+
+TEST(GazeRingConcurrent)
+{
+    // a writer flat out against a reader, every sample handed out must be whole
+    auto              ring = MakeRing();
+    std::atomic<bool> done {false};
+    std::thread       writer([&] {
+        for(int64_t n = 1; n <= 500000; n++)
+            ring->Write(Sample(n));
+        done = true;
+    });
+
+    GazeReader              reader;
+    std::vector<GazeSample> samples;
+    size_t                  received = 0, torn = 0, unordered = 0;
+    int64_t                 last     = 0;
+    for(bool finished = false; !finished;)
+    {
+        finished = done;
+        samples.clear();
+        reader.Read(*ring, samples);
+        for(const auto& s : samples)
+        {
+            torn += s.x != static_cast<float>(s.timestamp) || s.y != s.x * 2;
+            unordered += s.timestamp <= last;
+            last = s.timestamp;
+        }
+        received += samples.size();
+    }
+    writer.join();
+    CHECK(torn == 0 && unordered == 0);
+    CHECK(last == 500000 && received > 0);
+}
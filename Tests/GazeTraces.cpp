@@ -0,0 +1,148 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "GazeTraces.h"
+
+#include <random>
+
+GazeTrace GazeTrace::Synthetic(unsigned seed, double length, bool pursuit)
+{
+    std::mt19937                           random(seed);
+    std::uniform_real_distribution<double> uniform(0, 1);
+    GazeTrace                              trace;
+    double                                 t = 0;
+    float                                  x = 0.5f, y = 0.5f;
+    while(t < length)
+    {
+        const auto fixation = 0.15 + uniform(random) * 0.45;
+        trace.m_segments.push_back({t, t + fixation, x, y, x, y, GazeMotion::Fixation});
+        t += fixation;
+
+        if(pursuit && uniform(random) < 0.2)
+        {
+            const auto duration = 0.8 + uniform(random);
+            const auto angle    = uniform(random) * 6.2832;
+            const auto speed    = 0.15 + uniform(random) * 0.25;
+            const auto nx       = static_cast<float>(std::clamp(x + std::cos(angle) * speed * duration, 0.05, 0.95));
+            const auto ny       = static_cast<float>(std::clamp(y + std::sin(angle) * speed * duration, 0.05, 0.95));
+            trace.m_segments.push_back({t, t + duration, x, y, nx, ny, GazeMotion::Pursuit});
+            t += duration;
+            x = nx;
+            y = ny;
+            continue;
+        }
+
+        float nx, ny, amplitude;
+        do
+        {
+            nx        = static_cast<float>(0.05 + uniform(random) * 0.9);
+            ny        = static_cast<float>(0.05 + uniform(random) * 0.9);
+            amplitude = std::hypot(nx - x, ny - y);
+        } while(amplitude < 0.03f);
+        // main sequence, 21 ms + 2.2 ms per degree with the screen 40 degrees across
+        const auto duration = 0.021 + 0.0022 * amplitude * 40;
+        trace.m_segments.push_back({t, t + duration, x, y, nx, ny, GazeMotion::Saccade});
+        t += duration;
+        x = nx;
+        y = ny;
+    }
+    trace.m_length = t;
+    return trace;
+}
+
+GazeTrace GazeTrace::Fixation(float x, float y, double length)
+{
+    GazeTrace trace;
+    trace.m_segments.push_back({0, length, x, y, x, y, GazeMotion::Fixation});
+    trace.m_length = length;
+    return trace;
+}
+
+const GazeSegment& GazeTrace::Segment(double time) const
+{
+    auto it = std::upper_bound(m_segments.begin(), m_segments.end(), time, [](double t, const GazeSegment& s) { return t < s.end; });
+    return it == m_segments.end() ? m_segments.back() : *it;
+}
+
+GazeSample GazeTrace::At(double time) const
+{
+    const auto& segment = Segment(time);
+    auto        k       = std::clamp((time - segment.start) / (segment.end - segment.start), 0.0, 1.0);
+    if(segment.motion == GazeMotion::Saccade)
+        k = k * k * k * (10 - 15 * k + 6 * k * k);
+
+    GazeSample sample;
+    sample.timestamp = static_cast<int64_t>(std::llround(time * 1000000));
+    sample.x         = static_cast<float>(segment.x0 + (segment.x1 - segment.x0) * k);
+    sample.y         = static_cast<float>(segment.y0 + (segment.y1 - segment.y0) * k);
+    return sample;
+}
+
+std::vector<GazeSample> GazeTrace::Sample(unsigned seed, double rate, double noise, double jitter) const
+{
+    std::mt19937                           random(seed);
+    std::normal_distribution<float>        error(0, static_cast<float>(noise));
+    std::uniform_real_distribution<double> delay(-jitter, jitter);
+    std::vector<GazeSample>                samples;
+    for(double t = 0; t < m_length; t += std::max(1 / rate + delay(random), 0.001))
+    {
+        auto sample = At(t);
+        sample.x += error(random);
+        sample.y += error(random);
+        samples.push_back(sample);
+    }
+    return samples;
+}
+
+std::vector<GazeSample> GazeTrace::Webcam(unsigned seed) const
+{
+    const double pixels = 100;   // camera pixels the eye covers across the screen
+    const double dt     = 0.033; // the tracker assumes a steady frame rate
+    const double q      = 0.01;
+    const double r      = 5;
+
+    std::mt19937                     random(seed);
+    std::normal_distribution<double> jitter(0, 0.004), error(0, 1.5);
+    std::vector<GazeSample>          samples;
+    double                           x[2] {}, v[2] {}, p00[2] {1000, 1000}, p01[2] {}, p11[2] {1000, 1000};
+    for(double t = 0; t < m_length; t += dt + jitter(random))
+    {
+        const auto truth = At(t);
+        const double z[2] {truth.x * pixels + error(random), truth.y * pixels + error(random)};
+        for(int a = 0; a < 2; a++)
+        {
+            if(samples.empty())
+                x[a] = z[a];
+            x[a] += v[a] * dt;
+            const auto n00 = p00[a] + dt * (2 * p01[a] + dt * p11[a]) + q;
+            const auto n01 = p01[a] + dt * p11[a];
+            const auto n11 = p11[a] + q;
+            const auto s   = n00 + r;
+            const auto k0  = n00 / s;
+            const auto k1  = n01 / s;
+            const auto y   = z[a] - x[a];
+            x[a] += k0 * y;
+            v[a] += k1 * y;
+            p00[a] = n00 - k0 * n00;
+            p01[a] = n01 - k0 * n01;
+            p11[a] = n11 - k1 * n01;
+        }
+        samples.push_back({truth.timestamp, static_cast<float>(x[0] / pixels), static_cast<float>(x[1] / pixels)});
+    }
+    return samples;
+}
+
+std::vector<GazeSegment> GazeTrace::Segments(GazeMotion motion) const
+{
+    std::vector<GazeSegment> segments;
+    for(const auto& s : m_segments)
+    {
+        if(s.motion == motion)
+            segments.push_back(s);
+    }
+    return segments;
+}
@@ -0,0 +1,63 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "GazeRing.h"
+
+enum class GazeMotion
+{
+    Fixation,
+    Saccade,
+    Pursuit
+};
+
+// stretch of a trace moving from (x0, y0) to (x1, y1), times in seconds
+struct GazeSegment
+{
+    double     start;
+    double     end;
+    float      x0;
+    float      y0;
+    float      x1;
+    float      y1;
+    GazeMotion motion;
+};
+
+// where the eye really looks over time: fixations of 150-600 ms joined by saccades with the
+// main sequence duration and minimum jerk profile, and with pursuit set a fifth of the moves
+// smooth pursuit at 0.15-0.4 screens/s instead; the same seed always gives the same trace
+class GazeTrace
+{
+public:
+    static GazeTrace Synthetic(unsigned seed, double length, bool pursuit);
+
+    // a single fixation at (x, y)
+    static GazeTrace Fixation(float x, float y, double length);
+
+    GazeSample         At(double time) const;
+    const GazeSegment& Segment(double time) const;
+
+    // what a tracker at rate Hz reports: the true gaze plus noise, interval jittered by up to
+    // jitter seconds, stamped when it was seen
+    std::vector<GazeSample> Sample(unsigned seed, double rate, double noise, double jitter = 0) const;
+
+    // as a webcam tracker sends it: ~30 Hz, smoothed by its own constant velocity Kalman filter
+    // in camera pixels, which lags and overshoots; stands in for a recording of one
+    std::vector<GazeSample> Webcam(unsigned seed) const;
+
+    std::vector<GazeSegment> Segments(GazeMotion motion) const;
+
+    double Length() const
+    {
+        return m_length;
+    }
+
+private:
+    std::vector<GazeSegment> m_segments;
+    double                   m_length {0};
+};
@@ -0,0 +1,148 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "ParamSlots.h"
+#include "PresetCorpus.h"
+
+#include <array>
+#include <cstring>
+#include <set>
+
+namespace
+{
+bool Same(const ParamSlot& a, const ParamSlot& b)
+{
+    return a.push == b.push && a.ubo == b.ubo;
+}
+
+// params written through slots the way Shader::SetParam does it, into one byte buffer per kind
+struct ParamBuffers
+{
+    ParamBuffers(ShaderDef& def) : params {def.Params}, push(def.ParamsSize(PUSH_BUFFER)), ubo(def.ParamsSize(UBO_BUFFER)) { }
+
+    void Write(const ParamSlot& slot, const void* v)
+    {
+        if(slot.push >= 0)
+            memcpy(push.data() + params[slot.push].offset, v, params[slot.push].size);
+        if(slot.ubo >= 0)
+            memcpy(ubo.data() + params[slot.ubo].offset, v, params[slot.ubo].size);
+    }
+
+    bool Holds(const ParamSlot& slot, const void* v) const
+    {
+        return (slot.push < 0 || memcmp(push.data() + params[slot.push].offset, v, params[slot.push].size) == 0) &&
+               (slot.ubo < 0 || memcmp(ubo.data() + params[slot.ubo].offset, v, params[slot.ubo].size) == 0);
+    }
+
+    const std::vector<ShaderParam>& params;
+    std::vector<uint8_t>            push;
+    std::vector<uint8_t>            ubo;
+};
+
+// bytes only this name writes, most likely
+std::array<uint8_t, 64> Fill(const std::string& name)
+{
+    std::array<uint8_t, 64> value;
+    value.fill(static_cast<uint8_t>(std::hash<std::string> {}(name) % 255 + 1));
+    return value;
+}
+} // namespace
+
+TEST(ParamSlotResolution)
+{
+    ShaderDef def;
+    def.AddParam("MVP", UBO_BUFFER, 0, 64, 0, 0, 0);
+    def.AddParam("SourceSize", PUSH_BUFFER, 0, 16, 0, 0, 0);
+    def.AddParam("OutputSize", UBO_BUFFER, 64, 16, 0, 0, 0);
+    def.AddParam("FrameCount", PUSH_BUFFER, 16, 4, 0, 0, 0);
+    def.AddParam("SourceSize", UBO_BUFFER, 80, 16, 0, 0, 0);
+    def.AddParam("PassOutputSize2", PUSH_BUFFER, 32, 16, 0, 0, 0);
+    def.AddParam("PassOutputSize10", UBO_BUFFER, 96, 16, 0, 0, 0);
+    def.AddParam("LUTSize", PUSH_BUFFER, 48, 16, 0, 0, 0);
+    def.AddParam("PassOutputSizeX", UBO_BUFFER, 112, 16, 0, 0, 0); // not a pass
+    def.AddParam("gamma", UBO_BUFFER, 128, 4, 1.0f, 3.0f, 2.2f);
+    def.AddParam("Size", PUSH_BUFFER, 20, 4, 0, 1, 0);
+
+    const ParamSlots slots(def.Params);
+    CHECK(slots.MVP().push == -1 && slots.MVP().ubo == 0);
+    CHECK(slots.SourceSize().push == 1 && slots.SourceSize().ubo == 4);
+    CHECK(slots.OutputSize().push == -1 && slots.OutputSize().ubo == 2);
+    CHECK(slots.FrameCount().push == 3 && slots.FrameCount().ubo == -1);
+    CHECK(Same(slots.Find("gamma"), {-1, 9}));
+    CHECK(Same(slots.Find("missing"), {}));
+
+    // PassOutputSize<n> by pass, gaps unset
+    CHECK(slots.PassOutputSizes().size() == 11);
+    CHECK(Same(slots.PassOutputSizes()[2], {5, -1}));
+    CHECK(Same(slots.PassOutputSizes()[10], {-1, 6}));
+    CHECK(Same(slots.PassOutputSizes()[0], {}));
+
+    // every other <name>Size once, in declaration order; Size alone names no texture
+    std::vector<std::string> names;
+    for(const auto& ts : slots.TextureSizes())
+        names.push_back(ts.first);
+    CHECK((names == std::vector<std::string> {"Source", "Output", "LUT"}));
+    CHECK(Same(slots.TextureSizes()[0].second, slots.SourceSize()));
+
+    // floats other than FrameCount
+    CHECK((slots.UserParams() == std::vector<int> {9, 10}));
+
+    const ParamSlots empty;
+    CHECK(Same(empty.FrameCount(), {}) && empty.TextureSizes().empty() && empty.UserParams().empty());
+}
+
+TEST(CorpusParamSlots)
+{
+    size_t shaders = 0, shared = 0;
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        for(auto pass : preset.passes)
+        {
+            const ParamSlots slots(pass.Params);
+            const auto       label = preset.Label() + " " + pass.Name;
+            shaders++;
+
+            // each name resolves to its own params in the right buffers
+            std::set<std::string> names;
+            for(int i = 0; i < pass.Params.size(); i++)
+            {
+                const auto& p    = pass.Params[i];
+                const auto  slot = slots.Find(p.name);
+                CHECK_MSG((p.buffer == PUSH_BUFFER ? slot.push : slot.ubo) == i, label + " " + p.name);
+                if(p.buffer == UBO_BUFFER && slot.push >= 0)
+                {
+                    CHECK_MSG(pass.Params[slot.push].size == pass.Params[slot.ubo].size, label + " " + p.name);
+                    shared++;
+                }
+                names.insert(p.name);
+            }
+            CHECK_MSG(Same(slots.MVP(), slots.Find("MVP")), label);
+            CHECK_MSG(Same(slots.FrameCount(), slots.Find("FrameCount")), label);
+            CHECK_MSG(Same(slots.SourceSize(), slots.Find("SourceSize")), label);
+            CHECK_MSG(Same(slots.OutputSize(), slots.Find("OutputSize")), label);
+            for(size_t n = 0; n < slots.PassOutputSizes().size(); n++)
+            {
+                const auto slot = slots.PassOutputSizes()[n];
+                CHECK_MSG(Same(slot, slots.Find("PassOutputSize" + std::to_string(n))), label);
+            }
+            for(const auto& ts : slots.TextureSizes())
+                CHECK_MSG(Same(ts.second, slots.Find(ts.first + "Size")), label + " " + ts.first);
+            for(auto i : slots.UserParams())
+                CHECK_MSG(pass.Params[i].size == 4 && pass.Params[i].name != "FrameCount", label);
+
+            // a distinct value written to every uniform through its slot survives all the other writes
+            ParamBuffers buffers(pass);
+            for(const auto& name : names)
+                buffers.Write(slots.Find(name), Fill(name).data());
+            for(const auto& name : names)
+                CHECK_MSG(buffers.Holds(slots.Find(name), Fill(name).data()), label + " " + name);
+        }
+    }
+    std::printf("  %zu shaders, %zu uniforms in both buffers\n", shaders, shared);
+    CHECK(shaders > 0 && shared > 0);
+}
@@ -0,0 +1,302 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "PresetCorpus.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <unordered_map>
+
+namespace
+{
+std::string ReadText(const std::filesystem::path& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void SkipSpace(const std::string& text, size_t& pos)
+{
+    while(pos < text.size() && std::isspace((unsigned char)text[pos]))
+        pos++;
+}
+
+bool Expect(const std::string& text, size_t& pos, const char* token)
+{
+    SkipSpace(text, pos);
+    const auto length = std::strlen(token);
+    if(text.compare(pos, length, token) != 0)
+        return false;
+    pos += length;
+    return true;
+}
+
+// C string literal at pos, escapes resolved
+bool Literal(const std::string& text, size_t& pos, std::string& value)
+{
+    if(!Expect(text, pos, "\""))
+        return false;
+    value.clear();
+    for(; pos < text.size() && text[pos] != '"'; pos++)
+    {
+        if(text[pos] == '\\' && pos + 1 < text.size())
+            pos++;
+        value.push_back(text[pos]);
+    }
+    return pos++ < text.size();
+}
+
+std::string Identifier(const std::string& text, size_t& pos)
+{
+    SkipSpace(text, pos);
+    const auto start = pos;
+    while(pos < text.size() && (std::isalnum((unsigned char)text[pos]) || text[pos] == '_'))
+        pos++;
+    return text.substr(start, pos - start);
+}
+
+// value of the first `key = "value"` assignment after pos
+std::string Assigned(const std::string& text, size_t pos, const char* key)
+{
+    std::string value;
+    for(pos = text.find(key, pos); pos != std::string::npos; pos = text.find(key, pos + 1))
+    {
+        auto end = pos + std::strlen(key);
+        if((pos == 0 || !std::isalnum((unsigned char)text[pos - 1])) && Expect(text, end, "=") && Literal(text, end, value))
+            break;
+    }
+    return value;
+}
+
+// one generated XShaderDef class: name, format, frame analysis, parameters and samplers
+bool ParseShader(const std::string& text, std::string& className, ShaderDef& def, std::deque<std::string>& formats)
+{
+    auto pos = text.rfind("\nclass ");
+    if(pos == std::string::npos)
+        return false;
+    pos += 7;
+    className = Identifier(text, pos);
+
+    def.Name = Assigned(text, pos, "Name");
+    formats.push_back(Assigned(text, pos, "Format"));
+    def.Format = formats.back().data();
+
+    const auto frame = text.find("FrameDependent", pos);
+    if(frame != std::string::npos)
+        def.FrameDependent = std::atoi(text.c_str() + text.find('=', frame) + 1);
+
+    for(auto p = text.find("AddParam(", pos); p != std::string::npos; p = text.find("AddParam(", p))
+    {
+        p += 9;
+        std::string name;
+        Literal(text, p, name);
+        char* end    = nullptr;
+        auto  buffer = (int)std::strtol(text.c_str() + p + 1, &end, 10);
+        auto  offset = (int)std::strtol(end + 1, &end, 10);
+        auto  size   = (int)std::strtol(end + 1, &end, 10);
+        def.AddParam(name.c_str(), buffer, offset, size, 0.0f, 0.0f, 0.0f);
+    }
+    for(auto p = text.find("AddSampler(", pos); p != std::string::npos; p = text.find("AddSampler(", p))
+    {
+        p += 11;
+        std::string name;
+        Literal(text, p, name);
+        def.AddSampler(name.c_str(), std::atoi(text.c_str() + p + 1));
+    }
+    return !className.empty();
+}
+
+// words of a `static const uint32_t <name>[] = {...}` array
+bool HashArray(const std::string& text, const char* name, std::array<uint32_t, 8>& hash)
+{
+    auto pos = text.find(name);
+    if(pos == std::string::npos || (pos = text.find('{', pos)) == std::string::npos)
+        return false;
+    const char* p = text.c_str() + pos + 1;
+    for(auto& word : hash)
+    {
+        char* end = nullptr;
+        word      = (uint32_t)std::strtoul(p, &end, 16);
+        if(end == p)
+            return false;
+        p = end + 1;
+    }
+    return true;
+}
+
+// .Param("key", "value") chain following a push_back(XDef()
+std::vector<std::pair<std::string, std::string>> ParamChain(const std::string& text, size_t& pos)
+{
+    std::vector<std::pair<std::string, std::string>> params;
+    std::string                                      key, value;
+    while(Expect(text, pos, ".Param(") && Literal(text, pos, key) && Expect(text, pos, ",") && Literal(text, pos, value) && Expect(text, pos, ")"))
+        params.emplace_back(key, value);
+    return params;
+}
+} // namespace
+
+std::vector<const ShaderDef*> CorpusPreset::Passes() const
+{
+    std::vector<const ShaderDef*> defs;
+    for(const auto& pass : passes)
+        defs.push_back(&pass);
+    return defs;
+}
+
+std::string CorpusPreset::Label() const
+{
+    return category + "/" + name;
+}
+
+const PresetCorpus& PresetCorpus::Get()
+{
+    static const PresetCorpus corpus;
+    return corpus;
+}
+
+PresetCorpus::PresetCorpus()
+{
+    std::vector<std::filesystem::path> shaderFiles, presetFiles;
+    for(const auto& entry : std::filesystem::recursive_directory_iterator(SHADERS_DIR))
+    {
+        const auto fileName = entry.path().filename().string();
+        if(fileName.ends_with("ShaderDef.h"))
+            shaderFiles.push_back(entry.path());
+        else if(fileName.ends_with("PresetDef.h"))
+            presetFiles.push_back(entry.path());
+    }
+    std::sort(presetFiles.begin(), presetFiles.end());
+
+    std::unordered_map<std::string, ShaderDef> shaders;
+    for(const auto& path : shaderFiles)
+    {
+        std::string className;
+        ShaderDef   def;
+        const auto  text = ReadText(path);
+        if(ParseShader(text, className, def, m_formats))
+            shaders.emplace(className, def);
+
+        std::array<uint32_t, 8> hash;
+        for(const auto* name : {"sVertexHash[]", "sFragmentHash[]"})
+        {
+            if(HashArray(text, name, hash))
+                m_hashes.push_back(hash);
+        }
+    }
+
+    for(const auto& path : presetFiles)
+    {
+        const auto text  = ReadText(path);
+        auto       build = text.find("void Build()");
+        if(build == std::string::npos)
+            continue;
+
+        CorpusPreset preset;
+        preset.name     = Assigned(text, 0, "Name");
+        preset.category = Assigned(text, 0, "Category");
+
+        auto                  resolved = true;
+        std::set<std::string> textures;
+        for(auto pos = text.find(".push_back(", build); pos != std::string::npos; pos = text.find(".push_back(", pos))
+        {
+            const auto isShader  = text.compare(pos - 10, 10, "ShaderDefs") == 0;
+            pos                 += 11;
+            const auto className = Identifier(text, pos);
+            Expect(text, pos, "()");
+            const auto params = ParamChain(text, pos);
+            if(isShader)
+            {
+                auto shader = shaders.find(className);
+                if(shader == shaders.end())
+                {
+                    resolved = false;
+                    continue;
+                }
+                preset.passes.push_back(shader->second);
+                for(const auto& param : params)
+                    preset.passes.back().Param(param.first.c_str(), param.second.c_str());
+            }
+            else
+            {
+                preset.textureClasses.push_back(className);
+                for(const auto& param : params)
+                {
+                    if(param.first == "name")
+                        textures.insert(param.second);
+                }
+            }
+        }
+        preset.textures.assign(textures.begin(), textures.end());
+
+        if(resolved && !preset.passes.empty())
+            m_presets.push_back(std::move(preset));
+        else
+            m_unresolved++;
+    }
+}
+
+const TextureCorpus& TextureCorpus::Get()
+{
+    static const TextureCorpus corpus;
+    return corpus;
+}
+
+TextureCorpus::TextureCorpus()
+{
+    for(const auto& entry : std::filesystem::recursive_directory_iterator(SHADERS_DIR))
+    {
+        if(!entry.path().filename().string().ends_with("TextureDef.h"))
+            continue;
+
+        const auto text = ReadText(entry.path());
+        auto       pos  = text.rfind("\nclass ");
+        auto       data = text.find("sData[]");
+        if(pos == std::string::npos || data == std::string::npos || (data = text.find('{', data)) == std::string::npos)
+            continue;
+        pos += 7;
+
+        // decimal bytes separated by commas and line breaks
+        std::vector<uint8_t> bytes;
+        const char*          p   = text.c_str() + data + 1;
+        const char*          end = text.c_str() + text.find('}', data);
+        while(p < end)
+        {
+            if(std::isdigit((unsigned char)*p))
+            {
+                unsigned value = 0;
+                while(std::isdigit((unsigned char)*p))
+                    value = value * 10 + (*p++ - '0');
+                bytes.push_back((uint8_t)value);
+            }
+            else
+                p++;
+        }
+        m_data.emplace(Identifier(text, pos), std::move(bytes));
+    }
+}
+
+const std::vector<uint8_t>* TextureCorpus::Data(const std::string& className) const
+{
+    auto it = m_data.find(className);
+    return it == m_data.end() ? nullptr : &it->second;
+}
+
+ShaderDef MakeShader(const std::string& name, const std::vector<std::string>& samplers, int frameDependent)
+{
+    ShaderDef def;
+    def.Name           = name;
+    def.FrameDependent = frameDependent;
+    int binding        = 2;
+    for(const auto& sampler : samplers)
+        def.AddSampler(sampler.c_str(), binding++);
+    return def;
+}
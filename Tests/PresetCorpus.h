@@ -0,0 +1,84 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#pragma once
+
+#include "ShaderDef.h"
+
+#include <array>
+#include <deque>
+#include <map>
+
+// a built-in preset as ShaderGlass resolves it, with pass definitions carrying their preset params
+struct CorpusPreset
+{
+    std::string              category;
+    std::string              name;
+    std::vector<ShaderDef>   passes;
+    std::vector<std::string> textures;       // sorted like ShaderGlass' preset texture map
+    std::vector<std::string> textureClasses; // generated TextureDef classes in the order Build() adds them
+
+    std::vector<const ShaderDef*> Passes() const;
+    std::string                   Label() const;
+};
+
+// the generated RetroArch preset and shader headers, read as text: compiling them all takes the
+// bytecode of every shader, and only names, params, samplers and formats matter to the render graph
+class PresetCorpus
+{
+public:
+    // parsed once per process
+    static const PresetCorpus& Get();
+
+    const std::vector<CorpusPreset>& Presets() const
+    {
+        return m_presets;
+    }
+
+    // presets left out as they reference a shader with no header
+    size_t Unresolved() const
+    {
+        return m_unresolved;
+    }
+
+    // vertex and fragment hashes of every shader header, the set ShaderCache looks bytecode up in
+    const std::deque<std::array<uint32_t, 8>>& Hashes() const
+    {
+        return m_hashes;
+    }
+
+private:
+    PresetCorpus();
+
+    std::vector<CorpusPreset>           m_presets;
+    std::deque<std::string>             m_formats; // ShaderDef::Format points into these
+    std::deque<std::array<uint32_t, 8>> m_hashes;
+    size_t                              m_unresolved {0};
+};
+
+// the generated texture headers' image data, parsed on first use as it is most of the corpus
+class TextureCorpus
+{
+public:
+    static const TextureCorpus& Get();
+
+    // encoded PNG or JPEG of a TextureDef class, nullptr if there is no such header
+    const std::vector<uint8_t>* Data(const std::string& className) const;
+
+    size_t Count() const
+    {
+        return m_data.size();
+    }
+
+private:
+    TextureCorpus();
+
+    std::map<std::string, std::vector<uint8_t>> m_data;
+};
+
+// shader definition with the given samplers, for building chains by hand
+ShaderDef MakeShader(const std::string& name, const std::vector<std::string>& samplers, int frameDependent = 0);
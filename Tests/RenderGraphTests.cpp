@@ -0,0 +1,686 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "PresetCorpus.h"
+#include "RenderGraph.h"
+
+#include <algorithm>
+#include <tuple>
+
+namespace
+{
+struct PlanCase
+{
+    uint32_t originalWidth;
+    uint32_t originalHeight;
+    uint32_t viewportWidth;
+    uint32_t viewportHeight;
+    bool     vertical;
+};
+
+// a downscaled capture, a native one to a 4K window, a rotated one and a tiny one
+const PlanCase sPlanCases[] = {{320, 240, 1280, 960, false}, {1920, 1080, 3840, 2160, false}, {256, 224, 1080, 1920, true}, {1, 1, 7, 5, false}};
+
+std::string Describe(const CorpusPreset& preset, const PlanCase& c)
+{
+    return preset.Label() + " " + std::to_string(c.originalWidth) + "x" + std::to_string(c.originalHeight) + "->" + std::to_string(c.viewportWidth) + "x" +
+           std::to_string(c.viewportHeight) + (c.vertical ? " vertical" : "");
+}
+
+ShaderDef& Scaled(ShaderDef& def, const char* type, const char* scale)
+{
+    return def.Param("scale_type", type).Param("scale", scale);
+}
+} // namespace
+
+TEST(CorpusLoads)
+{
+    const auto& corpus = PresetCorpus::Get();
+    std::printf("  %zu presets, %zu with shaders missing from the tree\n", corpus.Presets().size(), corpus.Unresolved());
+    CHECK(corpus.Presets().size() > 2000);
+    CHECK(corpus.Unresolved() < corpus.Presets().size() / 100);
+
+    size_t samplers = 0, params = 0;
+    for(const auto& preset : corpus.Presets())
+    {
+        for(const auto& pass : preset.passes)
+        {
+            samplers += pass.Samplers.size();
+            params += pass.Params.size();
+            CHECK_MSG(!pass.Name.empty(), preset.Label());
+        }
+    }
+    CHECK(samplers > corpus.Presets().size());
+    CHECK(params > corpus.Presets().size());
+}
+
+TEST(PassScaling)
+{
+    auto source   = MakeShader("a", {"Source"});
+    auto viewport = MakeShader("b", {"Source"});
+    auto absolute = MakeShader("c", {"Source"});
+    auto split    = MakeShader("d", {"Source"});
+    auto last     = MakeShader("e", {"Source"});
+    Scaled(source, "source", "2.0");
+    Scaled(viewport, "viewport", "0.5");
+    Scaled(absolute, "absolute", "64");
+    split.Param("scale_type_x", "source").Param("scale_x", "3.0").Param("scale_type_y", "viewport").Param("scale_y", "1.0");
+    last.Param("alias", "Last");
+    source.Param("alias", "Doubled");
+
+    RenderGraph graph({&source, &viewport, &absolute, &split, &last}, {});
+    auto        plan = graph.Plan(100, 50, 800, 600, false);
+    CHECK(plan.passSizes.size() == 5);
+    CHECK((plan.passSizes[0] == PassSize {100, 50, 200, 100}));
+    CHECK((plan.passSizes[1] == PassSize {200, 100, 400, 300}));
+    CHECK((plan.passSizes[2] == PassSize {400, 300, 64, 64}));
+    CHECK((plan.passSizes[3] == PassSize {64, 64, 192, 600}));
+    CHECK((plan.passSizes[4] == PassSize {192, 600, 800, 600}));
+    CHECK(plan.textureSizes.at("Doubled")[0] == 200.0f && plan.textureSizes.at("Doubled")[3] == 0.01f);
+    CHECK(plan.textureSizes.count("Last") == 0); // renders to the display
+    CHECK(plan.textureSizes.at("FinalViewport")[1] == 600.0f);
+
+    // everything but the last pass works in rotated space
+    plan = graph.Plan(100, 50, 800, 600, true);
+    CHECK((plan.passSizes[0] == PassSize {50, 100, 100, 200}));
+    CHECK((plan.passSizes[1] == PassSize {100, 200, 300, 400}));
+    CHECK((plan.passSizes[4] == PassSize {192, 800, 800, 600}));
+    CHECK(plan.originalWidth == 50 && plan.originalHeight == 100);
+}
+
+TEST(FitViewportBoxes)
+{
+    // wider window pillarboxes, narrower letterboxes
+    auto viewport = FitViewport(1000, 500, 400, 400, 1.0f, 1.0f, true);
+    CHECK(viewport.width == 500 && viewport.height == 500 && viewport.boxX == 250.0f && viewport.boxY == 0.0f);
+    viewport = FitViewport(400, 1000, 400, 400, 1.0f, 1.0f, true);
+    CHECK(viewport.width == 400 && viewport.height == 400 && viewport.boxX == 0.0f && viewport.boxY == 300.0f);
+
+    // fixed scale centers the scaled capture in the window
+    viewport = FitViewport(1000, 1000, 400, 300, 0.5f, 0.5f, false);
+    CHECK(viewport.width == 800 && viewport.height == 600 && viewport.boxX == 100.0f && viewport.boxY == 200.0f);
+}
+
+TEST(CorpusPlans)
+{
+    size_t plans = 0;
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        const auto  passes    = preset.Passes();
+        const auto  passCount = passes.size();
+        RenderGraph graph(passes, preset.textures);
+        for(const auto& c : sPlanCases)
+        {
+            const auto plan  = graph.Plan(c.originalWidth, c.originalHeight, c.viewportWidth, c.viewportHeight, c.vertical);
+            const auto label = Describe(preset, c);
+            plans++;
+
+            // every pass reads what the one before wrote, the last one fills the viewport
+            CHECK_MSG(plan.passSizes.size() == passCount, label);
+            if(plan.passSizes.size() != passCount)
+                continue;
+            const auto original = c.vertical ? PassSize {c.originalHeight, c.originalWidth, 0, 0} : PassSize {c.originalWidth, c.originalHeight, 0, 0};
+            CHECK_MSG(plan.passSizes[0][0] == original[0] && plan.passSizes[0][1] == original[1], label);
+            for(size_t p = 1; p < passCount; p++)
+                CHECK_MSG(plan.passSizes[p][0] == plan.passSizes[p - 1][2] && plan.passSizes[p][1] == plan.passSizes[p - 1][3], label);
+            CHECK_MSG(plan.passSizes.back()[2] == c.viewportWidth && plan.passSizes.back()[3] == c.viewportHeight, label);
+            CHECK_MSG(plan.textureSizes.count("Original") && plan.textureSizes.count("FinalViewport"), label);
+
+            // one target entry per intermediate output, matching the size and format of every pass on it
+            CHECK_MSG(plan.passTargets.size() + 1 == passCount && plan.elided.size() == passCount, label);
+            CHECK_MSG(plan.displayPass >= 0 && plan.displayPass < (int)passCount && !plan.elided[plan.displayPass], label);
+            CHECK_MSG(!plan.elided[0], label);
+            for(size_t p = 0; p + 1 < passCount; p++)
+            {
+                const auto target = plan.passTargets[p];
+                CHECK_MSG((target < 0) == (plan.elided[p] || (int)p == plan.displayPass), label);
+                CHECK_MSG(target < (int)plan.targets.size(), label);
+                if(target < 0)
+                    continue;
+                const auto& rt = plan.targets[target];
+                CHECK_MSG(rt.width == plan.passSizes[p][2] && rt.height == plan.passSizes[p][3], label);
+                CHECK_MSG(rt.format == RenderGraph::FormatName(*passes[p]) && rt.firstPass <= (int)p, label);
+                CHECK_MSG(plan.passTargets[rt.firstPass] == target, label);
+            }
+            for(size_t p = plan.displayPass + 1; p < passCount; p++)
+                CHECK_MSG(plan.elided[p], label);
+
+            // planning is a pure function of its inputs
+            const auto again = graph.Plan(c.originalWidth, c.originalHeight, c.viewportWidth, c.viewportHeight, c.vertical);
+            CHECK_MSG(again.passSizes == plan.passSizes && again.passTargets == plan.passTargets && again.elided == plan.elided, label);
+        }
+    }
+    std::printf("  %zu plans\n", plans);
+}
+
+TEST(CorpusSlots)
+{
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        const auto  passes = preset.Passes();
+        RenderGraph graph(passes, preset.textures);
+        const auto& slots = graph.Slots();
+        const auto  label = preset.Label();
+        for(size_t p = 0; p < passes.size(); p++)
+        {
+            const auto bindings = slots.Bind(*passes[p]);
+            CHECK_MSG(bindings.size() == passes[p]->Samplers.size(), label);
+            for(size_t s = 0; s < bindings.size(); s++)
+            {
+                const auto& name = passes[p]->Samplers[s].name;
+                const auto  slot = bindings[s].slot;
+                CHECK_MSG(bindings[s].binding == passes[p]->Samplers[s].binding, label);
+                CHECK_MSG(slot == SOURCE_SLOT || slot == NO_SLOT || (slot >= 0 && slot < (int)slots.Count()), label + " " + name);
+                if(name == "Source")
+                    CHECK_MSG(slot == SOURCE_SLOT, label);
+                else if(std::find(preset.textures.begin(), preset.textures.end(), name) != preset.textures.end())
+                    CHECK_MSG(slot >= slots.Texture(0), label + " " + name);
+                else if(name == "Original" || name == "OriginalHistory0")
+                    CHECK_MSG(slot == slots.Original(), label);
+
+                // outputs of later passes or the display pass aren't there to sample in the same frame
+                if(slot >= slots.PassOutput(0) && slot < slots.PassFeedback(0))
+                    CHECK_MSG(slot - slots.PassOutput(0) < (int)passes.size() - 1, label + " " + name);
+            }
+        }
+    }
+}
+
+namespace
+{
+// last pass that reads each output in the same frame, found from the bindings rather than the graph;
+// readers of an elided pass read its source, so that one has to live as long
+std::vector<int> LastReads(const RenderGraph& graph, const std::vector<const ShaderDef*>& passes, const RenderPlan& plan)
+{
+    const auto       passCount = (int)passes.size();
+    std::vector<int> lastRead(passCount), source(passCount);
+    for(int p = 0; p < passCount; p++)
+    {
+        lastRead[p] = p + 1 < passCount ? p + 1 : p;
+        for(int q = p + 1; q < passCount; q++)
+        {
+            for(const auto& b : graph.Slots().Bind(*passes[q]))
+            {
+                if(p + 1 < passCount && b.slot == graph.Slots().PassOutput(p))
+                    lastRead[p] = std::max(lastRead[p], q);
+            }
+        }
+    }
+    for(int p = 0; p < passCount; p++)
+    {
+        source[p] = plan.elided[p] ? source[p - 1] : p;
+        lastRead[source[p]] = std::max(lastRead[source[p]], lastRead[p]);
+    }
+    return lastRead;
+}
+} // namespace
+
+TEST(CorpusTargetLifetimes)
+{
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        const auto  passes = preset.Passes();
+        RenderGraph graph(passes, preset.textures);
+        for(const auto& c : sPlanCases)
+        {
+            const auto plan     = graph.Plan(c.originalWidth, c.originalHeight, c.viewportWidth, c.viewportHeight, c.vertical);
+            const auto lastRead = LastReads(graph, passes, plan);
+            const auto label    = Describe(preset, c);
+            for(int p = 0; p < (int)plan.passTargets.size(); p++)
+            {
+                if(plan.passTargets[p] < 0)
+                    continue;
+
+                // feedback and static outputs are read again in later frames
+                const auto persistent = graph.Slots().Feedback(p) || graph.Static(p);
+                for(int q = p + 1; q < (int)plan.passTargets.size(); q++)
+                {
+                    if(plan.passTargets[q] != plan.passTargets[p])
+                        continue;
+                    CHECK_MSG(!persistent && !graph.Slots().Feedback(q) && !graph.Static(q), label);
+                    CHECK_MSG(q > lastRead[p], label + " pass " + std::to_string(q) + " overwrites pass " + std::to_string(p));
+                }
+            }
+        }
+    }
+}
+
+TEST(CorpusTargetPacking)
+{
+    uint64_t dedicated = 0, aliased = 0;
+    size_t   passTargets = 0, targets = 0;
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        const auto  passes = preset.Passes();
+        RenderGraph graph(passes, preset.textures);
+        for(const auto& c : sPlanCases)
+        {
+            const auto plan     = graph.Plan(c.originalWidth, c.originalHeight, c.viewportWidth, c.viewportHeight, c.vertical);
+            const auto lastRead = LastReads(graph, passes, plan);
+            const auto label    = Describe(preset, c);
+
+            uint64_t expectedDedicated = 0, expectedAliased = 0;
+            for(int p = 0; p < (int)plan.passTargets.size(); p++)
+            {
+                if(plan.passTargets[p] >= 0)
+                    expectedDedicated += (uint64_t)plan.passSizes[p][2] * plan.passSizes[p][3] * RenderGraph::BytesPerPixel(RenderGraph::FormatName(*passes[p]));
+            }
+            for(const auto& target : plan.targets)
+                expectedAliased += (uint64_t)target.width * target.height * RenderGraph::BytesPerPixel(target.format);
+            CHECK_MSG(plan.dedicatedBytes == expectedDedicated && plan.aliasedBytes == expectedAliased, label);
+            CHECK_MSG(plan.aliasedBytes <= plan.dedicatedBytes, label);
+
+            // outputs of one size and format live over intervals, so the fewest targets that can hold them
+            // is the most live at any one pass; persistent ones each need their own on top
+            std::map<std::tuple<uint32_t, uint32_t, std::string>, std::vector<int>> live;
+            size_t                                                                   needed = 0;
+            for(int p = 0; p < (int)plan.passTargets.size(); p++)
+            {
+                if(plan.passTargets[p] < 0)
+                    continue;
+                if(graph.Slots().Feedback(p) || graph.Static(p))
+                {
+                    needed++;
+                    continue;
+                }
+                auto& counts = live[{plan.passSizes[p][2], plan.passSizes[p][3], RenderGraph::FormatName(*passes[p])}];
+                counts.resize(passes.size(), 0);
+                for(int r = p; r <= lastRead[p]; r++)
+                    counts[r]++;
+            }
+            for(const auto& key : live)
+                needed += *std::max_element(key.second.begin(), key.second.end());
+            CHECK_MSG(plan.targets.size() == needed, label + " " + std::to_string(plan.targets.size()) + " targets, " + std::to_string(needed) + " needed");
+
+            if(c.viewportWidth == 3840)
+            {
+                dedicated += plan.dedicatedBytes;
+                aliased += plan.aliasedBytes;
+                passTargets += std::count_if(plan.passTargets.begin(), plan.passTargets.end(), [](int t) { return t >= 0; });
+                targets += plan.targets.size();
+            }
+        }
+    }
+    std::printf("  at 4K: %zu pass outputs on %zu targets, %llu MB -> %llu MB\n", passTargets, targets, (unsigned long long)(dedicated >> 20), (unsigned long long)(aliased >> 20));
+}
+
+TEST(InvalidateElidedSource)
+{
+    // stock is elided so b samples a's output, which c overwrites on their shared target
+    auto a     = MakeShader("a", {"Source"});
+    auto stock = MakeShader("stock", {"Source"});
+    auto b     = MakeShader("b", {"Source"});
+    auto c     = MakeShader("c", {"Source"});
+    auto d     = MakeShader("d", {"Source"});
+
+    RenderGraph graph({&a, &stock, &b, &c, &d}, {});
+    const auto  plan = graph.Plan(100, 100, 100, 100, false);
+    CHECK(plan.elided[1]);
+    CHECK(plan.passTargets[0] == plan.passTargets[3]);
+
+    // b has to find a's output on the target again
+    const auto render = graph.Invalidate(plan, {false, false, true, false, false});
+    CHECK(render[0] && render[2] && render[3] && render[4]);
+}
+
+TEST(InvalidateAliasedTargets)
+{
+    // a and c share one target, b and d the other
+    auto a = MakeShader("a", {"Source"});
+    auto b = MakeShader("b", {"Source"});
+    auto c = MakeShader("c", {"Source"});
+    auto d = MakeShader("d", {"Source"});
+    auto e = MakeShader("e", {"Source"});
+
+    RenderGraph graph({&a, &b, &c, &d, &e}, {});
+    const auto  plan = graph.Plan(100, 100, 100, 100, false);
+    CHECK(plan.targets.size() == 2 && plan.passTargets[0] == plan.passTargets[2] && plan.passTargets[1] == plan.passTargets[3]);
+
+    CHECK((graph.Invalidate(plan, {false, false, false, true, false}) == std::vector<bool> {false, false, false, true, true}));
+    CHECK((graph.Invalidate(plan, {false, false, false, false, true}) == std::vector<bool> {false, false, false, false, true}));
+
+    // b reads a, which c replaced
+    CHECK((graph.Invalidate(plan, {false, true, false, false, false}) == std::vector<bool> {true, true, true, true, true}));
+
+    // b's output was replaced by d's and a's by c's, so c needs both rendered again
+    CHECK((graph.Invalidate(plan, {false, false, true, false, false}) == std::vector<bool> {true, true, true, true, true}));
+}
+
+TEST(InvalidateAliasReaders)
+{
+    // d samples a by its alias, a's target stays reserved until then
+    auto a = MakeShader("a", {"Source"});
+    auto b = MakeShader("b", {"Source"});
+    auto c = MakeShader("c", {"Source"});
+    auto d = MakeShader("d", {"Source", "First"});
+    auto e = MakeShader("e", {"Source"});
+    auto f = MakeShader("f", {"Source"});
+    a.Param("alias", "First");
+
+    RenderGraph graph({&a, &b, &c, &d, &e}, {});
+    auto        plan = graph.Plan(100, 100, 100, 100, false);
+    CHECK(plan.targets.size() == 3 && plan.passTargets[1] == plan.passTargets[3]);
+    CHECK((graph.Invalidate(plan, {false, false, false, true, false}) == std::vector<bool> {false, false, false, true, true}));
+    CHECK((graph.Invalidate(plan, {false, false, true, false, false}) == std::vector<bool> {false, true, true, true, true})); // b's output went to d
+
+    // with one more pass e reuses a's target once d is done with it, so d finds a gone
+    graph = RenderGraph({&a, &b, &c, &d, &e, &f}, {});
+    plan  = graph.Plan(100, 100, 100, 100, false);
+    CHECK(plan.passTargets[0] == plan.passTargets[4]);
+    CHECK((graph.Invalidate(plan, {false, false, false, false, true, false}) == std::vector<bool> {false, false, false, false, true, true}));
+    CHECK((graph.Invalidate(plan, {false, false, false, true, false, false}) == std::vector<bool> {true, true, true, true, true, true}));
+}
+
+namespace
+{
+// passes each one samples in the same frame, readers of elided passes get their source
+std::vector<std::vector<int>> FrameInputs(const RenderGraph& graph, const std::vector<const ShaderDef*>& passes, const RenderPlan& plan)
+{
+    const auto                    passCount = (int)passes.size();
+    std::vector<int>              source(passCount);
+    std::vector<std::vector<int>> inputs(passCount);
+    for(int q = 0; q < passCount; q++)
+    {
+        source[q] = plan.elided[q] ? source[q - 1] : q;
+        for(const auto& b : graph.Slots().Bind(*passes[q]))
+        {
+            if(b.slot == SOURCE_SLOT && q > 0)
+                inputs[q].push_back(source[q - 1]);
+            for(int p = 0; p + 1 < passCount && p < q; p++)
+            {
+                if(b.slot == graph.Slots().PassOutput(p))
+                    inputs[q].push_back(source[p]);
+            }
+        }
+    }
+    return inputs;
+}
+
+// replays a partial frame over the targets as the last full frame left them and reports whether
+// every pass that renders, and the display, sees the outputs a full frame would have produced
+bool PartialFrameCorrect(const std::vector<std::vector<int>>& inputs, const RenderPlan& plan, const std::vector<bool>& changed, const std::vector<bool>& render)
+{
+    const auto passCount = (int)inputs.size();
+    auto       targetOf  = [&](int p) { return p < (int)plan.passTargets.size() && plan.passTargets[p] >= 0 ? plan.passTargets[p] : (int)plan.targets.size() + p; };
+
+    // last writer of each target, and whether a pass' last output is out of date
+    std::vector<int>  holds(plan.targets.size() + passCount, -1);
+    std::vector<bool> stale(passCount, false), current(passCount, false);
+    for(int p = 0; p < passCount; p++)
+    {
+        if(!plan.elided[p])
+            holds[targetOf(p)] = p;
+        stale[p] = changed[p];
+        for(auto i : inputs[p])
+            stale[p] = stale[p] || stale[i];
+    }
+
+    for(int q = 0; q < passCount; q++)
+    {
+        if(plan.elided[q])
+            continue;
+        if(!render[q])
+        {
+            current[q] = !stale[q] && holds[targetOf(q)] == q;
+            continue;
+        }
+        for(auto i : inputs[q])
+        {
+            if(holds[targetOf(i)] != i || !current[i])
+                return false;
+        }
+        holds[targetOf(q)] = q;
+        current[q]         = true;
+    }
+    return current[plan.displayPass] || (!render[plan.displayPass] && !stale[plan.displayPass]);
+}
+} // namespace
+
+TEST(CorpusInvalidate)
+{
+    size_t frames = 0, rendered = 0, passes = 0;
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        // partial frames are only rendered when nothing in the chain animates
+        const auto defs = preset.Passes();
+        if(std::any_of(defs.begin(), defs.end(), [](const ShaderDef* def) { return def->DependsOnFrame(); }))
+            continue;
+
+        RenderGraph graph(defs, preset.textures);
+        for(const auto& c : sPlanCases)
+        {
+            const auto plan   = graph.Plan(c.originalWidth, c.originalHeight, c.viewportWidth, c.viewportHeight, c.vertical);
+            const auto inputs = FrameInputs(graph, defs, plan);
+            const auto label  = Describe(preset, c);
+            for(size_t p = 0; p < defs.size(); p++)
+            {
+                // one pass changed, and that one together with the last
+                for(int last = 0; last < 2; last++)
+                {
+                    std::vector<bool> changed(defs.size(), false);
+                    changed[p]        = true;
+                    changed.back()    = changed.back() || last;
+                    const auto render = graph.Invalidate(plan, changed);
+                    for(size_t q = 0; q < defs.size(); q++)
+                        CHECK_MSG(!changed[q] || render[q], label);
+                    CHECK_MSG(PartialFrameCorrect(inputs, plan, changed, render), label + " pass " + std::to_string(p) + " changed");
+
+                    // rendering only ever adds passes, so running it on its own result changes nothing
+                    CHECK_MSG(graph.Invalidate(plan, render) == render, label);
+                    frames++;
+                    rendered += std::count(render.begin(), render.end(), true);
+                    passes += defs.size();
+                }
+            }
+        }
+    }
+    std::printf("  %zu partial frames, %.1f%% of passes rendered\n", frames, frames ? rendered * 100.0 / passes : 0.0);
+    CHECK(frames > 0);
+}
+
+TEST(InvalidateRandomChains)
+{
+    // chains of equal sized passes alias heavily, with passthroughs elided and earlier outputs read directly
+    uint32_t seed   = 12345;
+    auto     random = [&](uint32_t n) {
+        seed = seed * 1664525 + 1013904223;
+        return (seed >> 8) % n;
+    };
+    size_t elided = 0;
+    for(int chain = 0; chain < 2000; chain++)
+    {
+        const auto             passCount = 3 + (int)random(6);
+        std::vector<ShaderDef> defs;
+        for(int p = 0; p < passCount; p++)
+        {
+            std::vector<std::string> samplers {"Source"};
+            if(p > 1 && random(3) == 0)
+                samplers.push_back("PassOutput" + std::to_string(random(p - 1)));
+            defs.push_back(MakeShader(p > 0 && samplers.size() == 1 && random(3) == 0 ? "stock" : "pass", samplers));
+        }
+        std::vector<const ShaderDef*> passes;
+        for(const auto& def : defs)
+            passes.push_back(&def);
+
+        RenderGraph graph(passes, {});
+        const auto  plan   = graph.Plan(100, 100, 100, 100, false);
+        const auto  inputs = FrameInputs(graph, passes, plan);
+        elided += std::count(plan.elided.begin(), plan.elided.end(), true);
+        for(int p = 0; p < passCount; p++)
+        {
+            std::vector<bool> changed(passCount, false);
+            changed[p] = true;
+            CHECK_MSG(PartialFrameCorrect(inputs, plan, changed, graph.Invalidate(plan, changed)), "chain " + std::to_string(chain) + " pass " + std::to_string(p));
+        }
+    }
+    CHECK(elided > 0);
+}
+
+TEST(StaticPasses)
+{
+    // a LUT-only pass feeding one that also samples it, and a pass animating with FrameCount
+    auto lut      = MakeShader("lut", {"Lut"});
+    auto lighting = MakeShader("lighting", {"Source", "Lut"});
+    auto frame    = MakeShader("frame", {"Lut"});
+    auto image    = MakeShader("image", {"Original", "PassOutput1"});
+    auto history  = MakeShader("history", {"OriginalHistory1"});
+    auto last     = MakeShader("last", {"Source"});
+    frame.AddParam("FrameCount", -1, 0, 4, 0, 0, 0);
+    frame.FrameDependent = -1;
+
+    RenderGraph graph({&lut, &lighting, &frame, &image, &history, &last}, {"Lut"});
+    CHECK(graph.Static(0) && graph.Static(1));
+    CHECK(!graph.Static(2)); // declares FrameCount
+    CHECK(!graph.Static(3) && !graph.Static(4) && !graph.Static(5));
+
+    // analysed shaders are judged by what they read, not what they declare
+    frame.FrameDependent = 0;
+    CHECK(RenderGraph({&lut, &lighting, &frame, &last}, {"Lut"}).Static(2));
+
+    // read back as feedback, or the last pass
+    auto feedback = MakeShader("feedback", {"PassFeedback0"});
+    CHECK(!RenderGraph({&lut, &feedback}, {"Lut"}).Static(0));
+    CHECK(!RenderGraph({&lut}, {"Lut"}).Static(0));
+}
+
+TEST(CorpusStaticPasses)
+{
+    // generated headers that predate the SPIR-V analysis are judged by the uniforms they declare, so the
+    // report also counts what becomes static once they are regenerated and turn out not to read them
+    size_t presets = 0, staticPasses = 0, boundPresets = 0, boundPasses = 0, allPasses = 0;
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        const auto  passes = preset.Passes();
+        RenderGraph graph(passes, preset.textures);
+        const auto& slots = graph.Slots();
+        const auto  label = preset.Label();
+
+        int count = 0;
+        for(size_t p = 0; p < passes.size(); p++)
+        {
+            allPasses++;
+            if(!graph.Static(p))
+                continue;
+            count++;
+
+            // no input changes from frame to frame: no capture, history, feedback, frame uniforms or animated passes
+            CHECK_MSG(p + 1 < passes.size() && !slots.Feedback((int)p) && !passes[p]->DependsOnFrame(), label);
+            for(const auto& b : slots.Bind(*passes[p]))
+            {
+                if(b.slot == SOURCE_SLOT)
+                    CHECK_MSG(p > 0 && graph.Static(p - 1), label);
+                else if(b.slot >= slots.PassOutput(0) && b.slot < slots.PassFeedback(0))
+                    CHECK_MSG(graph.Static(b.slot - slots.PassOutput(0)), label);
+                else
+                    CHECK_MSG(b.slot == NO_SLOT || b.slot >= slots.Texture(0), label);
+            }
+        }
+
+        auto analysed = preset.passes;
+        for(auto& pass : analysed)
+        {
+            if(pass.FrameDependent < 0 && std::none_of(pass.Samplers.begin(), pass.Samplers.end(), [](const ShaderSampler& s) { return ShaderDef::IsFrameSampler(s.name); }))
+                pass.FrameDependent = 0;
+        }
+        std::vector<const ShaderDef*> analysedPasses;
+        for(const auto& pass : analysed)
+            analysedPasses.push_back(&pass);
+        RenderGraph bound(analysedPasses, preset.textures);
+        int         upTo = 0;
+        for(size_t p = 0; p < passes.size(); p++)
+        {
+            CHECK_MSG(!graph.Static(p) || bound.Static(p), label);
+            upTo += bound.Static(p) ? 1 : 0;
+        }
+
+        if(upTo > 0)
+        {
+            std::printf("  %-72s %2d static, up to %2d of %2zu passes\n", label.c_str(), count, upTo, passes.size());
+            presets += count > 0 ? 1 : 0;
+            staticPasses += count;
+            boundPresets++;
+            boundPasses += upTo;
+        }
+    }
+    std::printf("  %zu passes in all: %zu static in %zu presets, up to %zu in %zu presets\n", allPasses, staticPasses, presets, boundPasses, boundPresets);
+}
+
+TEST(InputFusion)
+{
+    auto first = MakeShader("first", {"Source"});
+    auto last  = MakeShader("last", {"Source"});
+    CHECK(RenderGraph({&first, &last}, {}).InputFusable());
+    CHECK(!RenderGraph({&first}, {}).InputFusable()); // pass 0 scales to the viewport
+
+    // sampling between source texels or scaling would see the captured resolution
+    auto linear = MakeShader("linear", {"Source"});
+    linear.Param("filter_linear", "true");
+    CHECK(!RenderGraph({&linear, &last}, {}).InputFusable());
+    auto scaled = MakeShader("scaled", {"Source"});
+    Scaled(scaled, "source", "2.0");
+    CHECK(!RenderGraph({&scaled, &last}, {}).InputFusable());
+    auto sized = MakeShader("sized", {"Source"});
+    Scaled(sized, "viewport", "1.0");
+    CHECK(!RenderGraph({&sized, &last}, {}).InputFusable());
+    auto nearest = MakeShader("nearest", {"Source"});
+    nearest.Param("filter_linear", "false").Param("scale_type", "source").Param("scale", "1.0");
+    CHECK(RenderGraph({&nearest, &last}, {}).InputFusable());
+
+    // the preprocessed input is read later on
+    auto original = MakeShader("original", {"Source", "Original"});
+    auto history  = MakeShader("history", {"Source", "OriginalHistory2"});
+    auto current  = MakeShader("current", {"Source", "OriginalHistory0"});
+    CHECK(!RenderGraph({&first, &original}, {}).InputFusable());
+    CHECK(!RenderGraph({&first, &history}, {}).InputFusable());
+    CHECK(!RenderGraph({&first, &current}, {}).InputFusable());
+
+    // unless a preset texture of that name takes precedence
+    CHECK(RenderGraph({&first, &original}, {"Original"}).InputFusable());
+
+    RenderGraph graph({&first, &last}, {});
+    CHECK(graph.FuseInput(true, false, false, false));
+    CHECK(!graph.FuseInput(false, false, false, false));
+    CHECK(!graph.FuseInput(true, true, false, false));
+    CHECK(!graph.FuseInput(true, false, true, false));
+    CHECK(!graph.FuseInput(true, false, false, true));
+    CHECK(!RenderGraph({&linear, &last}, {}).FuseInput(true, false, false, false));
+}
+
+TEST(CorpusInputFusion)
+{
+    size_t fusable = 0;
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        const auto  passes = preset.Passes();
+        RenderGraph graph(passes, preset.textures);
+        const auto  label = preset.Label();
+
+        // pass 0 point-samples the original at its own size and nothing else samples it, now or from earlier frames
+        auto expected = passes.size() > 1 && graph.Slots().HistoryDepth() == 0;
+        auto linear   = passes[0]->PresetParams.find("filter_linear");
+        expected &= linear == passes[0]->PresetParams.end() || (linear->second != "true" && linear->second != "1");
+        for(const auto& c : sPlanCases)
+        {
+            const auto plan = graph.Plan(c.originalWidth, c.originalHeight, c.viewportWidth, c.viewportHeight, false);
+            expected &= plan.passSizes[0][2] == plan.passSizes[0][0] && plan.passSizes[0][3] == plan.passSizes[0][1];
+        }
+        for(const auto* pass : passes)
+        {
+            for(const auto& sampler : pass->Samplers)
+            {
+                const auto isTexture = std::find(preset.textures.begin(), preset.textures.end(), sampler.name) != preset.textures.end();
+                expected &= isTexture || (sampler.name != "Original" && !sampler.name.starts_with("OriginalHistory"));
+            }
+        }
+        CHECK_MSG(graph.InputFusable() == expected, label);
+        CHECK_MSG(graph.FuseInput(true, false, false, false) == expected && !graph.FuseInput(true, true, false, false), label);
+        fusable += expected ? 1 : 0;
+    }
+    std::printf("  %zu of %zu presets can sample the capture directly\n", fusable, PresetCorpus::Get().Presets().size());
+    CHECK(fusable > 0);
+}
@@ -0,0 +1,262 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "HistoryRing.h"
+#include "PresetCorpus.h"
+#include "ResourceSlots.h"
+
+#include <algorithm>
+
+namespace
+{
+// the name ShaderGlass used to key a slot's texture by before slots, aliases aside
+std::string SlotName(const ResourceSlots& slots, const std::vector<std::string>& textures, int slot)
+{
+    if(slot == slots.Original())
+        return "Original";
+    if(slot < slots.PassOutput(0))
+        return "OriginalHistory" + std::to_string(slot);
+    if(slot < slots.PassFeedback(0))
+        return "PassOutput" + std::to_string(slot - slots.PassOutput(0));
+    if(slot < slots.Texture(0))
+        return "PassFeedback" + std::to_string(slot - slots.PassFeedback(0));
+    return textures[slot - slots.Texture(0)];
+}
+
+// history depth as ShaderPass::RequiresHistory used to parse it from sampler names
+int ParsedHistory(const std::vector<const ShaderDef*>& passes)
+{
+    int maxHistory = 0;
+    for(const auto* pass : passes)
+    {
+        for(const auto& sampler : pass->Samplers)
+        {
+            if(!sampler.name.starts_with("OriginalHistory"))
+                continue;
+            try
+            {
+                auto historyNum = std::stoi(sampler.name.substr(15));
+                if(historyNum > 0 && historyNum < 100)
+                    maxHistory = std::max(maxHistory, historyNum);
+            }
+            catch(...)
+            { }
+        }
+    }
+    return maxHistory;
+}
+} // namespace
+
+TEST(SlotResolution)
+{
+    auto first  = MakeShader("first", {"Source", "OriginalHistory3", "LUT"});
+    auto second = MakeShader("second", {"Source", "Blurred", "BlurredFeedback", "PassOutput0", "Original"});
+    auto third  = MakeShader("third", {"Source", "PassFeedback2", "OriginalHistory0", "PassOutput2", "Glow", "Unknown", "PassOutput", "PassFeedback9"});
+    first.Param("alias", "Blurred");
+    third.Param("alias", "Glow");
+    const std::vector<const ShaderDef*> passes = {&first, &second, &third};
+    const ResourceSlots                 slots(passes, {"LUT", "Mask"});
+
+    // Original, 3 history frames, 2 outputs, 3 feedbacks, 2 textures
+    CHECK(slots.HistoryDepth() == 3);
+    CHECK(slots.Count() == 11);
+    CHECK(slots.PassOutput(0) == 4 && slots.PassFeedback(0) == 6 && slots.Texture(0) == 9);
+
+    CHECK(slots.Resolve("Source") == SOURCE_SLOT);
+    CHECK(slots.Resolve("Original") == slots.Original());
+    CHECK(slots.Resolve("OriginalHistory0") == slots.Original());
+    CHECK(slots.Resolve("OriginalHistory2") == slots.History(2));
+    CHECK(slots.Resolve("LUT") == slots.Texture(0));
+    CHECK(slots.Resolve("Mask") == slots.Texture(1));
+    CHECK(slots.Resolve("PassOutput1") == slots.PassOutput(1));
+    CHECK(slots.Resolve("Blurred") == slots.PassOutput(0));
+    CHECK(slots.Resolve("BlurredFeedback") == slots.PassFeedback(0));
+    CHECK(slots.Resolve("GlowFeedback") == slots.PassFeedback(2));
+    CHECK(slots.Resolve("PassFeedback2") == slots.PassFeedback(2));
+
+    // the last pass renders to the display and has no output to sample
+    CHECK(slots.Resolve("PassOutput2") == NO_SLOT);
+    CHECK(slots.Resolve("Glow") == NO_SLOT);
+    CHECK(slots.Resolve("Unknown") == NO_SLOT);
+    CHECK(slots.Resolve("PassOutput") == NO_SLOT);
+    CHECK(slots.Resolve("PassOutput1x") == NO_SLOT);
+    CHECK(slots.Resolve("PassFeedback9") == NO_SLOT);
+
+    // bindings follow the sampler order
+    const auto bindings = slots.Bind(third);
+    CHECK(bindings.size() == third.Samplers.size());
+    for(size_t s = 0; s < bindings.size(); s++)
+        CHECK(bindings[s].binding == third.Samplers[s].binding && bindings[s].slot == slots.Resolve(third.Samplers[s].name));
+
+    // textures named like a pass resource shadow it, as they did in the name-keyed map
+    const ResourceSlots shadowed(passes, {"Original", "PassOutput0"});
+    CHECK(shadowed.Resolve("Original") == shadowed.Texture(0));
+    CHECK(shadowed.Resolve("PassOutput0") == shadowed.Texture(1));
+    CHECK(shadowed.Resolve("Blurred") == shadowed.PassOutput(0));
+
+    // an empty preset and the preprocess pass's own table
+    const ResourceSlots none;
+    CHECK(none.Count() == 1 && none.HistoryDepth() == 0 && !none.RequiresFeedback());
+    CHECK(none.Resolve("Original") == none.Original() && none.Resolve("Source") == SOURCE_SLOT);
+}
+
+TEST(CorpusSlotNames)
+{
+    size_t bound = 0, aliased = 0;
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        const auto          passes = preset.Passes();
+        const ResourceSlots slots(passes, preset.textures);
+        const auto          label     = preset.Label();
+        const auto          passCount = (int)passes.size();
+
+        std::vector<std::string> aliases;
+        for(const auto* pass : passes)
+        {
+            auto alias = pass->PresetParams.find("alias");
+            aliases.push_back(alias != pass->PresetParams.end() ? alias->second : std::string());
+        }
+
+        // every sampler resolves to the texture its name or an alias stood for
+        for(const auto* pass : passes)
+        {
+            const auto bindings = slots.Bind(*pass);
+            for(size_t s = 0; s < bindings.size(); s++)
+            {
+                const auto& b = bindings[s];
+                if(b.slot < 0)
+                    continue;
+                bound++;
+                const auto& name     = pass->Samplers[s].name;
+                const auto  expected = SlotName(slots, preset.textures, b.slot);
+                if(name == expected || (name == "OriginalHistory0" && b.slot == slots.Original()))
+                    continue;
+
+                aliased++;
+                auto matched = false;
+                for(int p = 0; p < passCount; p++)
+                {
+                    if(!aliases[p].empty())
+                        matched |= (name == aliases[p] && b.slot == slots.PassOutput(p)) || (name == aliases[p] + "Feedback" && b.slot == slots.PassFeedback(p));
+                }
+                CHECK_MSG(matched, label + " " + name + " -> " + expected);
+            }
+        }
+
+        // and each slot is found again by its own name, unless a preset texture shadows it
+        for(int s = 0; s < (int)slots.Count(); s++)
+        {
+            const auto name = SlotName(slots, preset.textures, s);
+            const auto slot = slots.Resolve(name);
+            CHECK_MSG(slot == s || (slot >= slots.Texture(0) && s < slots.Texture(0)), label + " " + name);
+        }
+    }
+    std::printf("  %zu samplers bound, %zu by alias\n", bound, aliased);
+    CHECK(bound > 0 && aliased > 0);
+}
+
+TEST(HistoryRingFrames)
+{
+    for(int depth = 0; depth <= 7; depth++)
+    {
+        HistoryRing      ring(depth);
+        std::vector<int> targets(ring.Size(), -1); // frame number each ring slot was last rendered with
+        CHECK(ring.Size() == depth + 1);
+        for(int frame = 0; frame < 40; frame++)
+        {
+            // preprocess renders into the current slot, then every age is bound to its slot
+            targets[ring.Current()] = frame;
+            CHECK(ring.Frame(0) == ring.Current());
+            std::vector<bool> used(ring.Size(), false);
+            for(int age = 0; age <= depth; age++)
+            {
+                const auto slot = ring.Frame(age);
+                CHECK(slot >= 0 && slot < ring.Size() && !used[slot]);
+                used[slot] = true;
+                CHECK_MSG(targets[slot] == (frame >= age ? frame - age : -1), std::to_string(depth) + " " + std::to_string(frame));
+            }
+            ring.Advance();
+        }
+    }
+}
+
+TEST(CorpusHistoryDepth)
+{
+    size_t history = 0;
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        const auto          passes = preset.Passes();
+        const ResourceSlots slots(passes, preset.textures);
+        CHECK_MSG(slots.HistoryDepth() == ParsedHistory(passes), preset.Label());
+        history += slots.HistoryDepth() > 0;
+    }
+    std::printf("  %zu presets sample OriginalHistory\n", history);
+    CHECK(history > 0);
+
+    // stoi stopped at the first non-digit, slots only take the whole suffix as a number
+    auto pass = MakeShader("history", {"OriginalHistory2", "OriginalHistory5x", "OriginalHistory100", "OriginalHistory-4"});
+    CHECK(ResourceSlots({&pass}, {}).HistoryDepth() == 2);
+}
+
+TEST(FeedbackPasses)
+{
+    auto first  = MakeShader("first", {"Source"});
+    auto second = MakeShader("second", {"Source", "PassFeedback0"});
+    auto third  = MakeShader("third", {"Source", "MaskFeedback", "PassFeedback7"});
+    auto fourth = MakeShader("fourth", {"Source", "PassOutput1"});
+    second.Param("alias", "Mask");
+    const std::vector<const ShaderDef*> passes = {&first, &second, &third, &fourth};
+
+    const ResourceSlots slots(passes, {});
+    CHECK(slots.RequiresFeedback());
+    CHECK(slots.Feedback(0) && slots.Feedback(1) && !slots.Feedback(2) && !slots.Feedback(3));
+
+    // the display pass reading its own last frame
+    auto                last = MakeShader("last", {"Source", "PassFeedback1"});
+    const ResourceSlots display({&first, &last}, {});
+    CHECK(!display.Feedback(0) && display.Feedback(1));
+
+    const ResourceSlots plain({&first, &fourth}, {});
+    CHECK(!plain.RequiresFeedback() && !plain.Feedback(0) && !plain.Feedback(1));
+}
+
+TEST(CorpusFeedback)
+{
+    size_t presets = 0, before = 0, after = 0;
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        const auto          passes = preset.Passes();
+        const ResourceSlots slots(passes, preset.textures);
+
+        // a pass gets a second target exactly when some sampler resolves to its feedback
+        std::vector<bool> sampled(passes.size(), false);
+        for(const auto* pass : passes)
+        {
+            for(const auto& b : slots.Bind(*pass))
+            {
+                if(b.slot >= slots.PassFeedback(0) && b.slot < slots.Texture(0))
+                    sampled[b.slot - slots.PassFeedback(0)] = true;
+            }
+        }
+        auto any = false;
+        for(size_t p = 0; p < passes.size(); p++)
+        {
+            CHECK_MSG(slots.Feedback((int)p) == sampled[p], preset.Label() + " pass " + std::to_string(p));
+            any |= sampled[p];
+            after += sampled[p];
+        }
+        CHECK_MSG(slots.RequiresFeedback() == any, preset.Label());
+        if(any)
+        {
+            presets++;
+            before += passes.size(); // every pass used to get a feedback copy
+        }
+    }
+    std::printf("  %zu presets with feedback, %zu of %zu passes still need a second target\n", presets, after, before);
+    CHECK(presets > 0 && after < before);
+}
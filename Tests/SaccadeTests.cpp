@@ -0,0 +1,194 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "GazeTraces.h"
+#include "SaccadeDetector.h"
+
+namespace
+{
+SaccadeSettings Reduce()
+{
+    SaccadeSettings settings;
+    settings.reduce = true;
+    return settings;
+}
+
+// 60 fps frames tiered from the samples that have arrived by then, latency after they were seen
+struct Replayed
+{
+    double saved {0};      // share of frames rendered cheaper
+    double covered {0};    // share of frames during saccades rendered cheaper
+    double outside {0};    // share of frames rendered cheaper well away from any saccade
+    int    recovery {0};   // most frames after a saccade ends until one renders full
+    int    longestRun {0}; // cheaper frames in a row
+};
+
+Replayed Replay(const GazeTrace& trace, const std::vector<GazeSample>& samples, const SaccadeSettings& settings, double latency)
+{
+    const auto                 saccades = trace.Segments(GazeMotion::Saccade);
+    SaccadeDetector            detector(settings);
+    RenderBudget               budget(settings);
+    std::vector<RenderTier>    tiers;
+    size_t                     next = 0, cheap = 0, during = 0, duringCheap = 0, outside = 0;
+    int                        run  = 0;
+    Replayed                   result;
+    for(double time = 0; time < trace.Length(); time += 1 / 60.0)
+    {
+        while(next < samples.size() && samples[next].timestamp / 1000000.0 + latency <= time)
+            detector.Update(samples[next++]);
+        const auto tier = budget.Frame(detector.Saccade());
+        tiers.push_back(tier);
+
+        bool in = false, near = false;
+        for(const auto& s : saccades)
+        {
+            in |= time >= s.start && time < s.end;
+            near |= time >= s.start && time < s.end + settings.window + 0.04 + latency;
+        }
+        during += in;
+        if(tier == RenderTier::Saccade)
+        {
+            cheap++;
+            duringCheap += in;
+            outside += !near;
+            result.longestRun = std::max(result.longestRun, ++run);
+        }
+        else
+        {
+            run = 0;
+        }
+    }
+
+    for(const auto& s : saccades)
+    {
+        int frames = 0;
+        for(auto f = static_cast<size_t>(std::ceil(s.end * 60)); f < tiers.size() && tiers[f] == RenderTier::Saccade; f++)
+            frames++;
+        result.recovery = std::max(result.recovery, frames);
+    }
+    result.saved   = cheap / (double)tiers.size();
+    result.covered = during ? duringCheap / (double)during : 0;
+    result.outside = outside / (double)tiers.size();
+    CHECK(budget.Saved() == cheap);
+    return result;
+}
+} // namespace
+
+TEST(SaccadeHysteresis)
+{
+    const auto      settings = Reduce();
+    SaccadeDetector detector(settings);
+    float           x = 0.2f;
+    int64_t         t = 0;
+    for(int i = 0; i < 10; i++)
+        detector.Update({t += 8333, x, 0.5f});
+    CHECK(!detector.Saccade());
+    for(int i = 0; i < 4; i++)
+        detector.Update({t += 8333, x += 0.04f, 0.5f}); // 4.8 screens/s
+    CHECK(detector.Saccade() && detector.Speed() > settings.onsetSpeed);
+
+    // between the thresholds keeps the state either way
+    for(int i = 0; i < 3; i++)
+        detector.Update({t += 8333, x += 0.012f, 0.5f}); // 1.4 screens/s
+    CHECK(detector.Saccade());
+    for(int i = 0; i < 3; i++)
+        detector.Update({t += 8333, x += 0.002f, 0.5f});
+    CHECK(!detector.Saccade());
+    for(int i = 0; i < 3; i++)
+        detector.Update({t += 8333, x += 0.012f, 0.5f});
+    CHECK(!detector.Saccade());
+
+    // repeated or older samples are ignored, a long gap starts over
+    detector.Update({t, 0.9f, 0.9f});
+    detector.Update({t - 1000, 0.1f, 0.1f});
+    CHECK(!detector.Saccade());
+    detector.Update({t += 1000000, 0.9f, 0.9f});
+    CHECK(!detector.Saccade() && detector.Speed() == 0);
+}
+
+TEST(SaccadeTooLong)
+{
+    // moving fast for longer than a saccade lasts is pursuit or the head
+    SaccadeDetector detector(Reduce());
+    float           x = 0;
+    int64_t         t = 0;
+    bool            started = false;
+    for(int i = 0; i < 30; i++)
+    {
+        detector.Update({t += 8333, x += 0.025f, 0.5f}); // 3 screens/s for 250 ms
+        started |= detector.Saccade();
+    }
+    CHECK(started && !detector.Saccade());
+}
+
+TEST(SaccadeBudget)
+{
+    const auto   settings = Reduce();
+    RenderBudget budget(settings);
+    for(int i = 0; i < settings.maxFrames; i++)
+        CHECK(budget.Frame(true) == RenderTier::Saccade);
+    CHECK(budget.Frame(true) == RenderTier::Full); // spent until the saccade ends
+    CHECK(budget.Frame(true) == RenderTier::Full);
+    CHECK(budget.Frame(false) == RenderTier::Full);
+    CHECK(budget.Frame(true) == RenderTier::Saccade);
+    CHECK(budget.Frame(false) == RenderTier::Full);
+    CHECK(budget.Saved() == static_cast<uint64_t>(settings.maxFrames + 1));
+
+    RenderBudget off {SaccadeSettings {}};
+    CHECK(off.Frame(true) == RenderTier::Full && off.Saved() == 0);
+}
+
+TEST(SaccadeTraces)
+{
+    // synthetic trackers of different rates and noise, and a webcam tracker standing in for a
+    // recording; reports frames saved and how long full rendering takes to come back after a
+    // saccade, which for a proper tracker is the window, a sample and the latency
+    const auto settings = Reduce();
+    const int  bound    = 4; // frames at 60 fps
+    struct TraceCase
+    {
+        const char*             name;
+        GazeTrace               trace;
+        std::vector<GazeSample> samples;
+        double                  latency;
+        bool                    recorded;
+    };
+    const auto fixations = GazeTrace::Synthetic(1, 60, false);
+    const auto pursuit   = GazeTrace::Synthetic(2, 60, true);
+    const auto noisy     = GazeTrace::Synthetic(3, 60, true);
+    const auto slow      = GazeTrace::Synthetic(4, 60, true);
+    const auto webcam    = GazeTrace::Synthetic(5, 60, true);
+
+    const TraceCase cases[] = {{"120 Hz", fixations, fixations.Sample(11, 120, 0.003), 0.005, false},
+                               {"120 Hz, pursuit", pursuit, pursuit.Sample(12, 120, 0.003), 0.005, false},
+                               {"250 Hz, noisy", noisy, noisy.Sample(13, 250, 0.006), 0.003, false},
+                               {"60 Hz, pursuit", slow, slow.Sample(14, 60, 0.003), 0.008, false},
+                               {"webcam 30 Hz", webcam, webcam.Webcam(15), 0.02, true}};
+    for(const auto& c : cases)
+    {
+        const auto r = Replay(c.trace, c.samples, settings, c.latency);
+        printf("  %-16s %3zu saccades: %4.1f%% frames cheaper, %3.0f%% of saccade frames, %4.2f%% away from them, recovery %d frames, longest run %d\n",
+               c.name,
+               c.trace.Segments(GazeMotion::Saccade).size(),
+               r.saved * 100,
+               r.covered * 100,
+               r.outside * 100,
+               r.recovery,
+               r.longestRun);
+
+        // the same samples always tier the same frames
+        const auto again = Replay(c.trace, c.samples, settings, c.latency);
+        CHECK_MSG(again.saved == r.saved && again.recovery == r.recovery, c.name);
+        CHECK_MSG(r.longestRun <= settings.maxFrames, c.name);
+        if(!c.recorded)
+        {
+            CHECK_MSG(r.recovery <= bound, c.name);
+            CHECK_MSG(r.covered > 0.3 && r.outside < 0.01, c.name);
+        }
+    }
+}
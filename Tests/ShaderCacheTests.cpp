@@ -0,0 +1,144 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "PresetCorpus.h"
+#include "ShaderCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace
+{
+// the lookup ShaderCache did before it was indexed
+const CachedShader* Scan(const std::vector<CachedShader>& cached, const uint32_t* hash)
+{
+    for(const auto& cs : cached)
+    {
+        if(cs.hash != nullptr && cs.hash[0] == hash[0] && cs.hash[1] == hash[1] && cs.hash[2] == hash[2] && cs.hash[3] == hash[3] && cs.hash[4] == hash[4] &&
+           cs.hash[5] == hash[5] && cs.hash[6] == hash[6] && cs.hash[7] == hash[7])
+            return &cs;
+    }
+    return nullptr;
+}
+
+// the RetroArch cached shader list, bytecode stood in for by the hashes themselves
+std::vector<CachedShader> CorpusShaders()
+{
+    std::vector<CachedShader> cached;
+    for(const auto& hash : PresetCorpus::Get().Hashes())
+        cached.emplace_back(hash.data(), (const uint8_t*)hash.data(), sizeof(hash));
+    return cached;
+}
+
+// fastest of a few runs, so a run slowed by whatever else the machine does isn't what's compared
+template<typename F> double NanosecondsEach(size_t count, F&& f)
+{
+    double fastest = 0;
+    for(int run = 0; run < 5; run++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        f();
+        const auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / count;
+        fastest       = run == 0 ? ns : std::min(fastest, ns);
+    }
+    return fastest;
+}
+} // namespace
+
+TEST(CacheLookup)
+{
+    const auto shaders = CorpusShaders();
+    CHECK(shaders.size() > 1800);
+
+    ShaderCache cache;
+    CHECK(cache.empty() && cache.FindCachedShader("void main() {}") == nullptr);
+    cache.Add(CorpusShaders());
+    CHECK(!cache.empty());
+
+    // every hash finds the entry the scan found, the first of any duplicates
+    size_t duplicates = 0;
+    for(size_t i = 0; i < shaders.size(); i++)
+    {
+        const auto* found = cache.FindCachedShader(shaders[i].hash);
+        const auto* first = Scan(shaders, shaders[i].hash);
+        CHECK(found != nullptr && found->data == first->data && found->len == first->len);
+        duplicates += first != &shaders[i];
+    }
+    std::printf("  %zu cached stages, %zu duplicates\n", shaders.size(), duplicates);
+
+    // sources are hashed, and entries added later are found too, without displacing earlier ones
+    std::vector<std::vector<uint32_t>> hashes;
+    std::vector<CachedShader>          added;
+    for(const auto* source : {"float4 main() : SV_Target { return 0; }", "float4 main() : SV_Target { return 1; }"})
+        hashes.push_back(ShaderCache::CalculateHash(source));
+    added.emplace_back(hashes[0].data(), (const uint8_t*)"a", 1);
+    added.emplace_back(hashes[1].data(), (const uint8_t*)"b", 1);
+    added.emplace_back(hashes[1].data(), (const uint8_t*)"c", 1);
+    added.emplace_back(nullptr, (const uint8_t*)"d", 1);
+    added.emplace_back(shaders[0].hash, (const uint8_t*)"e", 1);
+    cache.Add(std::move(added));
+
+    CHECK(cache.FindCachedShader("float4 main() : SV_Target { return 0; }")->data[0] == 'a');
+    CHECK(cache.FindCachedShader("float4 main() : SV_Target { return 1; }")->data[0] == 'b');
+    CHECK(cache.FindCachedShader("float4 main() : SV_Target { return 2; }") == nullptr);
+    CHECK(cache.FindCachedShader(shaders[0].hash)->data == shaders[0].data);
+}
+
+TEST(CacheLookupBenchmark)
+{
+    const auto  shaders = CorpusShaders();
+    ShaderCache cache;
+    cache.Add(CorpusShaders());
+
+    // every stage of every preset looked up in random order, and misses from shaders compiled
+    // outside the list, each of which used to scan all of it
+    std::vector<const uint32_t*> hits;
+    for(const auto& cs : shaders)
+        hits.push_back(cs.hash);
+    std::shuffle(hits.begin(), hits.end(), std::mt19937(5));
+
+    std::vector<std::vector<uint32_t>> misses;
+    for(int i = 0; i < 64; i++)
+        misses.push_back(ShaderCache::CalculateHash("uncached " + std::to_string(i)));
+
+    const auto   rounds  = 5;
+    const auto   count   = hits.size() * rounds;
+    const auto*  sink    = (const CachedShader*)nullptr;
+    const double scanHit = NanosecondsEach(count, [&]() {
+        for(int r = 0; r < rounds; r++)
+            for(const auto* hash : hits)
+                sink = std::max(sink, Scan(shaders, hash));
+    });
+    const double indexHit = NanosecondsEach(count, [&]() {
+        for(int r = 0; r < rounds; r++)
+            for(const auto* hash : hits)
+                sink = std::max(sink, cache.FindCachedShader(hash));
+    });
+    const double scanMiss = NanosecondsEach(misses.size() * rounds, [&]() {
+        for(int r = 0; r < rounds; r++)
+            for(const auto& hash : misses)
+                sink = std::max(sink, Scan(shaders, hash.data()));
+    });
+    const double indexMiss = NanosecondsEach(misses.size() * rounds, [&]() {
+        for(int r = 0; r < rounds; r++)
+            for(const auto& hash : misses)
+                sink = std::max(sink, cache.FindCachedShader(hash.data()));
+    });
+    const double sha = NanosecondsEach(misses.size(), [&]() {
+        for(const auto& hash : misses)
+            sink = std::max(sink, cache.FindCachedShader(std::to_string(hash[0]) + std::string(16384, ' ')));
+    });
+    CHECK(sink != nullptr);
+
+    std::printf("  over %zu stages: scan %.0f ns a hit, %.0f ns a miss; index %.0f ns a hit, %.0f ns a miss\n", shaders.size(), scanHit, scanMiss, indexHit, indexMiss);
+    // hashing the source stays the larger part of a lookup either way
+    std::printf("  a 16 KB source hashes and looks up in %.0f ns, a 60 stage import scanned for %.3f ms and now looks up in %.3f ms\n", sha, 60 * scanHit / 1e6, 60 * indexHit / 1e6);
+    CHECK(indexHit * 10 < scanHit);
+    CHECK(indexMiss * 10 < scanMiss);
+}
@@ -0,0 +1,287 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "PresetCorpus.h"
+#include "ShaderPack.h"
+
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+// bytecode and the hash of the source it was compiled from, as generated headers hold them
+struct Stage
+{
+    Stage(const std::string& source, size_t length) : source {source}, hash {ShaderCache::CalculateHash(source)}
+    {
+        for(size_t i = 0; i < length; i++)
+            code.push_back((uint8_t)(source.size() * 31 + i * 7));
+    }
+
+    std::string           source;
+    std::vector<uint32_t> hash;
+    std::vector<uint8_t>  code;
+};
+
+ShaderDef MakeShader(const char* name, const Stage& vertex, const Stage& fragment, int frameDependent)
+{
+    ShaderDef def;
+    def.Name             = name;
+    def.Format           = const_cast<char*>("R16G16B16A16_SFLOAT");
+    def.FrameDependent   = frameDependent;
+    def.VertexByteCode   = vertex.code.data();
+    def.VertexLength     = vertex.code.size();
+    def.VertexHash       = vertex.hash.data();
+    def.FragmentByteCode = fragment.code.data();
+    def.FragmentLength   = fragment.code.size();
+    def.FragmentHash     = fragment.hash.data();
+    def.AddParam("MVP", 0, 0, 64, 0.0f, 0.0f, 0.0f);
+    def.AddParam("GAMMA", -1, 16, 4, 1.0f, 3.0f, 2.2f, 0.1f, "Gamma");
+    def.AddSampler("Source", 2);
+    def.AddSampler("Lut", 3);
+    return def;
+}
+
+std::filesystem::path PackPath(const char* name)
+{
+    return std::filesystem::temp_directory_path() / name;
+}
+
+const uint8_t sTexture[] = {0x89, 'P', 'N', 'G', 1, 2, 3, 4, 5, 6, 7, 8};
+} // namespace
+
+TEST(PackRoundTrip)
+{
+    Stage     vertex("vertex source", 100), fragment("fragment source", 37), other("other fragment", 64);
+    PresetDef crt, lcd;
+    crt.Name     = "crt";
+    crt.Category = "crt";
+    crt.ShaderDefs.push_back(MakeShader("scanlines", vertex, fragment, 1).Param("scale_type", "viewport"));
+    crt.ShaderDefs.push_back(MakeShader("mask", vertex, other, 0).Param("alias", "Mask").Param("filter_linear", "true"));
+    TextureDef lut;
+    lut.Name       = "lut";
+    lut.Data       = sTexture;
+    lut.DataLength = sizeof(sTexture);
+    crt.TextureDefs.push_back(lut.Param("name", "Lut"));
+    crt.OverrideParam("GAMMA", 2.4f);
+    lcd.Name     = "lcd";
+    lcd.Category = "handheld";
+    lcd.ShaderDefs.push_back(MakeShader("mask", vertex, other, 0));
+
+    ShaderPackWriter writer;
+    writer.AddPreset(crt);
+    writer.AddPreset(lcd);
+    CHECK(writer.PresetCount() == 2 && writer.ShaderCount() == 2 && writer.TextureCount() == 1); // mask is shared
+    const auto path = PackPath("ShaderPackTests.sgp");
+    writer.Write(path);
+
+    ShaderPack pack;
+    pack.Open(path);
+    CHECK(pack.IsOpen() && pack.PresetCount() == 2);
+    auto presets = pack.Presets();
+    CHECK(presets.size() == 2 && presets[0]->Name == "crt" && presets[0]->Category == "crt" && presets[1]->Name == "lcd");
+    CHECK(presets[0]->ShaderDefs.empty()); // materialized on Build
+
+    presets[0]->Build();
+    const auto& built = *presets[0];
+    CHECK(built.ShaderDefs.size() == 2 && built.TextureDefs.size() == 1 && built.Overrides.size() == 1);
+    for(size_t s = 0; s < built.ShaderDefs.size() && built.ShaderDefs.size() == 2; s++)
+    {
+        const auto& in  = crt.ShaderDefs[s];
+        const auto& out = built.ShaderDefs[s];
+        CHECK(out.Name == in.Name && std::strcmp(out.Format, in.Format) == 0 && out.FrameDependent == in.FrameDependent);
+        CHECK(out.VertexLength == in.VertexLength && std::memcmp(out.VertexByteCode, in.VertexByteCode, in.VertexLength) == 0);
+        CHECK(out.FragmentLength == in.FragmentLength && std::memcmp(out.FragmentByteCode, in.FragmentByteCode, in.FragmentLength) == 0);
+        CHECK(std::memcmp(out.VertexHash, in.VertexHash, HASH_LEN * sizeof(uint32_t)) == 0);
+        CHECK(std::memcmp(out.FragmentHash, in.FragmentHash, HASH_LEN * sizeof(uint32_t)) == 0);
+        CHECK(out.PresetParams == in.PresetParams);
+        CHECK(out.Params.size() == 2 && out.Samplers.size() == 2);
+        if(out.Params.size() == 2 && out.Samplers.size() == 2)
+        {
+            const auto& gamma = out.Params[1];
+            CHECK(gamma.name == "GAMMA" && gamma.buffer == -1 && gamma.offset == 16 && gamma.size == 4);
+            CHECK(gamma.minValue == 1.0f && gamma.maxValue == 3.0f && gamma.defaultValue == 2.2f && gamma.stepValue == 0.1f && gamma.description == "Gamma");
+            CHECK(out.Samplers[1].name == "Lut" && out.Samplers[1].binding == 3);
+        }
+    }
+    CHECK(built.TextureDefs[0].Name == "lut" && built.TextureDefs[0].DataLength == sizeof(sTexture));
+    CHECK(std::memcmp(built.TextureDefs[0].Data, sTexture, sizeof(sTexture)) == 0 && built.TextureDefs[0].PresetParams.at("name") == "Lut");
+    CHECK(built.Overrides[0].name == "GAMMA" && built.Overrides[0].value == 2.4f);
+
+    // every stage is found by the hash of its source, with its own bytecode
+    ShaderCache cache;
+    cache.Add(pack.CachedShaders());
+    for(const auto* stage : {&vertex, &fragment, &other})
+    {
+        const auto* cached = cache.FindCachedShader(stage->source);
+        CHECK(cached != nullptr);
+        if(cached)
+            CHECK(cached->len == stage->code.size() && std::memcmp(cached->data, stage->code.data(), cached->len) == 0);
+    }
+    CHECK(cache.FindCachedShader("not in the pack") == nullptr);
+
+    for(auto* preset : presets)
+        delete preset;
+    pack.Close();
+    std::filesystem::remove(path);
+}
+
+TEST(PackCorruption)
+{
+    Stage     vertex("vertex source", 100), fragment("fragment source", 37);
+    PresetDef preset;
+    preset.Name = "crt";
+    preset.ShaderDefs.push_back(MakeShader("scanlines", vertex, fragment, 1));
+    ShaderPackWriter writer;
+    writer.AddPreset(preset);
+    const auto path = PackPath("ShaderPackCorruption.sgp");
+    writer.Write(path);
+
+    std::string data;
+    {
+        std::ifstream file(path, std::ios::binary);
+        data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    auto rewrite = [&](const std::string& content) {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(content.data(), content.size());
+    };
+
+    // a damaged blob is caught when its shader is loaded
+    auto damaged = data;
+    damaged[sizeof(PackHeader) + 5] ^= 0xff;
+    rewrite(damaged);
+    {
+        ShaderPack pack;
+        pack.Open(path);
+        auto presets = pack.Presets();
+        auto thrown  = false;
+        try
+        {
+            presets[0]->Build();
+        }
+        catch(const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown);
+        delete presets[0];
+    }
+
+    // damaged TOC or truncated file is refused on open
+    for(const auto& content : {data.substr(0, data.size() - 1), data.substr(0, data.size() - 3) + "xyz", data.substr(0, 8)})
+    {
+        rewrite(content);
+        ShaderPack pack;
+        auto       thrown = false;
+        try
+        {
+            pack.Open(path);
+        }
+        catch(const std::runtime_error&)
+        {
+            thrown = true;
+        }
+        CHECK(thrown && !pack.IsOpen());
+    }
+    std::filesystem::remove(path);
+}
+
+TEST(PackCorpus)
+{
+    // every RetroArch preset through a pack, with stand-in bytecode and texture data per shader
+    // and texture name, the way ShaderGen's pack mode would write them
+    std::map<std::string, std::pair<Stage, Stage>> stages;
+    std::map<std::string, std::vector<uint8_t>>    textures;
+    std::vector<PresetDef>                         written;
+    size_t                                         passes = 0;
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        auto& def    = written.emplace_back();
+        def.Name     = preset.name;
+        def.Category = preset.category;
+        for(const auto& pass : preset.passes)
+        {
+            auto it = stages.find(pass.Name);
+            if(it == stages.end())
+                it = stages.try_emplace(pass.Name, Stage(pass.Name + " vertex", 64 + pass.Name.size()), Stage(pass.Name + " fragment", 96 + 13 * pass.Name.size())).first;
+            auto& sd            = def.ShaderDefs.emplace_back(pass);
+            sd.VertexByteCode   = it->second.first.code.data();
+            sd.VertexLength     = it->second.first.code.size();
+            sd.VertexHash       = it->second.first.hash.data();
+            sd.FragmentByteCode = it->second.second.code.data();
+            sd.FragmentLength   = it->second.second.code.size();
+            sd.FragmentHash     = it->second.second.hash.data();
+            passes++;
+        }
+        for(const auto& name : preset.textures)
+        {
+            auto& data = textures.try_emplace(name, name.begin(), name.end()).first->second;
+            auto& td   = def.TextureDefs.emplace_back();
+
+            td.Name       = name;
+            td.Data       = data.data();
+            td.DataLength = (int)data.size();
+            td.Param("name", name.c_str());
+        }
+    }
+
+    const auto       start = std::chrono::steady_clock::now();
+    ShaderPackWriter writer;
+    for(const auto& def : written)
+        writer.AddPreset(def);
+    const auto path = PackPath("ShaderPackCorpus.sgp");
+    writer.Write(path);
+    const auto wrote = std::chrono::steady_clock::now();
+
+    ShaderPack pack;
+    pack.Open(path);
+    auto       presets = pack.Presets();
+    const auto opened  = std::chrono::steady_clock::now();
+    CHECK(presets.size() == written.size() && writer.TextureCount() == textures.size());
+    CHECK(writer.ShaderCount() >= stages.size() && writer.ShaderCount() < passes);
+
+    // opening reads the TOC only, each preset comes back as written when it is built
+    for(size_t p = 0; p < presets.size() && p < written.size(); p++)
+    {
+        const auto& in  = written[p];
+        auto&       out = *presets[p];
+        CHECK(out.Name == in.Name && out.Category == in.Category && out.ShaderDefs.empty());
+        out.Build();
+        CHECK_MSG(out.ShaderDefs.size() == in.ShaderDefs.size() && out.TextureDefs.size() == in.TextureDefs.size(), in.Name);
+        for(size_t s = 0; s < out.ShaderDefs.size() && s < in.ShaderDefs.size(); s++)
+        {
+            const auto& a = in.ShaderDefs[s];
+            const auto& b = out.ShaderDefs[s];
+            CHECK_MSG(b.Name == a.Name && std::strcmp(b.Format, a.Format) == 0 && b.FrameDependent == a.FrameDependent && b.PresetParams == a.PresetParams, in.Name);
+            CHECK_MSG(b.FragmentLength == a.FragmentLength && std::memcmp(b.FragmentByteCode, a.FragmentByteCode, a.FragmentLength) == 0, in.Name);
+            CHECK_MSG(b.Params.size() == a.Params.size() && b.Samplers.size() == a.Samplers.size(), in.Name);
+            for(size_t i = 0; i < b.Params.size() && i < a.Params.size(); i++)
+                CHECK_MSG(b.Params[i].name == a.Params[i].name && b.Params[i].offset == a.Params[i].offset && b.Params[i].defaultValue == a.Params[i].defaultValue, in.Name);
+            for(size_t i = 0; i < b.Samplers.size() && i < a.Samplers.size(); i++)
+                CHECK_MSG(b.Samplers[i].name == a.Samplers[i].name && b.Samplers[i].binding == a.Samplers[i].binding, in.Name);
+        }
+        for(size_t t = 0; t < out.TextureDefs.size() && t < in.TextureDefs.size(); t++)
+            CHECK_MSG(out.TextureDefs[t].DataLength == in.TextureDefs[t].DataLength && out.TextureDefs[t].PresetParams == in.TextureDefs[t].PresetParams, in.Name);
+    }
+    const auto built = std::chrono::steady_clock::now();
+
+    auto ms = [](auto from, auto to) { return std::chrono::duration<double, std::milli>(to - from).count(); };
+    std::printf("  %zu presets, %zu passes in %zu shaders, %zu textures: %.1f KB pack\n",
+                presets.size(),
+                passes,
+                writer.ShaderCount(),
+                writer.TextureCount(),
+                std::filesystem::file_size(path) / 1024.0);
+    std::printf("  written in %.0f ms, opened in %.1f ms, every preset built in %.0f ms\n", ms(start, wrote), ms(wrote, opened), ms(opened, built));
+
+    for(auto* preset : presets)
+        delete preset;
+    pack.Close();
+    std::filesystem::remove(path);
+}
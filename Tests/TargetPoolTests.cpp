@@ -0,0 +1,247 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "PresetCorpus.h"
+#include "RenderGraph.h"
+#include "TargetPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace
+{
+// what a device would hand out, numbered in creation order
+struct MockTarget
+{
+    TargetKey key;
+    int       id {0};
+};
+
+struct MockDevice
+{
+    TargetPool<MockTarget> Pool(uint64_t budget)
+    {
+        return TargetPool<MockTarget>([this](const TargetKey& key) { return MockTarget {key, ++created}; }, budget);
+    }
+
+    int created {0};
+};
+
+TargetKey Key(uint32_t width, uint32_t height, uint32_t format = 28, uint32_t bind = 40)
+{
+    return {width, height, format, bind};
+}
+
+// a window edge dragged by hand at 60 fps: the size moves a few pixels most frames and pauses
+// now and then, settles, is dragged smaller, then maximized and restored
+std::vector<std::pair<uint32_t, uint32_t>> ResizeTrace()
+{
+    std::mt19937                               random(7);
+    std::uniform_int_distribution<int>         step(0, 14);
+    std::bernoulli_distribution                pause(0.15);
+    std::vector<std::pair<uint32_t, uint32_t>> trace;
+
+    auto drag = [&](uint32_t& width, uint32_t& height, int toWidth, int toHeight) {
+        while((int)width != toWidth || (int)height != toHeight)
+        {
+            if(!pause(random))
+            {
+                const auto dx = std::min(step(random), std::abs(toWidth - (int)width));
+                const auto dy = std::min(step(random), std::abs(toHeight - (int)height));
+                width += toWidth > (int)width ? dx : -dx;
+                height += toHeight > (int)height ? dy : -dy;
+            }
+            trace.emplace_back(width, height);
+        }
+    };
+    auto hold = [&](uint32_t width, uint32_t height, int frames) {
+        for(int f = 0; f < frames; f++)
+            trace.emplace_back(width, height);
+    };
+
+    uint32_t width = 960, height = 720;
+    hold(width, height, 30);
+    drag(width, height, 1600, 1000);
+    hold(width, height, 30);
+    drag(width, height, 640, 480);
+    hold(width, height, 30);
+    hold(2560, 1377, 30);
+    hold(width, height, 30);
+    return trace;
+}
+
+struct Replayed
+{
+    int    plans {0};     // pass chains planned
+    int    created {0};   // targets the device created
+    int    stretched {0}; // frames the final pass stretched a chain planned for another size
+    double ms {0};
+};
+
+// the pass chain of Process over a resize trace: with hysteresis and the pool, or re-planned
+// and re-created on every size change as before
+Replayed Replay(const RenderGraph& graph, const std::vector<std::pair<uint32_t, uint32_t>>& trace, bool pooled, const std::string& label)
+{
+    Replayed                replayed;
+    MockDevice              device;
+    auto                    pool = device.Pool(2ull * 3840 * 2160);
+    ResizeHysteresis        hysteresis;
+    std::vector<MockTarget> targets;
+    uint32_t                plannedWidth = 0, plannedHeight = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for(const auto& [width, height] : trace)
+    {
+        const auto settled = pooled ? hysteresis.Update(width, height) : (width != plannedWidth || height != plannedHeight);
+        if(settled || targets.empty())
+        {
+            const auto plan = graph.Plan(320, 240, width, height, false);
+            hysteresis.Reset(width, height);
+            replayed.plans++;
+            for(auto& target : targets)
+            {
+                if(pooled)
+                    pool.Release(std::move(target));
+            }
+            targets.clear();
+            for(const auto& target : plan.targets)
+            {
+                const auto key = Key(target.width, target.height, (uint32_t)std::hash<std::string> {}(target.format));
+                targets.push_back(pooled ? pool.Acquire(key) : MockTarget {key, ++device.created});
+                CHECK_MSG(targets.back().key == key, label);
+            }
+            plannedWidth  = width;
+            plannedHeight = height;
+        }
+        else if(width != plannedWidth || height != plannedHeight)
+        {
+            // stretching only ever covers sizes within the hysteresis band
+            replayed.stretched++;
+            CHECK_MSG(width >= plannedWidth * 0.5f && width <= plannedWidth * 1.5f && height >= plannedHeight * 0.5f && height <= plannedHeight * 1.5f,
+                      label + " " + std::to_string(width) + "x" + std::to_string(height));
+        }
+    }
+    replayed.ms      = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    replayed.created = device.created;
+
+    // the window settled at the end, so the chain has to match it
+    CHECK_MSG(plannedWidth == trace.back().first && plannedHeight == trace.back().second, label);
+    return replayed;
+}
+} // namespace
+
+TEST(TargetPoolReuse)
+{
+    MockDevice device;
+    auto       pool = device.Pool(1000 * 1000);
+
+    auto a = pool.Acquire(Key(640, 480));
+    auto b = pool.Acquire(Key(640, 480));
+    CHECK(a.id == 1 && b.id == 2 && pool.Allocated() == 2);
+
+    // same size, format and bind flags come back from the pool, anything else is created
+    pool.Release(a);
+    CHECK(pool.Idle() == 1);
+    CHECK(pool.Acquire(Key(640, 480, 29)).id == 3);
+    CHECK(pool.Acquire(Key(640, 480, 28, 8)).id == 4);
+    CHECK(pool.Acquire(Key(480, 640)).id == 5);
+    CHECK(pool.Acquire(Key(640, 480)).id == 1);
+    CHECK(pool.Reused() == 1 && pool.Idle() == 0 && device.created == 5);
+
+    // most recently released first
+    pool.Release(b);
+    pool.Release(a);
+    CHECK(pool.Acquire(Key(640, 480)).id == 1);
+    CHECK(pool.Acquire(Key(640, 480)).id == 2);
+
+    pool.Release(a);
+    pool.Clear();
+    CHECK(pool.Idle() == 0 && pool.Acquire(Key(640, 480)).id == 6);
+}
+
+TEST(TargetPoolBudget)
+{
+    MockDevice device;
+    auto       pool = device.Pool(3 * 100 * 100);
+
+    std::vector<MockTarget> targets;
+    for(uint32_t i = 0; i < 4; i++)
+        targets.push_back(pool.Acquire(Key(100, 100, i)));
+
+    // over budget, the least recently released is dropped
+    for(auto& target : targets)
+        pool.Release(target);
+    CHECK(pool.Idle() == 3);
+    CHECK(pool.Acquire(Key(100, 100, 0)).id == 5);
+    CHECK(pool.Acquire(Key(100, 100, 3)).id == 4);
+
+    // a target larger than the whole budget is never kept
+    pool.Release(pool.Acquire(Key(1000, 1000)));
+    CHECK(pool.Idle() == 0);
+}
+
+TEST(ResizeHysteresisBand)
+{
+    ResizeHysteresis hysteresis(4, 0.5f, 1.5f);
+    hysteresis.Reset(1000, 800);
+    CHECK(!hysteresis.Update(1000, 800));
+
+    // a live drag within the band holds the planned chain until the size stops changing
+    CHECK(!hysteresis.Update(1010, 800));
+    CHECK(!hysteresis.Update(1020, 806));
+    for(int f = 0; f < 4; f++)
+        CHECK(!hysteresis.Update(1030, 810));
+    CHECK(hysteresis.Update(1030, 810));
+
+    // back at the planned size before settling nothing needs re-planning
+    hysteresis.Reset(1000, 800);
+    for(int f = 0; f < 3; f++)
+        CHECK(!hysteresis.Update(1100, 800));
+    CHECK(!hysteresis.Update(1000, 800));
+    CHECK(!hysteresis.Update(1100, 800));
+
+    // leaving the band re-plans straight away either way
+    hysteresis.Reset(1000, 800);
+    CHECK(!hysteresis.Update(1500, 1200));
+    CHECK(hysteresis.Update(1501, 800));
+    CHECK(hysteresis.Update(1000, 1201));
+    CHECK(hysteresis.Update(499, 800));
+    CHECK(hysteresis.Update(1000, 399));
+}
+
+TEST(ResizeReplay)
+{
+    // presets with the longest chains stand for the heavy ones being dragged around
+    std::vector<const CorpusPreset*> presets;
+    for(const auto& preset : PresetCorpus::Get().Presets())
+        presets.push_back(&preset);
+    std::stable_sort(presets.begin(), presets.end(), [](auto a, auto b) { return a->passes.size() > b->passes.size(); });
+    presets.resize(20);
+
+    const auto trace = ResizeTrace();
+    Replayed   before, after;
+    for(const auto* preset : presets)
+    {
+        RenderGraph graph(preset->Passes(), preset->textures);
+        const auto  rebuilt = Replay(graph, trace, false, preset->Label());
+        const auto  pooled  = Replay(graph, trace, true, preset->Label());
+        CHECK_MSG(pooled.created < rebuilt.created / 4, preset->Label());
+        CHECK_MSG(pooled.plans < rebuilt.plans / 4, preset->Label());
+        for(auto [total, r] : {std::pair {&before, rebuilt}, std::pair {&after, pooled}})
+        {
+            total->plans += r.plans;
+            total->created += r.created;
+            total->stretched += r.stretched;
+            total->ms += r.ms;
+        }
+    }
+    std::printf("  %zu frames of resizing, %zu presets\n", trace.size(), presets.size());
+    std::printf("  rebuilt every size: %d chains planned, %d targets created, %.1f ms\n", before.plans, before.created, before.ms);
+    std::printf("  pooled with hysteresis: %d chains planned, %d targets created, %d frames stretched, %.1f ms\n", after.plans, after.created, after.stretched, after.ms);
+}
@@ -0,0 +1,31 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+
+#include <chrono>
+#include <cstring>
+
+// runs every test, or those whose name contains the first argument
+int main(int argc, char* argv[])
+{
+    int run = 0;
+    for(const auto& test : TestCases())
+    {
+        if(argc > 1 && std::strstr(test.name, argv[1]) == nullptr)
+            continue;
+
+        const auto failures = CheckFailures();
+        const auto start    = std::chrono::steady_clock::now();
+        test.run();
+        const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::printf("%-40s %s (%.0f ms)\n", test.name, CheckFailures() == failures ? "ok" : "FAILED", ms);
+        run++;
+    }
+    std::printf("%d tests, %d failed checks\n", run, CheckFailures());
+    return CheckFailures() == 0 && run > 0 ? 0 : 1;
+}
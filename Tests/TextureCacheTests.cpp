@@ -0,0 +1,312 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "TextureCache.h"
+
+#include <chrono>
+#include <set>
+#include <string>
+#include <thread>
+
+#ifdef TEXTURE_DECODERS
+#include "PresetCorpus.h"
+
+#include <csetjmp>
+#include <cstdio>
+#include <random>
+
+#include <jpeglib.h>
+#include <png.h>
+#endif
+
+namespace
+{
+// "images" are strings of their side length, "bad" ones fail to decode
+struct StubDecoder
+{
+    bool operator()(const uint8_t* data, size_t length, DecodedImage& image)
+    {
+        const std::string text(reinterpret_cast<const char*>(data), length);
+        {
+            std::lock_guard lock(mutex);
+            calls++;
+            threads.insert(std::this_thread::get_id());
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+        if(text.starts_with("bad"))
+            return false;
+        image.width  = static_cast<uint32_t>(std::stoul(text));
+        image.height = image.width;
+        image.pixels.assign(static_cast<size_t>(image.width) * image.height * 4, static_cast<uint8_t>(length));
+        return true;
+    }
+
+    std::mutex                mutex;
+    size_t                    calls {0};
+    std::set<std::thread::id> threads;
+    int                       delay {0}; // ms a decode takes
+};
+
+using Inputs = std::vector<std::pair<const uint8_t*, size_t>>;
+
+Inputs Batch(const std::vector<std::string>& images)
+{
+    Inputs inputs;
+    for(const auto& image : images)
+        inputs.emplace_back(reinterpret_cast<const uint8_t*>(image.data()), image.size());
+    return inputs;
+}
+} // namespace
+
+TEST(TextureCacheDecode)
+{
+    StubDecoder  stub;
+    TextureCache cache(1 << 20, [&stub](const uint8_t* data, size_t length, DecodedImage& image) { return stub(data, length, image); });
+
+    // repeats within a batch decode once and share the image
+    const std::vector<std::string> images = {"16", "32", "16", "bad", "8"};
+    auto                           first  = cache.Decode(Batch(images));
+    CHECK(first.size() == 5 && stub.calls == 4);
+    CHECK(first[0] && first[0]->width == 16 && first[0] == first[2]);
+    CHECK(first[1] && first[1]->pixels.size() == 32 * 32 * 4);
+    CHECK(!first[3]); // failed
+    CHECK(cache.Misses() == 4 && cache.Hits() == 0);
+    CHECK(cache.Size() == (16 * 16 + 32 * 32 + 8 * 8) * 4);
+
+    // another preset with the same textures takes them from the cache, the failed one is tried again
+    const std::vector<std::string> again  = {"8", "bad", "32"};
+    auto                           second = cache.Decode(Batch(again));
+    CHECK(second[0] == first[4] && second[2] == first[1] && !second[1]);
+    CHECK(stub.calls == 5 && cache.Hits() == 2 && cache.Misses() == 5);
+
+    // keyed by content, not by where it is
+    const std::string copy = "16";
+    CHECK(cache.Decode(Batch({copy}))[0] == first[0]);
+}
+
+TEST(TextureCacheEviction)
+{
+    // room for two 16x16 images
+    StubDecoder  stub;
+    TextureCache cache(2 * 16 * 16 * 4, [&stub](const uint8_t* data, size_t length, DecodedImage& image) { return stub(data, length, image); });
+    const std::vector<std::string> a = {"16"}, b = {"016"}, c = {"0016"};
+
+    const auto imageA = cache.Decode(Batch(a))[0];
+    cache.Decode(Batch(b));
+    cache.Decode(Batch(a)); // a is now the most recent
+    cache.Decode(Batch(c)); // evicts b
+    CHECK(cache.Size() == 2 * 16 * 16 * 4);
+    const auto calls = stub.calls;
+    CHECK(cache.Decode(Batch(a))[0] == imageA && stub.calls == calls);
+    cache.Decode(Batch(b));
+    CHECK(stub.calls == calls + 1);
+
+    // images outliving their eviction stay valid for whoever holds them
+    const std::vector<std::string> big = {"64"};
+    const auto                     huge = cache.Decode(Batch(big))[0];
+    CHECK(huge && cache.Size() == 64 * 64 * 4); // kept alone even over budget
+    CHECK(imageA->pixels.size() == 16 * 16 * 4);
+}
+
+TEST(TextureCacheParallel)
+{
+    StubDecoder stub;
+    stub.delay = 20;
+    TextureCache cache(1 << 24, [&stub](const uint8_t* data, size_t length, DecodedImage& image) { return stub(data, length, image); });
+    std::vector<std::string> images;
+    for(int i = 1; i <= 16; i++)
+        images.push_back(std::to_string(i));
+
+    const auto start   = std::chrono::steady_clock::now();
+    const auto decoded = cache.Decode(Batch(images));
+    const auto ms      = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    CHECK(stub.calls == 16);
+    for(size_t i = 0; i < decoded.size(); i++)
+        CHECK(decoded[i] && decoded[i]->width == i + 1);
+
+    const auto cores = std::thread::hardware_concurrency();
+    printf("  16 decodes of 20 ms on %zu threads (%u cores) in %.0f ms\n", stub.threads.size(), cores, ms);
+    if(cores > 1)
+        CHECK(stub.threads.size() > 1 && ms < 16 * 20);
+}
+
+#ifdef TEXTURE_DECODERS
+namespace
+{
+// libpng and libjpeg standing in for WIC, which decodes the same PNGs and JPEGs on Windows
+bool DecodePng(const uint8_t* data, size_t length, DecodedImage& image)
+{
+    png_image png {};
+    png.version = PNG_IMAGE_VERSION;
+    if(!png_image_begin_read_from_memory(&png, data, length))
+        return false;
+
+    png.format   = PNG_FORMAT_RGBA;
+    image.width  = png.width;
+    image.height = png.height;
+    image.pixels.resize(PNG_IMAGE_SIZE(png));
+    if(!png_image_finish_read(&png, nullptr, image.pixels.data(), 0, nullptr))
+    {
+        png_image_free(&png);
+        return false;
+    }
+    return true;
+}
+
+struct JpegError
+{
+    jpeg_error_mgr manager;
+    std::jmp_buf   jump;
+};
+
+bool DecodeJpeg(const uint8_t* data, size_t length, DecodedImage& image)
+{
+    jpeg_decompress_struct jpeg;
+    JpegError              error;
+    jpeg.err                     = jpeg_std_error(&error.manager);
+    error.manager.error_exit     = [](j_common_ptr info) { std::longjmp(reinterpret_cast<JpegError*>(info->err)->jump, 1); };
+    error.manager.output_message = [](j_common_ptr) { };
+    if(setjmp(error.jump))
+    {
+        jpeg_destroy_decompress(&jpeg);
+        return false;
+    }
+
+    jpeg_create_decompress(&jpeg);
+    jpeg_mem_src(&jpeg, data, (unsigned long)length);
+    jpeg_read_header(&jpeg, TRUE);
+    jpeg.out_color_space = JCS_RGB;
+    jpeg_start_decompress(&jpeg);
+
+    image.width  = jpeg.output_width;
+    image.height = jpeg.output_height;
+    image.pixels.resize(static_cast<size_t>(image.width) * image.height * 4);
+    std::vector<uint8_t> row(static_cast<size_t>(image.width) * 3);
+    while(jpeg.output_scanline < jpeg.output_height)
+    {
+        auto* out = image.pixels.data() + static_cast<size_t>(jpeg.output_scanline) * image.width * 4;
+        auto* in  = row.data();
+        jpeg_read_scanlines(&jpeg, &in, 1);
+        for(uint32_t x = 0; x < image.width; x++)
+        {
+            out[x * 4 + 0] = row[x * 3 + 0];
+            out[x * 4 + 1] = row[x * 3 + 1];
+            out[x * 4 + 2] = row[x * 3 + 2];
+            out[x * 4 + 3] = 255;
+        }
+    }
+    jpeg_finish_decompress(&jpeg);
+    jpeg_destroy_decompress(&jpeg);
+    return true;
+}
+
+bool DecodeImage(const uint8_t* data, size_t length, DecodedImage& image)
+{
+    if(length > 2 && data[0] == 0xff && data[1] == 0xd8)
+        return DecodeJpeg(data, length, image);
+    return DecodePng(data, length, image);
+}
+
+// someone trying out presets: mostly going back and forth between a handful, now and then a new one
+std::vector<const CorpusPreset*> SwitchSequence(size_t switches)
+{
+    std::vector<const CorpusPreset*> textured, sequence, recent;
+    for(const auto& preset : PresetCorpus::Get().Presets())
+    {
+        if(!preset.textureClasses.empty())
+            textured.push_back(&preset);
+    }
+
+    std::mt19937                          random(13);
+    std::bernoulli_distribution           back(0.6);
+    std::uniform_int_distribution<size_t> any(0, textured.size() - 1);
+    while(sequence.size() < switches)
+    {
+        const auto* preset = !recent.empty() && back(random) ? recent[std::uniform_int_distribution<size_t>(0, recent.size() - 1)(random)] : textured[any(random)];
+        sequence.push_back(preset);
+        recent.push_back(preset);
+        if(recent.size() > 6)
+            recent.erase(recent.begin());
+    }
+    return sequence;
+}
+
+Inputs PresetTextures(const CorpusPreset& preset)
+{
+    Inputs inputs;
+    for(const auto& className : preset.textureClasses)
+    {
+        const auto* data = TextureCorpus::Get().Data(className);
+        if(data)
+            inputs.emplace_back(data->data(), data->size());
+    }
+    return inputs;
+}
+} // namespace
+
+TEST(TextureCacheCorpusBenchmark)
+{
+    const auto sequence = SwitchSequence(120);
+    CHECK(TextureCorpus::Get().Count() > 200);
+
+    // before the cache every switch decoded every texture of the preset one by one
+    size_t     requested = 0;
+    const auto start     = std::chrono::steady_clock::now();
+    for(const auto* preset : sequence)
+    {
+        for(const auto& [data, length] : PresetTextures(*preset))
+        {
+            DecodedImage image;
+            CHECK_MSG(DecodeImage(data, length, image) && image.pixels.size() == static_cast<size_t>(image.width) * image.height * 4, preset->Label());
+            requested++;
+        }
+    }
+    const auto uncached = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::printf("  %zu preset switches, %zu textures requested, all decoded every time in %.0f ms\n", sequence.size(), requested, uncached);
+
+    // ShaderGlass' budget, and one small enough to evict
+    for(size_t budget : {size_t(256) * 1024 * 1024, size_t(32) * 1024 * 1024})
+    {
+        std::atomic<size_t> decodes {0};
+        TextureCache        cache(budget, [&decodes](const uint8_t* data, size_t length, DecodedImage& image) {
+            decodes++;
+            return DecodeImage(data, length, image);
+        });
+
+        std::set<const void*> distinct;
+        size_t                distinctBytes = 0, maxKept = 0;
+        const auto            begin         = std::chrono::steady_clock::now();
+        for(const auto* preset : sequence)
+        {
+            const auto inputs = PresetTextures(*preset);
+            const auto images = cache.Decode(inputs);
+            for(size_t i = 0; i < images.size(); i++)
+            {
+                CHECK_MSG(images[i] != nullptr, preset->Label());
+                if(images[i] && distinct.insert(inputs[i].first).second)
+                    distinctBytes += images[i]->pixels.size();
+            }
+            maxKept = std::max(maxKept, cache.Size());
+        }
+        const auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+
+        // a texture is decoded again only after being evicted, so once if they all fit
+        CHECK(decodes == cache.Misses() && decodes >= distinct.size());
+        CHECK(distinctBytes > budget || decodes == distinct.size());
+        CHECK(maxKept <= budget && cache.Hits() + cache.Misses() <= requested && cache.Hits() > cache.Misses());
+        std::printf("  %3zu MB budget: %zu decodes of %zu textures, %.0f%% hit rate, %.0f ms, %.1f MB kept (at most %.1f MB)\n",
+                    budget >> 20,
+                    decodes.load(),
+                    distinct.size(),
+                    100.0 * cache.Hits() / (cache.Hits() + cache.Misses()),
+                    ms,
+                    cache.Size() / 1048576.0,
+                    maxKept / 1048576.0);
+    }
+}
+#endif
@@ -0,0 +1,212 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "GazeTraces.h"
+#include "TileScheduler.h"
+
+#include <tuple>
+
+namespace
+{
+const uint32_t sWidth  = 1280;
+const uint32_t sHeight = 720;
+
+TileSettings Temporal(int period, float budget = 1.0f)
+{
+    TileSettings settings;
+    settings.tiers  = {{0.15f, 1}, {0.35f, std::max(1, period / 2)}, {2.0f, period}};
+    settings.budget = budget;
+    return settings;
+}
+
+// gaze of every frame at 60 fps
+std::vector<GazeSample> Frames(const GazeTrace& trace)
+{
+    std::vector<GazeSample> frames;
+    for(double t = 0; t < trace.Length(); t += 1 / 60.0)
+        frames.push_back(trace.At(t));
+    return frames;
+}
+
+// reading lines of text, ten words a line with four frames on each
+std::vector<GazeSample> Reading()
+{
+    std::vector<GazeSample> frames;
+    for(int line = 0; line < 6; line++)
+        for(int word = 0; word < 10; word++)
+            for(int f = 0; f < 4; f++)
+                frames.push_back({0, 0.15f + word * 0.07f, 0.2f + line * 0.1f});
+    return frames;
+}
+
+struct Replayed
+{
+    double mean {0};  // of the output rendered a frame, after the first
+    double peak {0};
+    int    stale {0}; // most frames a tile went without refreshing
+};
+
+// replays gaze through a scheduler, checking every schedule: runs don't overlap and add up to
+// the tiles it reports, the tile under the gaze is always fresh
+Replayed Replay(const std::vector<GazeSample>& frames, const TileSettings& settings, bool cursor, const std::string& label)
+{
+    TileScheduler scheduler(settings);
+    scheduler.Resize(sWidth, sHeight);
+    const auto       size = settings.tileSize;
+    const int        columns = (sWidth + size - 1) / size, rows = (sHeight + size - 1) / size;
+    std::vector<int> stale(columns * rows, 0);
+    Replayed         result;
+    for(size_t f = 0; f < frames.size(); f++)
+    {
+        if(cursor && f % 10 == 0)
+            scheduler.Damage({static_cast<int>(f * 7 % 1200), 300, static_cast<int>(f * 7 % 1200) + 32, 332});
+        const auto& schedule = scheduler.Schedule(frames[f].x, frames[f].y);
+
+        std::vector<int> hits(stale.size(), 0);
+        uint64_t         pixels = 0;
+        for(const auto& r : schedule.rects)
+        {
+            pixels += r.Area();
+            for(int y = r.top; y < r.bottom; y += size)
+                for(int x = r.left; x < r.right; x += size)
+                    hits[(y / size) * columns + x / size]++;
+        }
+        size_t tiles = 0;
+        for(size_t i = 0; i < stale.size(); i++)
+        {
+            CHECK_MSG(hits[i] <= 1, label + " frame " + std::to_string(f));
+            tiles += hits[i] > 0;
+            stale[i]     = hits[i] ? 0 : stale[i] + 1;
+            result.stale = std::max(result.stale, stale[i]);
+        }
+        CHECK_MSG(tiles == schedule.tiles && std::abs(pixels / double(sWidth * sHeight) - schedule.pixelFraction) < 1e-6, label);
+        CHECK_MSG(schedule.full == (tiles == stale.size()), label);
+
+        const auto gaze = std::min(rows - 1, static_cast<int>(frames[f].y * sHeight) / size) * columns + std::min(columns - 1, static_cast<int>(frames[f].x * sWidth) / size);
+        CHECK_MSG(stale[gaze] == 0, label + " frame " + std::to_string(f));
+        if(f > 0)
+        {
+            result.mean += schedule.pixelFraction / (frames.size() - 1);
+            result.peak = std::max<double>(result.peak, schedule.pixelFraction);
+        }
+    }
+    return result;
+}
+} // namespace
+
+TEST(TilesRefresh)
+{
+    // full refresh first, then only what's due
+    TileScheduler scheduler(Temporal(4));
+    scheduler.Resize(256, 128);
+    const auto first = scheduler.Schedule(0.5f, 0.5f);
+    CHECK(first.full && first.pixelFraction == 1.0f && first.rects.size() == 1);
+    const auto second = scheduler.Schedule(0.5f, 0.5f);
+    CHECK(!second.full && second.pixelFraction < 1.0f);
+
+    // damage forces the tiles it touches
+    scheduler.Damage({200, 100, 210, 110});
+    const auto damaged = scheduler.Schedule(0.5f, 0.5f);
+    bool       covered = false;
+    for(const auto& r : damaged.rects)
+        covered |= r.left <= 200 && r.right >= 210 && r.top <= 100 && r.bottom >= 110;
+    CHECK(covered && damaged.forced == 1);
+
+    // and invalidating all of them
+    scheduler.Invalidate();
+    CHECK(scheduler.Schedule(0.5f, 0.5f).full);
+
+    // everything every frame when no tier waits
+    TileScheduler every;
+    every.Resize(300, 200);
+    CHECK(!every.Settings().Temporal());
+    for(int f = 0; f < 5; f++)
+        CHECK(every.Schedule(0.2f * f, 0.5f).full);
+
+    // nothing to schedule before a size
+    TileScheduler empty(Temporal(4));
+    CHECK(empty.Schedule(0.5f, 0.5f).rects.empty());
+}
+
+TEST(TilesSaccade)
+{
+    TileScheduler scheduler(Temporal(8));
+    scheduler.Resize(sWidth, sHeight);
+    for(int f = 0; f < 20; f++)
+        scheduler.Schedule(0.1f, 0.1f);
+    CHECK(scheduler.Schedule(0.1f, 0.1f).forced == 0);
+    const auto landed = scheduler.Schedule(0.9f, 0.9f);
+    CHECK(landed.forced > 0);
+
+    // a small move doesn't
+    CHECK(scheduler.Schedule(0.91f, 0.9f).forced == 0);
+}
+
+TEST(TilesBudget)
+{
+    // tiles that can wait are capped, forced and every-frame ones are not
+    TileScheduler scheduler(Temporal(4, 0.2f));
+    scheduler.Resize(sWidth, sHeight);
+    const size_t tiles = 20 * 12;
+    CHECK(scheduler.Schedule(0.5f, 0.5f).full);
+    for(int f = 0; f < 50; f++)
+        CHECK(scheduler.Schedule(0.5f, 0.5f).tiles <= tiles / 5 + 1);
+}
+
+TEST(TilesDeterministic)
+{
+    const auto    frames = Frames(GazeTrace::Synthetic(1, 20, true));
+    TileScheduler a(Temporal(4)), b(Temporal(4));
+    a.Resize(sWidth, sHeight);
+    b.Resize(sWidth, sHeight);
+    for(size_t f = 0; f < frames.size(); f++)
+    {
+        if(f % 30 == 0)
+        {
+            a.Damage({100, 100, 300, 200});
+            b.Damage({100, 100, 300, 200});
+        }
+        const auto& x = a.Schedule(frames[f].x, frames[f].y);
+        const auto& y = b.Schedule(frames[f].x, frames[f].y);
+        CHECK(x.rects == y.rects && x.tiles == y.tiles && x.forced == y.forced);
+    }
+}
+
+TEST(TilesReplay)
+{
+    // synthetic fixations, saccades and pursuit, pursuit alone and reading, at tiers refreshing
+    // every 2, 4 and 8 frames; reports the share of the output rendered a frame
+    const auto fixations = Frames(GazeTrace::Synthetic(1, 30, false));
+    const auto pursuit   = Frames(GazeTrace::Synthetic(2, 30, true));
+    const auto reading   = Reading();
+    for(int period : {2, 4, 8})
+    {
+        const auto settings = Temporal(period);
+        for(const auto& [name, frames, cursor] : {std::make_tuple("fixations", &fixations, false),
+                                                  std::make_tuple("pursuit", &pursuit, false),
+                                                  std::make_tuple("reading", &reading, period == 4)})
+        {
+            const auto label = std::string(name) + " every " + std::to_string(period);
+            const auto r     = Replay(*frames, settings, cursor, label);
+            printf("  %-10s tiers 1/%d/%d%s: mean %.3f, peak %.3f of the output a frame, stale at most %d frames\n",
+                   name,
+                   settings.tiers[1].period,
+                   period,
+                   cursor ? " +cursor" : "",
+                   r.mean,
+                   r.peak,
+                   r.stale);
+            CHECK_MSG(r.mean < 1.0, label);
+            CHECK_MSG(r.stale < period, label); // no tile waits past its period
+        }
+    }
+
+    const auto capped = Replay(fixations, Temporal(4, 0.3f), false, "capped");
+    printf("  fixations  tiers 1/2/4 budget 0.3: mean %.3f, peak %.3f, stale at most %d frames\n", capped.mean, capped.peak, capped.stale);
+    CHECK(capped.peak < 1.0);
+}
@@ -0,0 +1,149 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "ViewCache.h"
+
+#include <memory>
+#include <random>
+
+namespace
+{
+// textures are shared by reference like com_ptrs, views are numbered in creation order
+using MockTexture = std::shared_ptr<int>;
+
+struct MockDevice
+{
+    ViewCache<MockTexture, int> Cache(size_t capacity)
+    {
+        return ViewCache<MockTexture, int>([this](const MockTexture&) { return ++created; }, capacity);
+    }
+
+    int created {0};
+};
+
+ViewKey Key(const MockTexture& texture, uint32_t width = 1920, uint32_t height = 1080)
+{
+    return {texture.get(), width, height, 87};
+}
+
+// a capture source handing out its textures: a frame pool cycling through its surfaces,
+// occasionally delivering the same one twice, and recreated with new ones on resize
+struct CaptureSource
+{
+    CaptureSource(size_t surfaces) : surfaces {surfaces}
+    {
+        Recreate();
+    }
+
+    void Recreate()
+    {
+        pool.clear();
+        for(size_t s = 0; s < surfaces; s++)
+            pool.push_back(std::make_shared<int>(0));
+    }
+
+    const MockTexture& Next(std::mt19937& random)
+    {
+        if(std::bernoulli_distribution(0.9)(random))
+            current = (current + 1) % pool.size();
+        return pool[current];
+    }
+
+    size_t                   surfaces;
+    size_t                   current {0};
+    std::vector<MockTexture> pool;
+};
+} // namespace
+
+TEST(ViewCacheHits)
+{
+    MockDevice device;
+    auto       cache = device.Cache(2);
+    auto       a     = std::make_shared<int>(0);
+    auto       b     = std::make_shared<int>(0);
+    auto       c     = std::make_shared<int>(0);
+
+    CHECK(cache.Get(Key(a), a) == 1);
+    CHECK(cache.Get(Key(b), b) == 2);
+    CHECK(cache.Get(Key(a), a) == 1);
+    CHECK(cache.Get(Key(b), b) == 2);
+    CHECK(cache.Created() == 2 && cache.Hits() == 2);
+
+    // the same texture described differently, e.g. after a resize in place, gets a new view
+    CHECK(cache.Get(Key(a, 1280, 720), a) == 3);
+
+    // past capacity the least recently used goes, a is still there
+    CHECK(cache.Get(Key(c), c) == 4);
+    CHECK(cache.Get(Key(a, 1280, 720), a) == 3);
+    CHECK(cache.Get(Key(b), b) == 5);
+
+    cache.Clear();
+    CHECK(cache.Get(Key(b), b) == 6);
+    CHECK(cache.Created() == 6 && device.created == 6);
+}
+
+TEST(ViewCacheHoldsTextures)
+{
+    MockDevice         device;
+    auto               cache   = device.Cache(2);
+    auto               texture = std::make_shared<int>(0);
+    std::weak_ptr<int> released(texture);
+    const auto         key = Key(texture);
+
+    // a texture the source let go of stays alive while cached, so its address isn't reused
+    cache.Get(key, texture);
+    texture.reset();
+    CHECK(!released.expired());
+
+    cache.Clear();
+    CHECK(released.expired());
+}
+
+TEST(ViewCacheFrameLoop)
+{
+    // Windows.Graphics.Capture with two surfaces resized now and then, and a device or
+    // CaptureLib source reusing one texture, with a cache the size ShaderGlass gives it;
+    // a recreated pool's views are dropped, or left to age out if its textures come first
+    std::mt19937 random(11);
+    for(auto [surfaces, clear] : {std::pair {2, true}, std::pair {2, false}, std::pair {1, true}})
+    {
+        MockDevice    device;
+        auto          cache = device.Cache(3);
+        CaptureSource source(surfaces);
+        const int     frames = 6000, recreateEvery = 1000;
+        int           steady = 0, steadyCreated = 0;
+        for(int frame = 0; frame < frames; frame++)
+        {
+            if(frame > 0 && frame % recreateEvery == 0)
+            {
+                source.Recreate();
+                if(clear)
+                    cache.Clear();
+            }
+            const auto  created = device.created;
+            const auto& texture = source.Next(random);
+            CHECK(cache.Get(Key(texture), texture) > 0);
+
+            // once both surfaces have been seen, frames create nothing
+            if(frame % recreateEvery >= 20)
+            {
+                steady++;
+                steadyCreated += device.created - created;
+            }
+        }
+        std::printf("  %d-surface source%s: %d views for %d frames, %d in %d steady frames, was one a frame\n",
+                    surfaces,
+                    clear ? "" : " not cleared",
+                    device.created,
+                    frames,
+                    steadyCreated,
+                    steady);
+        CHECK(steadyCreated == 0);
+        CHECK(device.created == surfaces * frames / recreateEvery);
+    }
+}
@@ -0,0 +1,221 @@
+/*
+ShaderGlass: shader effect overlay
+Copyright (C) 2021-2025 mausimus (mausimus.net)
+https://github.com/mausimus/ShaderGlass
+GNU General Public License v3.0
+*/
+
+#include "Check.h"
+#include "WorkQueue.h"
+
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <set>
+
+namespace
+{
+struct OutputDirectory
+{
+    OutputDirectory() : path {std::filesystem::temp_directory_path() / "WorkQueueTests"}
+    {
+        std::filesystem::remove_all(path);
+        std::filesystem::create_directories(path);
+    }
+
+    ~OutputDirectory()
+    {
+        std::filesystem::remove_all(path);
+    }
+
+    std::filesystem::path Header(int n) const
+    {
+        return path / ("Shader" + std::to_string(n) + "ShaderDef.h");
+    }
+
+    std::filesystem::path path;
+};
+
+// presets sharing shaders the way RetroArch's do: a few used everywhere, most by one or two
+std::vector<std::vector<int>> Presets(size_t count)
+{
+    std::mt19937                       random(3);
+    std::geometric_distribution<int>   shader(0.05);
+    std::uniform_int_distribution<int> passes(1, 12);
+    std::vector<std::vector<int>>      presets(count);
+    for(auto& preset : presets)
+    {
+        for(int p = passes(random); p > 0; p--)
+            preset.push_back(shader(random));
+    }
+    return presets;
+}
+
+// ShaderGen's processFiles in miniature: workers generate each shader header once, the main
+// thread appends shader lists and preset output in input order
+std::string Generate(int jobs, const std::vector<std::vector<int>>& presets, const OutputDirectory& dir, std::map<int, int>& generated)
+{
+    OutputJobs                    outputJobs;
+    std::mutex                    mutex;
+    std::vector<std::vector<int>> results(presets.size());
+    std::string                   output;
+    std::vector<bool>             consumed(presets.size(), false);
+    std::set<int>                 listed;
+
+    runJobs(
+        jobs,
+        presets.size(),
+        [&](size_t i) {
+            for(auto shader : presets[i])
+            {
+                auto& job = outputJobs.generateOnce(dir.Header(shader), false, false, [&](OutputJob& job) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                    std::ofstream(dir.Header(shader)) << "shader " << shader;
+                    job.hasAlias = shader % 3 == 0;
+                    job.alias    = "Alias" + std::to_string(shader);
+                    std::lock_guard lock(mutex);
+                    generated[shader]++;
+                });
+
+                // the header is complete by the time any preset gets the job back
+                std::ifstream header(dir.Header(shader));
+                std::string   content((std::istreambuf_iterator<char>(header)), std::istreambuf_iterator<char>());
+                CHECK_MSG(content == "shader " + std::to_string(shader), content);
+                results[i].push_back(job.hasAlias ? -shader : shader);
+            }
+        },
+        [&](size_t i) {
+            CHECK(i == 0 || consumed[i - 1]);
+            consumed[i] = true;
+            output += "preset " + std::to_string(i) + ":";
+            for(auto shader : results[i])
+            {
+                output += " " + std::to_string(shader);
+                if(listed.insert(shader).second)
+                    output += "+";
+            }
+            output += "\n";
+        });
+    return output;
+}
+} // namespace
+
+TEST(RunJobsOrder)
+{
+    for(int jobs : {1, 2, 8})
+    {
+        std::vector<int>          compiled(500, 0);
+        std::vector<size_t>       order;
+        std::set<std::thread::id> threads;
+        std::mutex                mutex;
+        runJobs(
+            jobs,
+            compiled.size(),
+            [&](size_t i) {
+                compiled[i]++;
+                std::lock_guard lock(mutex);
+                threads.insert(std::this_thread::get_id());
+            },
+            [&](size_t i) {
+                CHECK(compiled[i] == 1);
+                order.push_back(i);
+            });
+
+        CHECK(std::count(compiled.begin(), compiled.end(), 1) == (int)compiled.size());
+        for(size_t i = 0; i < order.size(); i++)
+            CHECK(order[i] == i);
+        CHECK(order.size() == compiled.size());
+        CHECK(jobs > 1 || threads.size() == 1);
+    }
+
+    // nothing to do, or a single task, runs on this thread
+    runJobs(8, 0, [](size_t) { CHECK(false); }, [](size_t) { CHECK(false); });
+    auto here = false;
+    runJobs(8, 1, [&](size_t) { here = true; }, [&](size_t) { CHECK(here); });
+}
+
+TEST(GenerateOnceExisting)
+{
+    OutputDirectory dir;
+    std::ofstream(dir.Header(1)) << "from a previous run";
+
+    // headers present from a previous run are skipped unless forced
+    OutputJobs outputJobs;
+    auto       runs  = 0;
+    auto       count = [&](OutputJob&) { runs++; };
+    auto&      kept  = outputJobs.generateOnce(dir.Header(1), false, false, count);
+    auto&      again = outputJobs.generateOnce(dir.Header(1), false, true, count);
+    CHECK(runs == 0 && kept.existed && !kept.compiled && &kept == &again);
+
+    // always regenerates, once per run
+    outputJobs.generateOnce(dir.Header(1), true, false, count);
+    outputJobs.generateOnce(dir.Header(1), true, false, count);
+    CHECK(runs == 1);
+
+    OutputJobs forced;
+    forced.generateOnce(dir.Header(1), false, true, count);
+    forced.generateOnce(dir.Header(1), false, true, count);
+    CHECK(runs == 2);
+
+    // new headers are generated by whoever asks first
+    auto& created = outputJobs.generateOnce(dir.Header(2), false, false, count);
+    CHECK(runs == 3 && !created.existed && created.compiled);
+    outputJobs.generateOnce(dir.Header(2), false, false, count);
+    CHECK(runs == 3);
+}
+
+TEST(GenerateOnceErrors)
+{
+    OutputDirectory  dir;
+    OutputJobs       outputJobs;
+    auto             failed = 0;
+    std::atomic<int> runs {0};
+
+    // every preset waiting on a header that failed to generate sees the error
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 8; t++)
+    {
+        threads.emplace_back([&]() {
+            try
+            {
+                outputJobs.generateOnce(dir.Header(1), false, false, [&](OutputJob&) {
+                    runs++;
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    throw std::runtime_error("glslang failed");
+                });
+            }
+            catch(const std::runtime_error& e)
+            {
+                CHECK(std::string(e.what()) == "glslang failed");
+                static std::mutex mutex;
+                std::lock_guard   lock(mutex);
+                failed++;
+            }
+        });
+    }
+    for(auto& thread : threads)
+        thread.join();
+    CHECK(runs == 1 && failed == 8);
+}
+
+TEST(ParallelMatchesSerial)
+{
+    const auto  presets = Presets(300);
+    std::string serial;
+    for(int jobs : {1, 2, 8})
+    {
+        OutputDirectory    dir;
+        std::map<int, int> generated;
+        const auto         start  = std::chrono::steady_clock::now();
+        const auto         output = Generate(jobs, presets, dir, generated);
+        const auto         ms     = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        // every shader header written exactly once, and the lists come out the same as a serial run
+        for(const auto& [shader, count] : generated)
+            CHECK_MSG(count == 1, std::to_string(shader));
+        if(jobs == 1)
+            serial = output;
+        CHECK_MSG(output == serial, std::to_string(jobs) + " jobs");
+        std::printf("  %d jobs: %zu presets, %zu shaders in %.0f ms\n", jobs, presets.size(), generated.size(), ms);
+    }
+}